@@ -0,0 +1,165 @@
+// Throughput of the base64 kernels against the original byte-at-a-time codec.
+// Every kernel is checked against the scalar output before it is timed.
+
+#include "Base64.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using rnopus::base64::Kernel;
+
+namespace {
+
+// The codec NativeOpusTurboModule shipped with before the SIMD kernels,
+// kept verbatim (apart from the signed-char indexing fix) as the baseline.
+std::string legacyEncode(const std::vector<uint8_t>& input) {
+    static const char* encoding_table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    static const size_t mod_table[] = {0, 2, 1};
+
+    size_t input_length = input.size();
+    size_t output_length = 4 * ((input_length + 2) / 3);
+
+    std::string encoded_data(output_length, '\0');
+    size_t i, j;
+
+    for (i = 0, j = 0; i < input_length;) {
+        uint32_t octet_a = i < input_length ? input[i++] : 0;
+        uint32_t octet_b = i < input_length ? input[i++] : 0;
+        uint32_t octet_c = i < input_length ? input[i++] : 0;
+
+        uint32_t triple = (octet_a << 16) + (octet_b << 8) + octet_c;
+
+        encoded_data[j++] = encoding_table[(triple >> 18) & 0x3F];
+        encoded_data[j++] = encoding_table[(triple >> 12) & 0x3F];
+        encoded_data[j++] = encoding_table[(triple >> 6) & 0x3F];
+        encoded_data[j++] = encoding_table[triple & 0x3F];
+    }
+
+    for (i = 0; i < mod_table[input_length % 3]; i++)
+        encoded_data[output_length - 1 - i] = '=';
+
+    return encoded_data;
+}
+
+std::vector<uint8_t> legacyDecode(const std::string& input) {
+    static int decoding_table[256];
+    static bool initialized = false;
+    if (!initialized) {
+        const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int& entry : decoding_table) entry = -1;
+        for (int k = 0; k < 64; k++) decoding_table[static_cast<unsigned char>(alphabet[k])] = k;
+        initialized = true;
+    }
+
+    size_t input_length = input.size();
+    if (input_length % 4 != 0) return {};
+
+    size_t output_length = input_length / 4 * 3;
+    if (input.length() >= 1 && input[input_length - 1] == '=') output_length--;
+    if (input.length() >= 2 && input[input_length - 2] == '=') output_length--;
+
+    std::vector<uint8_t> decoded_data(output_length);
+
+    for (size_t i = 0, j = 0; i < input_length;) {
+        uint32_t sextet_a = input[i] == '=' ? 0 & i++ : decoding_table[static_cast<unsigned char>(input[i++])];
+        uint32_t sextet_b = input[i] == '=' ? 0 & i++ : decoding_table[static_cast<unsigned char>(input[i++])];
+        uint32_t sextet_c = input[i] == '=' ? 0 & i++ : decoding_table[static_cast<unsigned char>(input[i++])];
+        uint32_t sextet_d = input[i] == '=' ? 0 & i++ : decoding_table[static_cast<unsigned char>(input[i++])];
+
+        uint32_t triple = (sextet_a << 18) + (sextet_b << 12) + (sextet_c << 6) + sextet_d;
+
+        if (j < output_length) decoded_data[j++] = (triple >> 16) & 0xFF;
+        if (j < output_length) decoded_data[j++] = (triple >> 8) & 0xFF;
+        if (j < output_length) decoded_data[j++] = triple & 0xFF;
+    }
+
+    return decoded_data;
+}
+
+template <typename Fn>
+double measureMBps(size_t bytesPerRun, Fn&& fn) {
+    // Repeat until at least ~200 ms have elapsed to smooth out timer noise.
+    size_t runs = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do {
+        fn();
+        runs++;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < 0.2);
+    return double(bytesPerRun) * runs / elapsed / 1e6;
+}
+
+bool verify(Kernel kernel, std::mt19937& rng) {
+    for (size_t size = 0; size < 600; size++) {
+        std::vector<uint8_t> input(size);
+        for (auto& byte : input) byte = static_cast<uint8_t>(rng());
+
+        std::string expected = rnopus::base64::encode(input.data(), input.size(), Kernel::Scalar);
+        std::string encoded = rnopus::base64::encode(input.data(), input.size(), kernel);
+        if (encoded != expected || encoded != legacyEncode(input)) {
+            std::fprintf(stderr, "%s: encode mismatch at size %zu\n", rnopus::base64::kernelName(kernel), size);
+            return false;
+        }
+
+        std::vector<uint8_t> decoded;
+        if (!rnopus::base64::decode(encoded.data(), encoded.size(), decoded, kernel) || decoded != input) {
+            std::fprintf(stderr, "%s: decode mismatch at size %zu\n", rnopus::base64::kernelName(kernel), size);
+            return false;
+        }
+
+        if (!encoded.empty()) {
+            std::string corrupted = encoded;
+            corrupted[rng() % corrupted.size()] = static_cast<char>(0x80 | (rng() & 0x7F));
+            if (rnopus::base64::decode(corrupted.data(), corrupted.size(), decoded, kernel)) {
+                std::fprintf(stderr, "%s: accepted invalid input at size %zu\n", rnopus::base64::kernelName(kernel), size);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    const Kernel kernels[] = {Kernel::Scalar, Kernel::Neon, Kernel::Ssse3, Kernel::Avx2};
+
+    for (Kernel kernel : kernels) {
+        if (rnopus::base64::isSupported(kernel) && !verify(kernel, rng)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::printf("best kernel: %s\n\n", rnopus::base64::kernelName(rnopus::base64::bestKernel()));
+    std::printf("%-8s %10s %14s %14s\n", "kernel", "size", "encode MB/s", "decode MB/s");
+
+    for (size_t size : {size_t(1) << 10, size_t(64) << 10, size_t(1) << 20, size_t(16) << 20}) {
+        std::vector<uint8_t> input(size);
+        for (auto& byte : input) byte = static_cast<uint8_t>(rng());
+        std::string encoded = legacyEncode(input);
+
+        // Throughput is reported against the binary size for both directions.
+        double legacyEnc = measureMBps(size, [&] { legacyEncode(input); });
+        double legacyDec = measureMBps(size, [&] { legacyDecode(encoded); });
+        std::printf("%-8s %10zu %14.1f %14.1f\n", "legacy", size, legacyEnc, legacyDec);
+
+        std::vector<uint8_t> decoded;
+        for (Kernel kernel : kernels) {
+            if (!rnopus::base64::isSupported(kernel)) {
+                continue;
+            }
+            double enc = measureMBps(size, [&] { rnopus::base64::encode(input.data(), input.size(), kernel); });
+            double dec = measureMBps(size, [&] { rnopus::base64::decode(encoded.data(), encoded.size(), decoded, kernel); });
+            std::printf("%-8s %10zu %14.1f %14.1f\n", rnopus::base64::kernelName(kernel), size, enc, dec);
+        }
+        std::printf("\n");
+    }
+
+    return EXIT_SUCCESS;
+}
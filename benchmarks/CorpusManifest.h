@@ -0,0 +1,42 @@
+#pragma once
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// One entry of corpus/manifest.txt. Streams are stored as u16-framed packets
+// (see PacketFraming.h) in <corpus dir>/<name>.u16.
+struct CorpusEntry {
+    std::string name;
+    int sampleRate = 0;
+    int channels = 0;
+    bool vbr = false;
+    int bitrate = 0;
+    int frameMs = 0;
+    int seconds = 0;
+};
+
+inline std::vector<CorpusEntry> readManifest(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    std::vector<CorpusEntry> entries;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        CorpusEntry entry;
+        std::string mode;
+        if (!(fields >> entry.name >> entry.sampleRate >> entry.channels >> mode >> entry.bitrate >> entry.frameMs >> entry.seconds)) {
+            throw std::runtime_error("Malformed manifest line: " + line);
+        }
+        entry.vbr = mode == "vbr";
+        entries.push_back(entry);
+    }
+    return entries;
+}
@@ -0,0 +1,274 @@
+// Per-stage cost of the decode pipeline on the benchmark corpus: packet
+// splitting, int16 and float decoding, parallel batch decoding, resampling
+// to 44.1 kHz, re-encoding
+// the decoded PCM, base64 encoding of the PCM, streaming WAV output and the
+// end-to-end file transcode.
+//
+// Usage: decode-benchmark [corpus dir] [manifest]
+
+#include "Base64.h"
+#include "BatchDecoder.h"
+#include "CorpusManifest.h"
+#include "DecoderSession.h"
+#include "EncoderSession.h"
+#include "FileTranscoder.h"
+#include "MappedFile.h"
+#include "PacketFraming.h"
+#include "Resampler.h"
+#include "ThreadPool.h"
+#include "WavWriter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Heap accounting. Every operator new goes through here with a header that
+// records the size, so frees can be subtracted from the live total. Aligned
+// allocations (posix_memalign, aligned new) are not counted.
+namespace {
+
+std::atomic<uint64_t> allocatedBytes{0};
+std::atomic<uint64_t> liveBytes{0};
+std::atomic<uint64_t> peakLiveBytes{0};
+
+constexpr size_t kHeaderSize = alignof(std::max_align_t);
+
+void* trackedAlloc(size_t size) {
+    void* block = std::malloc(size + kHeaderSize);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    allocatedBytes += size;
+    uint64_t live = liveBytes += size;
+    uint64_t peak = peakLiveBytes.load();
+    while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live)) {
+    }
+    return static_cast<char*>(block) + kHeaderSize;
+}
+
+void trackedFree(void* pointer) {
+    if (!pointer) {
+        return;
+    }
+    void* block = static_cast<char*>(pointer) - kHeaderSize;
+    liveBytes -= *static_cast<size_t*>(block);
+    std::free(block);
+}
+
+} // namespace
+
+void* operator new(size_t size) { return trackedAlloc(size); }
+void* operator new[](size_t size) { return trackedAlloc(size); }
+void operator delete(void* pointer) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer) noexcept { trackedFree(pointer); }
+void operator delete(void* pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { trackedFree(pointer); }
+
+namespace {
+
+struct StageResult {
+    double secondsPerRun = 0;
+    uint64_t bytesAllocated = 0; // Per run
+    uint64_t peakHeapBytes = 0;  // Above what was live before the run
+};
+
+long peakRssKiB() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// One counted run for the heap numbers, then timed runs until at least
+// ~200 ms have elapsed to smooth out timer noise.
+template <typename Fn>
+StageResult measure(Fn&& fn) {
+    StageResult result;
+    uint64_t allocatedBefore = allocatedBytes;
+    uint64_t liveBefore = liveBytes;
+    peakLiveBytes = liveBefore;
+    fn();
+    result.bytesAllocated = allocatedBytes - allocatedBefore;
+    result.peakHeapBytes = peakLiveBytes - liveBefore;
+
+    size_t runs = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do {
+        fn();
+        runs++;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < 0.2);
+    result.secondsPerRun = elapsed / runs;
+    return result;
+}
+
+void report(const std::string& stream, const char* stage, const StageResult& result, size_t packets, uint64_t samples) {
+    std::printf("%-16s %-10s %12.0f %10.2f %14llu %14llu %10ld\n",
+                stream.c_str(), stage,
+                packets / result.secondsPerRun,
+                result.secondsPerRun * 1e9 / samples,
+                static_cast<unsigned long long>(result.bytesAllocated),
+                static_cast<unsigned long long>(result.peakHeapBytes),
+                peakRssKiB());
+}
+
+void benchmark(const CorpusEntry& entry, const std::string& path, const std::string& wavPath) {
+    rnopus::MappedFile file(path);
+    rnopus::FramingOptions framing;
+    framing.framing = rnopus::Framing::U16;
+
+    rnopus::PacketList list = rnopus::splitPackets(file.data(), file.size(), framing);
+    const size_t packets = list.packets.size();
+
+    // Reference decode; every stage reports against these sample counts.
+    rnopus::DecodeResult reference = rnopus::DecoderSession(entry.sampleRate, entry.channels).decode(list.packets);
+    const uint64_t samples = reference.samplesDecoded;
+    if (samples == 0 || reference.packetsDecoded != static_cast<int>(packets)) {
+        std::fprintf(stderr, "%s: decoded %d of %zu packets\n", entry.name.c_str(), reference.packetsDecoded, packets);
+        std::exit(EXIT_FAILURE);
+    }
+
+    report(entry.name, "split", measure([&] {
+        rnopus::splitPackets(file.data(), file.size(), framing);
+    }), packets, samples);
+
+    rnopus::DecoderSession session(entry.sampleRate, entry.channels);
+    report(entry.name, "decode", measure([&] {
+        session.reset();
+        session.decode(list.packets);
+    }), packets, samples);
+
+    report(entry.name, "decode-f32", measure([&] {
+        session.reset();
+        session.decode(list.packets, rnopus::SampleFormat::Float32);
+    }), packets, samples);
+
+    // kBatchStreams copies of the stream, decoded like a decodeOpusBatch
+    // call. Against "decode", ns/sample shows the speedup over one core;
+    // batches leave one of the pool's workers free.
+    constexpr size_t kBatchStreams = 32;
+    rnopus::ThreadPool pool;
+    rnopus::BatchStream stream;
+    stream.packets.assign(file.data(), file.data() + file.size());
+    stream.framing = framing;
+    stream.sampleRate = entry.sampleRate;
+    stream.channels = entry.channels;
+    report(entry.name, "batch", measure([&] {
+        std::mutex mutex;
+        std::condition_variable finished;
+        bool done = false;
+        rnopus::decodeBatch(pool, std::vector<rnopus::BatchStream>(kBatchStreams, stream), [&](std::vector<rnopus::BatchStreamResult>) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+            finished.notify_one();
+        });
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return done; });
+    }), packets * kBatchStreams, samples * kBatchStreams);
+
+    // Streaming conversion to a common device rate, one packet at a time
+    const size_t packetFrames = samples / packets;
+    rnopus::Resampler resampler(entry.sampleRate, 44100, entry.channels);
+    std::vector<opus_int16> resampled(resampler.maxOutputFrames(packetFrames) * entry.channels);
+    report(entry.name, "resample", measure([&] {
+        resampler.reset();
+        for (size_t frame = 0; frame < samples; frame += packetFrames) {
+            size_t frames = std::min<size_t>(packetFrames, samples - frame);
+            resampler.process(reference.pcm.data() + frame * entry.channels, frames, resampled.data());
+        }
+    }), packets, samples);
+
+    // Same settings as generate-corpus, so the packet count matches
+    rnopus::EncoderConfig encoderConfig;
+    encoderConfig.sampleRate = entry.sampleRate;
+    encoderConfig.channels = entry.channels;
+    encoderConfig.application = entry.sampleRate >= 48000 ? OPUS_APPLICATION_AUDIO : OPUS_APPLICATION_VOIP;
+    encoderConfig.bitrate = entry.bitrate;
+    encoderConfig.vbr = entry.vbr;
+    encoderConfig.complexity = 10;
+    encoderConfig.frameDurationMs = entry.frameMs;
+    rnopus::EncoderSession encoder(encoderConfig);
+    report(entry.name, "encode", measure([&] {
+        encoder.reset();
+        encoder.encode(reference.pcm.data(), reference.pcm.size() / entry.channels, rnopus::Framing::U16);
+    }), packets, samples);
+
+    const uint8_t* pcmBytes = reinterpret_cast<const uint8_t*>(reference.pcm.data());
+    const size_t pcmSize = reference.pcm.size() * sizeof(opus_int16);
+    report(entry.name, "base64", measure([&] {
+        rnopus::base64::encode(pcmBytes, pcmSize);
+    }), packets, samples);
+
+    // Appended one packet's worth at a time, as a streaming caller would
+    const size_t chunkBytes = pcmSize / packets;
+    report(entry.name, "wav", measure([&] {
+        rnopus::WavWriter writer(wavPath, entry.sampleRate, static_cast<uint16_t>(entry.channels));
+        for (size_t offset = 0; offset < pcmSize; offset += chunkBytes) {
+            writer.append(pcmBytes + offset, std::min(chunkBytes, pcmSize - offset));
+        }
+        writer.finalize();
+    }), packets, samples);
+
+    report(entry.name, "transcode", measure([&] {
+        rnopus::transcodeToWav(path, wavPath, framing, entry.sampleRate, entry.channels);
+    }), packets, samples);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string corpusDir = argc > 1 ? argv[1] : RNOPUS_CORPUS_DIR;
+    std::string manifest = argc > 2 ? argv[2] : RNOPUS_CORPUS_MANIFEST;
+    std::string wavPath = "/tmp/rnopus-benchmark-" + std::to_string(getpid()) + ".wav";
+
+    // Fail up front, before any timing, if the corpus was never generated
+    std::vector<CorpusEntry> entries;
+    try {
+        entries = readManifest(manifest);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    for (const CorpusEntry& entry : entries) {
+        std::string path = corpusDir + "/" + entry.name + ".u16";
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0 || info.st_size == 0) {
+            std::fprintf(stderr,
+                         "Corpus stream %s is missing or empty.\n"
+                         "Build the corpus target (cmake --build <build dir> --target corpus) or run\n"
+                         "generate-corpus <manifest> <dir> and pass <dir> as the first argument.\n",
+                         path.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::printf("libopus: %s\n\n", opus_get_version_string());
+    std::printf("%-16s %-10s %12s %10s %14s %14s %10s\n",
+                "stream", "stage", "packets/s", "ns/sample", "alloc B/run", "peak heap B", "RSS KiB");
+
+    try {
+        for (const CorpusEntry& entry : entries) {
+            benchmark(entry, corpusDir + "/" + entry.name + ".u16", wavPath);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        unlink(wavPath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    unlink(wavPath.c_str());
+    std::printf("\nns/sample is per decoded sample frame (all channels). RSS is the process high-water mark.\n");
+    return EXIT_SUCCESS;
+}
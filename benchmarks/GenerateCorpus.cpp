@@ -0,0 +1,110 @@
+// Encodes the benchmark corpus described by corpus/manifest.txt. The input
+// is a deterministic speech-like signal (a gliding harmonic series under a
+// syllable-rate envelope, plus a little noise), so the packets only depend
+// on the libopus version.
+//
+// Usage: generate-corpus <manifest> <output dir>
+
+#include "CorpusManifest.h"
+#include "opus/opus.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+std::vector<opus_int16> synthesize(const CorpusEntry& entry) {
+    const size_t frames = size_t(entry.sampleRate) * entry.seconds;
+    std::vector<opus_int16> pcm(frames * entry.channels);
+    std::mt19937 rng(1234);
+    std::normal_distribution<double> noise(0.0, 0.01);
+
+    double phase = 0;
+    for (size_t i = 0; i < frames; i++) {
+        double t = double(i) / entry.sampleRate;
+        double pitch = 140 + 40 * std::sin(2 * kPi * 0.3 * t);
+        phase += 2 * kPi * pitch / entry.sampleRate;
+        double envelope = 0.5 + 0.5 * std::sin(2 * kPi * 4 * t);
+
+        for (int channel = 0; channel < entry.channels; channel++) {
+            double sample = 0;
+            for (int harmonic = 1; harmonic <= 12; harmonic++) {
+                if (pitch * harmonic >= entry.sampleRate / 2) {
+                    break;
+                }
+                sample += std::sin(harmonic * phase + channel * 0.7 * harmonic) / harmonic;
+            }
+            sample = 0.25 * envelope * sample + noise(rng);
+            pcm[i * entry.channels + channel] = static_cast<opus_int16>(std::lround(std::fmax(-1.0, std::fmin(1.0, sample)) * 32767));
+        }
+    }
+    return pcm;
+}
+
+bool encode(const CorpusEntry& entry, const std::string& path) {
+    int error = 0;
+    int application = entry.sampleRate >= 48000 ? OPUS_APPLICATION_AUDIO : OPUS_APPLICATION_VOIP;
+    OpusEncoder* encoder = opus_encoder_create(entry.sampleRate, entry.channels, application, &error);
+    if (error != OPUS_OK) {
+        std::fprintf(stderr, "%s: %s\n", entry.name.c_str(), opus_strerror(error));
+        return false;
+    }
+    opus_encoder_ctl(encoder, OPUS_SET_BITRATE(entry.bitrate));
+    opus_encoder_ctl(encoder, OPUS_SET_VBR(entry.vbr ? 1 : 0));
+    opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(10));
+
+    std::vector<opus_int16> pcm = synthesize(entry);
+    const int frameSize = entry.sampleRate / 1000 * entry.frameMs;
+    const size_t totalFrames = pcm.size() / entry.channels;
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::perror(path.c_str());
+        opus_encoder_destroy(encoder);
+        return false;
+    }
+
+    unsigned char packet[4000];
+    bool ok = true;
+    for (size_t offset = 0; offset + frameSize <= totalFrames; offset += frameSize) {
+        opus_int32 size = opus_encode(encoder, pcm.data() + offset * entry.channels, frameSize, packet, sizeof(packet));
+        if (size < 0) {
+            std::fprintf(stderr, "%s: %s\n", entry.name.c_str(), opus_strerror(size));
+            ok = false;
+            break;
+        }
+        const unsigned char prefix[2] = {static_cast<unsigned char>(size >> 8), static_cast<unsigned char>(size)};
+        std::fwrite(prefix, 1, 2, file);
+        std::fwrite(packet, 1, size, file);
+    }
+
+    ok = std::fclose(file) == 0 && ok;
+    opus_encoder_destroy(encoder);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s <manifest> <output dir>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        for (const CorpusEntry& entry : readManifest(argv[1])) {
+            if (!encode(entry, std::string(argv[2]) + "/" + entry.name + ".u16")) {
+                return EXIT_FAILURE;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
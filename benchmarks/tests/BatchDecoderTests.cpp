@@ -0,0 +1,75 @@
+#include "BatchDecoder.h"
+#include "TestHarness.h"
+#include "TestSignals.h"
+
+#include <chrono>
+#include <future>
+#include <vector>
+
+using namespace rnopus;
+
+namespace {
+
+constexpr opus_int32 kRate = 16000;
+
+std::vector<BatchStream> speechStreams(int count, int packets) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, packets, Framing::U16);
+    std::vector<BatchStream> streams(count);
+    for (BatchStream& stream : streams) {
+        stream.packets = encoded.data;
+        stream.framing.framing = Framing::U16;
+        stream.sampleRate = kRate;
+    }
+    return streams;
+}
+
+std::vector<BatchStreamResult> runBatch(ThreadPool& pool, std::vector<BatchStream> streams) {
+    std::promise<std::vector<BatchStreamResult>> finished;
+    decodeBatch(pool, std::move(streams), [&finished](std::vector<BatchStreamResult> results) {
+        finished.set_value(std::move(results));
+    });
+    return finished.get_future().get();
+}
+
+} // namespace
+
+TEST(batchDecodesEveryStreamInOrder) {
+    ThreadPool pool(3);
+    std::vector<BatchStream> streams = speechStreams(6, 10);
+    streams[2].packets.resize(5); // Truncated framing fails only this stream
+    std::vector<BatchStreamResult> results = runBatch(pool, std::move(streams));
+    CHECK_EQ(results.size(), size_t(6));
+    for (size_t i = 0; i < results.size(); i++) {
+        if (i == 2) {
+            CHECK(!results[i].error.empty());
+        } else {
+            CHECK(results[i].error.empty());
+            CHECK_EQ(results[i].decoded.samplesDecoded, 10 * 320);
+        }
+    }
+}
+
+TEST(batchRunsOnSingleWorkerPool) {
+    ThreadPool pool(1);
+    std::vector<BatchStreamResult> results = runBatch(pool, speechStreams(3, 5));
+    CHECK_EQ(results.size(), size_t(3));
+    CHECK_EQ(results[2].decoded.packetsDecoded, 5);
+}
+
+TEST(batchLeavesAWorkerFree) {
+    using Clock = std::chrono::steady_clock;
+    ThreadPool pool(2);
+    std::vector<BatchStream> streams = speechStreams(16, 250);
+    std::promise<Clock::time_point> finished;
+    Clock::time_point start = Clock::now();
+    decodeBatch(pool, std::move(streams), [&](std::vector<BatchStreamResult>) {
+        finished.set_value(Clock::now());
+    });
+    // Queued behind the batch. With every worker draining it, this would
+    // only run once the last streams are being decoded.
+    std::promise<Clock::time_point> probe;
+    pool.submit([&] { probe.set_value(Clock::now()); });
+    Clock::duration probeDelay = probe.get_future().get() - start;
+    Clock::duration batchTime = finished.get_future().get() - start;
+    CHECK(probeDelay < batchTime / 2);
+}
@@ -0,0 +1,176 @@
+#include "BinauralRenderer.h"
+#include "ProjectionDecoderSession.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace rnopus;
+
+namespace {
+
+constexpr int kRate = 48000;
+constexpr int kFrames = 960;
+
+// Noise-like first-order ambisonics, `frames` interleaved frames
+std::vector<float> ambisonicNoise(int channels, size_t frames) {
+    std::vector<float> pcm(frames * channels);
+    uint32_t state = 12345;
+    for (float& sample : pcm) {
+        state = state * 1664525 + 1013904223;
+        sample = static_cast<float>(int32_t(state) >> 8) / (1 << 24);
+    }
+    return pcm;
+}
+
+std::vector<float> render(BinauralRenderer& renderer, const std::vector<float>& in, int channels,
+                          const std::vector<size_t>& blocks) {
+    const size_t frames = in.size() / channels;
+    std::vector<float> out(frames * 2);
+    size_t offset = 0;
+    for (size_t i = 0; offset < frames; i++) {
+        size_t block = std::min(blocks[i % blocks.size()], frames - offset);
+        renderer.process(in.data() + offset * channels, channels, block, out.data() + offset * 2);
+        offset += block;
+    }
+    return out;
+}
+
+// A family 3 stream from the libopus ambisonics encoder
+struct Ambisonic {
+    OpusHead head;
+    std::vector<std::vector<uint8_t>> packets;
+
+    explicit Ambisonic(int channels, int count) {
+        int error = OPUS_OK;
+        int streams = 0;
+        int coupled = 0;
+        OpusProjectionEncoder* encoder = opus_projection_ambisonics_encoder_create(
+            kRate, channels, 3, &streams, &coupled, OPUS_APPLICATION_AUDIO, &error);
+        CHECK(error == OPUS_OK);
+
+        opus_int32 matrixSize = 0;
+        opus_projection_encoder_ctl(encoder, OPUS_PROJECTION_GET_DEMIXING_MATRIX_SIZE(&matrixSize));
+        std::vector<unsigned char> matrix(matrixSize);
+        opus_projection_encoder_ctl(encoder, OPUS_PROJECTION_GET_DEMIXING_MATRIX(matrix.data(), matrixSize));
+        head.channels = channels;
+        head.mappingFamily = 3;
+        head.streamCount = streams;
+        head.coupledCount = coupled;
+        for (opus_int32 i = 0; i + 1 < matrixSize; i += 2) {
+            head.demixingMatrix.push_back(static_cast<int16_t>(matrix[i] | (matrix[i + 1] << 8)));
+        }
+
+        std::vector<float> pcm = ambisonicNoise(channels, size_t(count) * kFrames);
+        unsigned char packet[4000];
+        for (int p = 0; p < count; p++) {
+            int size = opus_projection_encode_float(encoder, pcm.data() + size_t(p) * kFrames * channels, kFrames,
+                                                    packet, sizeof(packet));
+            CHECK(size > 0);
+            packets.emplace_back(packet, packet + size);
+        }
+        opus_projection_encoder_destroy(encoder);
+    }
+
+    std::vector<PacketView> views() const {
+        std::vector<PacketView> views;
+        for (const auto& packet : packets) {
+            views.push_back({packet.data(), packet.size()});
+        }
+        return views;
+    }
+};
+
+} // namespace
+
+TEST(binauralBlockSizesDoNotChangeOutput) {
+    std::vector<float> in = ambisonicNoise(4, 5000);
+    BinauralRenderer whole(defaultBinauralFilters(4, kRate));
+    std::vector<float> expected = render(whole, in, 4, {5000});
+
+    // Small blocks, blocks shorter than the filter history, and growth of
+    // the block buffers part way through
+    for (const std::vector<size_t>& blocks : {std::vector<size_t>{1}, {7, 3, 64}, {13, 480, 2, 1024, 31}}) {
+        BinauralRenderer renderer(defaultBinauralFilters(4, kRate));
+        CHECK(render(renderer, in, 4, blocks) == expected);
+    }
+}
+
+TEST(binauralOmnidirectionalImpulseIsSymmetric) {
+    BinauralFilters filters = defaultBinauralFilters(4, kRate);
+    const size_t frames = static_cast<size_t>(filters.length) + 16;
+    std::vector<float> in(frames * 4, 0.0f);
+    in[0] = 1.0f; // W only
+    BinauralRenderer renderer(filters);
+    std::vector<float> out = render(renderer, in, 4, {frames});
+
+    double energy = 0;
+    float difference = 0;
+    for (size_t i = 0; i < frames; i++) {
+        energy += double(out[2 * i]) * out[2 * i];
+        difference = std::max(difference, std::fabs(out[2 * i] - out[2 * i + 1]));
+    }
+    CHECK(energy > 0.01);
+    CHECK(difference < 1e-6f);
+
+    // And the response ends within the filter
+    CHECK(out[2 * (frames - 1)] == 0.0f);
+}
+
+TEST(binauralMixesNonDiegeticPairUnchanged) {
+    // First order plus a head-locked stereo pair, with silent ambisonics
+    const size_t frames = 300;
+    std::vector<float> in(frames * 6, 0.0f);
+    for (size_t i = 0; i < frames; i++) {
+        in[i * 6 + 4] = 0.001f * i;
+        in[i * 6 + 5] = -0.002f * i;
+    }
+    BinauralRenderer renderer(defaultBinauralFilters(6, kRate));
+    std::vector<float> out = render(renderer, in, 6, {frames});
+    bool unchanged = true;
+    for (size_t i = 0; i < frames; i++) {
+        unchanged = unchanged && out[2 * i] == in[i * 6 + 4] && out[2 * i + 1] == in[i * 6 + 5];
+    }
+    CHECK(unchanged);
+}
+
+TEST(binauralRejectsMismatchedFilters) {
+    CHECK_THROWS(defaultBinauralFilters(3, kRate));
+    BinauralFilters filters = defaultBinauralFilters(4, kRate);
+    filters.taps.pop_back();
+    CHECK_THROWS(BinauralRenderer(filters));
+}
+
+TEST(projectionDecodesAmbisonicStream) {
+    for (int channels : {4, 6, 9}) {
+        Ambisonic stream(channels, 5);
+        for (SampleFormat format : {SampleFormat::Int16, SampleFormat::Float32}) {
+            DecodeOptions options;
+            options.format = format;
+
+            ProjectionDecoderSession ambisonic(kRate, stream.head);
+            DecodeResult decoded = ambisonic.decode(stream.views(), options);
+            CHECK_EQ(ambisonic.outputChannels(), channels);
+            CHECK_EQ(decoded.packetsDecoded, 5);
+            CHECK_EQ(decoded.samplesDecoded, 5 * kFrames);
+            size_t samples = format == SampleFormat::Int16 ? decoded.pcm.size() : decoded.pcmFloat.size();
+            CHECK_EQ(samples, size_t(5 * kFrames * channels));
+
+            ProjectionDecoderSession binaural(kRate, stream.head);
+            binaural.enableBinaural({});
+            decoded = binaural.decode(stream.views(), options);
+            CHECK_EQ(binaural.outputChannels(), 2);
+            CHECK_EQ(decoded.samplesDecoded, 5 * kFrames);
+            samples = format == SampleFormat::Int16 ? decoded.pcm.size() : decoded.pcmFloat.size();
+            CHECK_EQ(samples, size_t(5 * kFrames * 2));
+        }
+    }
+}
+
+TEST(projectionRejectsWrongMatrix) {
+    Ambisonic stream(4, 1);
+    OpusHead head = stream.head;
+    head.demixingMatrix.pop_back();
+    CHECK_THROWS(ProjectionDecoderSession(kRate, head));
+}
@@ -0,0 +1,359 @@
+#include "DecoderSession.h"
+#include "TestHarness.h"
+#include "TestSignals.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace rnopus;
+
+namespace {
+
+constexpr int kRate = 16000;
+constexpr int kFrames = kRate / 50; // One 20 ms packet
+
+// The packets at `keep` positions, with those positions as sequence numbers
+struct Selection {
+    std::vector<PacketView> packets;
+    DecodeOptions options;
+};
+
+Selection select(const PacketList& list, const std::vector<uint32_t>& keep, uint32_t sequenceBase = 0) {
+    Selection selection;
+    for (uint32_t index : keep) {
+        selection.packets.push_back(list.packets[index]);
+        selection.options.sequenceNumbers.push_back((sequenceBase + index) & 0xFFFF);
+    }
+    return selection;
+}
+
+std::vector<uint32_t> allBut(size_t count, std::vector<uint32_t> lost) {
+    std::vector<uint32_t> keep;
+    for (uint32_t i = 0; i < count; i++) {
+        if (std::find(lost.begin(), lost.end(), i) == lost.end()) {
+            keep.push_back(i);
+        }
+    }
+    return keep;
+}
+
+} // namespace
+
+TEST(recoveryFillsGapFromInBandFec) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 20, Framing::U16, true);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+    CHECK(DecoderSession::hasFec(list.packets[11]));
+
+    DecoderSession session(kRate, 1);
+    Selection input = select(list, allBut(20, {10}));
+    DecodeResult decoded = session.decode(input.packets, input.options);
+    CHECK_EQ(decoded.packetsDecoded, 19);
+    CHECK_EQ(decoded.packetsRecovered, 1);
+    CHECK_EQ(decoded.packetsConcealed, 0);
+    CHECK_EQ(decoded.samplesRecovered, kFrames);
+    CHECK_EQ(decoded.samplesDecoded, 20 * kFrames);
+    CHECK_EQ(decoded.pcm.size(), size_t(20 * kFrames));
+    CHECK(decoded.gaps == std::vector<int64_t>{10});
+}
+
+TEST(recoveryConcealsWithoutFec) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 2, 20, Framing::U16);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+    CHECK(!DecoderSession::hasFec(list.packets[6]));
+
+    DecoderSession session(kRate, 2);
+    Selection input = select(list, allBut(20, {4, 5}));
+    DecodeResult decoded = session.decode(input.packets, input.options);
+    CHECK_EQ(decoded.packetsDecoded, 18);
+    CHECK_EQ(decoded.packetsRecovered, 0);
+    CHECK_EQ(decoded.packetsConcealed, 2);
+    CHECK_EQ(decoded.samplesConcealed, 2 * kFrames);
+    CHECK_EQ(decoded.pcm.size(), size_t(20 * kFrames * 2));
+    CHECK(decoded.gaps == (std::vector<int64_t>{4, 5}));
+
+    // The concealed audio continues the signal rather than going silent
+    int64_t energy = 0;
+    for (size_t i = 4 * kFrames * 2; i < 5 * kFrames * 2; i++) {
+        energy += std::abs(decoded.pcm[i]);
+    }
+    CHECK(energy > 0);
+}
+
+TEST(recoveryConcealsEmptyAndMalformedPackets) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 10, Framing::U16);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+    // Code 3 with a frame count of zero: rejected by libopus
+    const uint8_t malformed[] = {0x0B, 0x00};
+    list.packets[3] = {list.packets[3].data, 0};
+    list.packets[7] = {malformed, sizeof(malformed)};
+
+    DecoderSession session(kRate, 1);
+    DecodeOptions options;
+    options.concealLoss = true;
+    DecodeResult decoded = session.decode(list.packets, options);
+    CHECK_EQ(decoded.packetsDecoded, 8);
+    CHECK_EQ(decoded.packetsConcealed, 2);
+    CHECK_EQ(decoded.samplesDecoded, 10 * kFrames);
+    CHECK(decoded.gaps == (std::vector<int64_t>{3, 7}));
+    CHECK_EQ(session.stats().packetsFailed, uint64_t(1));
+
+    // Without concealLoss both are dropped from the timeline
+    session.reset();
+    decoded = session.decode(list.packets);
+    CHECK_EQ(decoded.packetsDecoded, 8);
+    CHECK_EQ(decoded.samplesDecoded, 8 * kFrames);
+}
+
+TEST(recoveryDropsLateAndDuplicatePackets) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 10, Framing::U16);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+
+    DecoderSession session(kRate, 1);
+    Selection input = select(list, {0, 1, 2, 2, 1, 3, 4});
+    DecodeResult decoded = session.decode(input.packets, input.options);
+    CHECK_EQ(decoded.packetsLate, 2);
+    CHECK_EQ(decoded.packetsDecoded, 5);
+    CHECK_EQ(decoded.samplesDecoded, 5 * kFrames);
+    CHECK(decoded.gaps.empty());
+
+    // A packet older than the last call is late too
+    input = select(list, {3, 5});
+    decoded = session.decode(input.packets, input.options);
+    CHECK_EQ(decoded.packetsLate, 1);
+    CHECK_EQ(decoded.packetsDecoded, 1);
+    CHECK_EQ(session.stats().packetsLate, uint64_t(3));
+}
+
+TEST(recoveryFillsGapsBetweenCalls) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 10, Framing::U16);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+
+    DecoderSession session(kRate, 1);
+    Selection first = select(list, {0, 1, 2, 3, 4});
+    session.decode(first.packets, first.options);
+    Selection second = select(list, {7, 8, 9});
+    DecodeResult decoded = session.decode(second.packets, second.options);
+    CHECK(decoded.gaps == (std::vector<int64_t>{5, 6}));
+    CHECK_EQ(decoded.packetsConcealed, 2);
+    CHECK_EQ(decoded.samplesDecoded, 5 * kFrames);
+
+    // reset() forgets the last sequence number
+    session.reset();
+    decoded = session.decode(first.packets, first.options);
+    CHECK(decoded.gaps.empty());
+}
+
+TEST(recoveryHandlesSequenceWraparound) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 6, Framing::U16);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+
+    DecoderSession session(kRate, 1);
+    // 65533, 65534, -, 0, 1, 2: one loss straddling the wrap
+    Selection input = select(list, {0, 1, 3, 4, 5}, 65533);
+    DecodeResult decoded = session.decode(input.packets, input.options);
+    CHECK_EQ(decoded.packetsLate, 0);
+    CHECK(decoded.gaps == std::vector<int64_t>{65535});
+    CHECK_EQ(decoded.samplesDecoded, 6 * kFrames);
+}
+
+TEST(recoveryRestartsAfterLongJump) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 4, Framing::U16);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+
+    // A gap of exactly kMaxConcealedRun (50) packets is concealed...
+    DecoderSession session(kRate, 1);
+    Selection input = select(list, {0, 1});
+    input.options.sequenceNumbers = {100, 151};
+    DecodeResult decoded = session.decode(input.packets, input.options);
+    CHECK_EQ(decoded.packetsConcealed, 50);
+    CHECK_EQ(decoded.samplesDecoded, 52 * kFrames);
+
+    // ...one more is taken as a stream restart: nothing is filled
+    session.reset();
+    input.options.sequenceNumbers = {100, 152};
+    decoded = session.decode(input.packets, input.options);
+    CHECK_EQ(decoded.packetsConcealed, 0);
+    CHECK(decoded.gaps.empty());
+    CHECK_EQ(decoded.samplesDecoded, 2 * kFrames);
+
+    // and decoding carries on from the new position
+    input = select(list, {2, 3});
+    input.options.sequenceNumbers = {154, 155};
+    decoded = session.decode(input.packets, input.options);
+    CHECK(decoded.gaps == std::vector<int64_t>{153});
+}
+
+TEST(recoveryFloatMatchesInt16Timeline) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 20, Framing::U16, true);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+    Selection input = select(list, allBut(20, {3, 12, 13}));
+
+    DecoderSession intSession(kRate, 1);
+    DecodeResult asInt = intSession.decode(input.packets, input.options);
+    DecoderSession floatSession(kRate, 1);
+    input.options.format = SampleFormat::Float32;
+    DecodeResult asFloat = floatSession.decode(input.packets, input.options);
+
+    CHECK_EQ(asFloat.pcmFloat.size(), asInt.pcm.size());
+    CHECK_EQ(asFloat.packetsRecovered, asInt.packetsRecovered);
+    CHECK_EQ(asFloat.packetsConcealed, asInt.packetsConcealed);
+    CHECK(asFloat.gaps == asInt.gaps);
+}
+
+TEST(recoveryRejectsMismatchedSequenceNumbers) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 3, Framing::U16);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+    DecoderSession session(kRate, 1);
+    DecodeOptions options;
+    options.sequenceNumbers = {0, 1};
+    CHECK_THROWS(session.decode(list.packets, options));
+}
+
+namespace {
+
+// Packets carrying up to `dredMs` of DRED history, or an empty list when
+// this libopus cannot encode DRED
+std::vector<std::vector<uint8_t>> encodeWithDred(int packets, int dredMs) {
+    int error = OPUS_OK;
+    OpusEncoder* encoder = opus_encoder_create(kRate, 1, OPUS_APPLICATION_VOIP, &error);
+    CHECK(error == OPUS_OK);
+    std::vector<std::vector<uint8_t>> out;
+    if (opus_encoder_ctl(encoder, OPUS_SET_DRED_DURATION(dredMs / 10)) == OPUS_OK) {
+        opus_encoder_ctl(encoder, OPUS_SET_BITRATE(32000));
+        opus_encoder_ctl(encoder, OPUS_SET_PACKET_LOSS_PERC(20));
+        std::vector<opus_int16> pcm = test::speechLike(kRate, 1, size_t(packets) * kFrames);
+        uint8_t packet[EncoderSession::kMaxPacketBytes];
+        for (int i = 0; i < packets; i++) {
+            int size = opus_encode(encoder, pcm.data() + i * kFrames, kFrames, packet, sizeof(packet));
+            CHECK(size > 0);
+            out.emplace_back(packet, packet + size);
+        }
+    }
+    opus_encoder_destroy(encoder);
+    return out;
+}
+
+} // namespace
+
+TEST(dredFallsBackToFecAndPlc) {
+    // No DRED in these packets: the burst is filled exactly as without dred
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 20, Framing::U16, true);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+    Selection input = select(list, allBut(20, {5, 6, 7}));
+
+    DecoderSession plain(kRate, 1);
+    DecodeResult expected = plain.decode(input.packets, input.options);
+    DecoderSession session(kRate, 1);
+    input.options.dred = true;
+    DecodeResult decoded = session.decode(input.packets, input.options);
+
+    CHECK_EQ(session.parseDred(list.packets[8], kRate).reach, 0);
+    CHECK_EQ(decoded.packetsDredRecovered, 0);
+    CHECK_EQ(decoded.packetsRecovered, 1); // The last lost packet, from packet 8's FEC
+    CHECK_EQ(decoded.packetsConcealed, 2);
+    CHECK(decoded.gaps == (std::vector<int64_t>{5, 6, 7}));
+    CHECK(decoded.pcm == expected.pcm);
+}
+
+TEST(dredCoverageExcludesUncoveredEnd) {
+    // DRED reaching 60 ms back whose newest 10 ms are not covered
+    DredCoverage coverage;
+    coverage.reach = 3 * kFrames;
+    coverage.end = kFrames / 2;
+    CHECK(coverage.covers(3 * kFrames, kFrames));
+    CHECK(coverage.covers(kFrames * 3 / 2, kFrames));
+    CHECK(!coverage.covers(3 * kFrames + 1, kFrames)); // Beyond the reach
+    CHECK(!coverage.covers(kFrames, kFrames));         // Ends in the gap
+    CHECK(!DredCoverage().covers(kFrames, kFrames));
+}
+
+TEST(dredImpliesConcealment) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 6, Framing::U16);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+    list.packets[2].size = 0;
+    DecoderSession session(kRate, 1);
+    DecodeOptions options;
+    options.dred = true;
+    DecodeResult decoded = session.decode(list.packets, options);
+    CHECK_EQ(decoded.packetsConcealed, 1);
+    CHECK_EQ(decoded.samplesDecoded, 6 * kFrames);
+}
+
+TEST(dredRecoversBurst) {
+    std::vector<std::vector<uint8_t>> packets = encodeWithDred(60, 500);
+    if (packets.empty()) {
+        std::printf("  dredRecoversBurst: skipped, libopus %s has no DRED encoder\n", opus_get_version_string());
+        return;
+    }
+    // DRED needs a few packets of history before it carries anything
+    std::vector<PacketView> views;
+    DecodeOptions options;
+    options.dred = true;
+    for (uint32_t i = 0; i < packets.size(); i++) {
+        if (i < 40 || i > 44) {
+            views.push_back({packets[i].data(), packets[i].size()});
+            options.sequenceNumbers.push_back(i);
+        }
+    }
+    DecoderSession session(kRate, 1);
+    DecodeResult decoded = session.decode(views, options);
+    CHECK(decoded.packetsDredRecovered >= 1);
+    CHECK_EQ(decoded.packetsDredRecovered + decoded.packetsRecovered + decoded.packetsConcealed, 5);
+    CHECK_EQ(decoded.samplesDecoded, 60 * kFrames);
+}
+
+TEST(resamplingKeepsCountsAtDecodingRate) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 10, Framing::U16, true);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+    Selection input = select(list, allBut(10, {4}));
+    DecoderSession session(kRate, 1);
+    session.setOutputRate(44100);
+    DecodeResult decoded = session.decode(input.packets, input.options);
+
+    CHECK_EQ(decoded.samplesDecoded, 10 * kFrames);
+    CHECK_EQ(decoded.samplesRecovered, kFrames);
+    CHECK_EQ(size_t(decoded.outputSamples), decoded.pcm.size());
+    // The resampler holds back its filter delay, so output trails the ratio
+    CHECK(decoded.outputSamples > 0 && decoded.outputSamples <= 10 * kFrames * 44100 / kRate);
+    CHECK_EQ(session.stats().samplesDecoded, uint64_t(10 * kFrames));
+}
+
+TEST(resamplingWholeStreamCoversItsDuration) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 10, Framing::U16);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+    DecodeOptions options;
+    options.wholeStream = true;
+    for (SampleFormat format : {SampleFormat::Int16, SampleFormat::Float32}) {
+        options.format = format;
+        DecoderSession plain(kRate, 1);
+        DecodeResult reference = plain.decode(list.packets, options);
+
+        DecoderSession session(kRate, 1);
+        session.setOutputRate(44100);
+        DecodeResult decoded = session.decode(list.packets, options);
+        CHECK_EQ(decoded.samplesDecoded, 10 * kFrames);
+        CHECK_EQ(decoded.outputSamples, 10 * kFrames * 44100 / kRate);
+        size_t size = format == SampleFormat::Float32 ? decoded.pcmFloat.size() : decoded.pcm.size();
+        CHECK_EQ(size_t(decoded.outputSamples), size);
+
+        // Aligned with the input: the energy of each 20 ms packet carries over
+        for (int packet = 0; packet < 10; packet++) {
+            double in = 0;
+            double out = 0;
+            for (int i = 0; i < kFrames; i++) {
+                double sample = format == SampleFormat::Float32 ? reference.pcmFloat[packet * kFrames + i]
+                                                                : reference.pcm[packet * kFrames + i] / 32768.0;
+                in += sample * sample;
+            }
+            for (int i = 0; i < 882; i++) {
+                double sample = format == SampleFormat::Float32 ? decoded.pcmFloat[packet * 882 + i]
+                                                                : decoded.pcm[packet * 882 + i] / 32768.0;
+                out += sample * sample;
+            }
+            CHECK(std::fabs(out / 882 - in / kFrames) <= 0.05 * in / kFrames + 1e-6);
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#include "FileTranscoder.h"
+#include "TestHarness.h"
+#include "TestSignals.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace rnopus;
+
+namespace {
+
+constexpr int kPaddedSize = 200;
+
+std::string tempPath(const char* name) {
+    return "/tmp/rnopus-test-" + std::to_string(getpid()) + "-" + name + ".opus";
+}
+
+void writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// A u16-framed file padded to kPaddedSize; returns the u16 bytes
+std::vector<uint8_t> writePadded(const std::string& u16Path, const std::string& fixedPath, int packets) {
+    EncodeResult encoded = test::encodeSpeech(16000, 1, packets, Framing::U16);
+    writeFile(u16Path, encoded.data);
+    FramingOptions framing;
+    framing.framing = Framing::U16;
+    PaddingSummary padded = padPacketFile(u16Path, fixedPath, framing, kPaddedSize);
+    CHECK_EQ(padded.packets, uint64_t(packets));
+    CHECK_EQ(padded.outputBytes, uint64_t(packets) * kPaddedSize);
+    CHECK_EQ(padded.truncatedBytes, uint64_t(0));
+    return encoded.data;
+}
+
+} // namespace
+
+TEST(paddingRoundTripsPackets) {
+    std::string u16Path = tempPath("pad-u16");
+    std::string fixedPath = tempPath("pad-fixed");
+    std::string outPath = tempPath("pad-out");
+    std::vector<uint8_t> original = writePadded(u16Path, fixedPath, 10);
+
+    PaddingSummary unpadded = unpadPacketFile(fixedPath, outPath, kPaddedSize, Framing::U16);
+    CHECK_EQ(unpadded.packets, uint64_t(10));
+    CHECK_EQ(unpadded.truncatedBytes, uint64_t(0));
+    CHECK(readFile(outPath) == original);
+
+    std::remove(u16Path.c_str());
+    std::remove(fixedPath.c_str());
+    std::remove(outPath.c_str());
+}
+
+TEST(unpadReportsTruncatedTail) {
+    std::string u16Path = tempPath("tail-u16");
+    std::string fixedPath = tempPath("tail-fixed");
+    std::string outPath = tempPath("tail-out");
+    std::vector<uint8_t> original = writePadded(u16Path, fixedPath, 4);
+
+    // A fifth packet cut short, as by an interrupted download
+    std::vector<uint8_t> fixed = readFile(fixedPath);
+    fixed.insert(fixed.end(), fixed.begin(), fixed.begin() + 37);
+    writeFile(fixedPath, fixed);
+
+    PaddingSummary unpadded = unpadPacketFile(fixedPath, outPath, kPaddedSize, Framing::U16);
+    CHECK_EQ(unpadded.packets, uint64_t(4));
+    CHECK_EQ(unpadded.inputBytes, uint64_t(fixed.size()));
+    CHECK_EQ(unpadded.truncatedBytes, uint64_t(37));
+    CHECK(readFile(outPath) == original);
+
+    std::remove(u16Path.c_str());
+    std::remove(fixedPath.c_str());
+    std::remove(outPath.c_str());
+}
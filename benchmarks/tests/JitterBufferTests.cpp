@@ -0,0 +1,213 @@
+#include "JitterBuffer.h"
+#include "TestHarness.h"
+#include "TestSignals.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace rnopus;
+
+namespace {
+
+constexpr int kRate = 16000;
+constexpr int kFrames = kRate / 50; // One 20 ms packet
+
+// Packets 0..count-1 of a speech-like stream, kept alive for the buffer
+struct Stream {
+    EncodeResult encoded;
+    PacketList list;
+
+    explicit Stream(int count)
+        : encoded(test::encodeSpeech(kRate, 1, count, Framing::U16)),
+          list(test::packetsOf(encoded, Framing::U16)) {}
+
+    // Sends packet `index` with RTP sequence number `sequence`. Its RTP
+    // timestamp and arrival time follow the packet's place in the stream, so
+    // the measured jitter stays zero whatever the sequence numbers do.
+    void push(JitterBuffer& buffer, size_t index, uint32_t sequence) const {
+        const PacketView& packet = list.packets[index];
+        buffer.push(sequence, static_cast<int64_t>(index) * 960, packet.data, packet.size, index * 20.0);
+    }
+};
+
+// With a 200 ms minimum delay, nothing is compressed until over 240 ms
+JitterBufferConfig config() {
+    JitterBufferConfig config;
+    config.minDelayMs = 200;
+    config.maxDelayMs = 400;
+    return config;
+}
+
+std::vector<float> pullFrames(JitterBuffer& buffer, int count, int chunk) {
+    std::vector<float> out(static_cast<size_t>(count) * buffer.channels());
+    for (int done = 0; done < count; done += chunk) {
+        CHECK(buffer.pull(out.data() + done * buffer.channels(), std::min(chunk, count - done)));
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(jitterBufferPlaysOutInOrder) {
+    Stream stream(10);
+    JitterBuffer buffer(kRate, 1, config());
+    std::vector<float> silence(kFrames);
+    CHECK(!buffer.pull(silence.data(), kFrames)); // Nothing buffered yet
+
+    // Out of order within the window
+    for (size_t index : {0, 2, 1, 3, 5, 4, 6, 7, 8, 9}) {
+        stream.push(buffer, index, static_cast<uint32_t>(index));
+    }
+    stream.push(buffer, 4, 4); // Duplicate
+    // Odd pull sizes exercise the partial-frame carry-over
+    std::vector<float> pcm = pullFrames(buffer, 10 * kFrames, 100);
+
+    DecoderSession reference(kRate, 1);
+    DecodeResult expected = reference.decode(stream.list.packets, SampleFormat::Float32);
+    CHECK(pcm == expected.pcmFloat);
+
+    JitterBufferStats stats = buffer.stats();
+    CHECK_EQ(stats.packetsReceived, uint64_t(11));
+    CHECK_EQ(stats.packetsDecoded, uint64_t(10));
+    CHECK_EQ(stats.packetsDuplicate, uint64_t(1));
+    CHECK_EQ(stats.packetsLost, uint64_t(0));
+    CHECK_EQ(stats.packetsConcealed, uint64_t(0));
+    CHECK_EQ(stats.bufferedPackets, size_t(0));
+    CHECK(stats.jitterMs == 0);
+}
+
+TEST(jitterBufferUnwrapsSequenceNumbers) {
+    Stream stream(12);
+    JitterBuffer buffer(kRate, 1, config());
+    // 65530 ... 65535, 0 ... 5
+    for (size_t index = 0; index < 12; index++) {
+        stream.push(buffer, index, static_cast<uint32_t>((65530 + index) & 0xFFFF));
+    }
+    pullFrames(buffer, 12 * kFrames, kFrames);
+
+    JitterBufferStats stats = buffer.stats();
+    CHECK_EQ(stats.packetsDecoded, uint64_t(12));
+    CHECK_EQ(stats.packetsLate, uint64_t(0));
+    CHECK_EQ(stats.packetsLost, uint64_t(0));
+
+    // 65535 is now behind the playout point, not 65535 packets ahead
+    stream.push(buffer, 5, 65535);
+    CHECK_EQ(buffer.stats().packetsLate, uint64_t(1));
+}
+
+TEST(jitterBufferConcealsSingleLoss) {
+    Stream stream(12);
+    JitterBuffer buffer(kRate, 1, config());
+    for (size_t index = 0; index < 12; index++) {
+        if (index != 4) {
+            stream.push(buffer, index, static_cast<uint32_t>(index));
+        }
+    }
+    std::vector<float> pcm = pullFrames(buffer, 12 * kFrames, kFrames);
+    CHECK_EQ(pcm.size(), size_t(12 * kFrames));
+
+    JitterBufferStats stats = buffer.stats();
+    CHECK_EQ(stats.packetsDecoded, uint64_t(11));
+    CHECK_EQ(stats.packetsLost, uint64_t(1));
+    CHECK_EQ(stats.packetsConcealed, uint64_t(1));
+    CHECK(stats.concealmentRatio > 0.08 && stats.concealmentRatio < 0.09);
+
+    // The late arrival of packet 4 is rejected
+    stream.push(buffer, 4, 4);
+    CHECK_EQ(buffer.stats().packetsLate, uint64_t(1));
+}
+
+TEST(jitterBufferSkipsSenderRestart) {
+    Stream stream(10);
+    JitterBuffer buffer(kRate, 1, config());
+    // 95 missing packets (1.9 s) is past maxDelayMs: a restart, not loss
+    for (size_t index = 0; index < 10; index++) {
+        uint32_t sequence = static_cast<uint32_t>(index < 5 ? index : index + 95);
+        stream.push(buffer, index, sequence);
+    }
+    pullFrames(buffer, 10 * kFrames, kFrames);
+
+    JitterBufferStats stats = buffer.stats();
+    CHECK_EQ(stats.packetsDecoded, uint64_t(10));
+    CHECK_EQ(stats.packetsLost, uint64_t(95));
+    CHECK_EQ(stats.packetsConcealed, uint64_t(0));
+    CHECK_EQ(stats.bufferedPackets, size_t(0));
+}
+
+TEST(jitterBufferRebuffersAfterUnderrun) {
+    Stream stream(20);
+    JitterBuffer buffer(kRate, 1, config());
+    for (size_t index = 0; index < 10; index++) {
+        stream.push(buffer, index, static_cast<uint32_t>(index));
+    }
+    pullFrames(buffer, 10 * kFrames, kFrames);
+
+    // Dry: PLC stretches the audio for maxDelayMs, then playout stops
+    std::vector<float> pcm(kFrames);
+    for (int i = 0; i < 20; i++) {
+        CHECK(buffer.pull(pcm.data(), kFrames));
+    }
+    JitterBufferStats stats = buffer.stats();
+    CHECK_EQ(stats.underruns, uint64_t(20));
+    CHECK_EQ(stats.packetsConcealed, uint64_t(20));
+    CHECK(!buffer.pull(pcm.data(), kFrames));
+
+    // Rebuffers to the target delay before playing again, without
+    // counting the underrun as loss
+    for (size_t index = 10; index < 20; index++) {
+        stream.push(buffer, index, static_cast<uint32_t>(index));
+        CHECK_EQ(buffer.pull(pcm.data(), kFrames), index == 19);
+    }
+    stats = buffer.stats();
+    CHECK_EQ(stats.packetsDecoded, uint64_t(11));
+    CHECK_EQ(stats.packetsLost, uint64_t(0));
+    CHECK_EQ(stats.underruns, uint64_t(20));
+}
+
+TEST(jitterBufferDropsOldestOnOverflow) {
+    Stream stream(60);
+    JitterBuffer buffer(kRate, 1, config());
+    for (size_t index = 0; index < 10; index++) {
+        stream.push(buffer, index, static_cast<uint32_t>(index));
+    }
+    std::vector<float> pcm(kFrames);
+    CHECK(buffer.pull(pcm.data(), kFrames)); // Plays packet 0
+
+    // 10-19 never arrive; 20-69 would buffer 1.18 s against an 800 ms cap
+    for (size_t index = 10; index < 60; index++) {
+        stream.push(buffer, index, static_cast<uint32_t>(index + 10));
+    }
+    JitterBufferStats stats = buffer.stats();
+    CHECK_EQ(stats.bufferedPackets, size_t(40));
+    CHECK(stats.currentDelayMs <= 800);
+    CHECK_EQ(stats.packetsDropped, uint64_t(19)); // 1-9 and 20-29
+    CHECK_EQ(stats.packetsLost, uint64_t(10));    // 10-19
+}
+
+TEST(jitterBufferInt16MatchesDecoderScale) {
+    // Near full scale, where 1/32767 and 1/32768 round differently
+    EncoderConfig encoderConfig;
+    encoderConfig.sampleRate = kRate;
+    EncoderSession encoder(encoderConfig);
+    std::vector<opus_int16> pcm = test::speechLike(kRate, 1, 10 * kFrames);
+    for (opus_int16& sample : pcm) {
+        sample = static_cast<opus_int16>(std::max(-32768, std::min(32767, sample * 2)));
+    }
+    EncodeResult encoded = encoder.encode(pcm.data(), pcm.size(), Framing::U16);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+
+    JitterBuffer buffer(kRate, 1, config());
+    for (size_t index = 0; index < list.packets.size(); index++) {
+        const PacketView& packet = list.packets[index];
+        buffer.push(static_cast<uint32_t>(index), static_cast<int64_t>(index) * 960, packet.data, packet.size, index * 20.0);
+    }
+    std::vector<opus_int16> pulled(10 * kFrames);
+    for (int done = 0; done < 10 * kFrames; done += kFrames) {
+        CHECK(buffer.pull(pulled.data() + done, kFrames));
+    }
+
+    // Same scale as opus_decode, so the int16 paths of the module agree
+    DecoderSession session(kRate, 1);
+    DecodeResult decoded = session.decode(list.packets);
+    CHECK(pulled == decoded.pcm);
+}
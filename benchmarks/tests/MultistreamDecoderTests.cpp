@@ -0,0 +1,156 @@
+#include "MultistreamDecoderSession.h"
+#include "TestHarness.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace rnopus;
+
+namespace {
+
+constexpr opus_int32 kRate = 48000;
+constexpr int kFrames = 960;
+constexpr int kPackets = 10;
+
+// 5.1 from the libopus surround encoder: a distinct tone on each channel,
+// one packet per 20 ms
+struct Surround {
+    OpusHead head;
+    std::vector<std::vector<uint8_t>> packets;
+
+    Surround() {
+        int streams = 0;
+        int coupled = 0;
+        unsigned char mapping[6];
+        int error = OPUS_OK;
+        OpusMSEncoder* encoder = opus_multistream_surround_encoder_create(
+            kRate, 6, 1, &streams, &coupled, mapping, OPUS_APPLICATION_AUDIO, &error);
+        CHECK(error == OPUS_OK);
+        head = defaultChannelLayout(6, 1);
+        CHECK_EQ(head.streamCount, streams);
+        CHECK_EQ(head.coupledCount, coupled);
+        CHECK(head.mapping == std::vector<uint8_t>(mapping, mapping + 6));
+
+        std::vector<float> pcm(kFrames * 6);
+        unsigned char packet[4000];
+        for (int p = 0; p < kPackets; p++) {
+            for (int i = 0; i < kFrames; i++) {
+                double t = double(p * kFrames + i) / kRate;
+                for (int channel = 0; channel < 6; channel++) {
+                    double frequency = channel == 5 ? 60 : 300 + 200 * channel; // Vorbis order: LFE last
+                    pcm[i * 6 + channel] = static_cast<float>(0.3 * std::sin(2 * M_PI * frequency * t));
+                }
+            }
+            int size = opus_multistream_encode_float(encoder, pcm.data(), kFrames, packet, sizeof(packet));
+            CHECK(size > 0);
+            packets.emplace_back(packet, packet + size);
+        }
+        opus_multistream_encoder_destroy(encoder);
+    }
+
+    std::vector<PacketView> views() const {
+        std::vector<PacketView> views;
+        for (const auto& packet : packets) {
+            views.push_back({packet.data(), packet.size()});
+        }
+        return views;
+    }
+};
+
+double channelRms(const std::vector<opus_int16>& pcm, int channels, int channel) {
+    double energy = 0;
+    size_t frames = pcm.size() / channels;
+    for (size_t i = 0; i < frames; i++) {
+        energy += double(pcm[i * channels + channel]) * pcm[i * channels + channel];
+    }
+    return std::sqrt(energy / frames);
+}
+
+} // namespace
+
+TEST(multistreamDecodesSurround) {
+    Surround surround;
+    MultistreamDecoderSession session(kRate, surround.head);
+    CHECK_EQ(session.channels(), 6);
+    CHECK_EQ(session.streamCount(), 4);
+    CHECK_EQ(session.coupledCount(), 2);
+
+    DecodeResult decoded = session.decode(surround.views(), {}, false);
+    CHECK_EQ(decoded.packetsDecoded, kPackets);
+    CHECK_EQ(decoded.samplesDecoded, kPackets * kFrames);
+    CHECK_EQ(decoded.pcm.size(), size_t(6 * kPackets * kFrames));
+    for (int channel = 0; channel < 6; channel++) {
+                CHECK(channelRms(decoded.pcm, 6, channel) > 1000);
+    }
+    CHECK_EQ(session.stats().samplesDecoded, uint64_t(kPackets * kFrames));
+}
+
+TEST(multistreamPlanarIsTransposed) {
+    Surround surround;
+    for (SampleFormat format : {SampleFormat::Int16, SampleFormat::Float32}) {
+        DecodeOptions options;
+        options.format = format;
+        MultistreamDecoderSession interleavedSession(kRate, surround.head);
+        MultistreamDecoderSession planarSession(kRate, surround.head);
+        DecodeResult interleaved = interleavedSession.decode(surround.views(), options, false);
+        DecodeResult planar = planarSession.decode(surround.views(), options, true);
+        CHECK_EQ(planar.samplesDecoded, interleaved.samplesDecoded);
+
+        const size_t frames = static_cast<size_t>(interleaved.samplesDecoded);
+        bool transposed = true;
+        for (size_t channel = 0; channel < 6; channel++) {
+            for (size_t i = 0; i < frames; i++) {
+                transposed = transposed && (format == SampleFormat::Int16
+                    ? planar.pcm[channel * frames + i] == interleaved.pcm[i * 6 + channel]
+                    : planar.pcmFloat[channel * frames + i] == interleaved.pcmFloat[i * 6 + channel]);
+            }
+        }
+        CHECK(transposed);
+    }
+}
+
+TEST(multistreamConcealsEmptyPackets) {
+    Surround surround;
+    std::vector<PacketView> views = surround.views();
+    views[4].size = 0;
+
+    MultistreamDecoderSession skipping(kRate, surround.head);
+    DecodeResult skipped = skipping.decode(views, {}, false);
+    CHECK_EQ(skipped.samplesDecoded, (kPackets - 1) * kFrames);
+    CHECK_EQ(skipped.packetsConcealed, 0);
+
+    MultistreamDecoderSession concealing(kRate, surround.head);
+    DecodeOptions options;
+    options.concealLoss = true;
+    DecodeResult concealed = concealing.decode(views, options, false);
+    CHECK_EQ(concealed.samplesDecoded, kPackets * kFrames);
+    CHECK_EQ(concealed.packetsDecoded, kPackets - 1);
+    CHECK_EQ(concealed.packetsConcealed, 1);
+    CHECK_EQ(concealed.samplesConcealed, kFrames);
+    CHECK(concealed.gaps == std::vector<int64_t>{4});
+}
+
+TEST(multistreamFamily255NeedsMapping) {
+    CHECK_THROWS(defaultChannelLayout(6, 255));
+    CHECK_THROWS(defaultChannelLayout(9, 1));
+
+    OpusHead head;
+    head.channels = 3;
+    head.mappingFamily = 255;
+    head.streamCount = 3;
+    head.coupledCount = 0;
+    CHECK_THROWS(MultistreamDecoderSession(kRate, head));
+
+    // With its mapping given, the same layout works
+    head.mapping = {0, 1, 2};
+    MultistreamDecoderSession session(kRate, head);
+    CHECK_EQ(session.channels(), 3);
+}
+
+TEST(multistreamRejectsRecoveryOptions) {
+    Surround surround;
+    MultistreamDecoderSession session(kRate, surround.head);
+    DecodeOptions options;
+    options.dred = true;
+    CHECK_THROWS(session.decode(surround.views(), options, false));
+}
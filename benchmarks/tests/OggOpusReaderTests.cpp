@@ -0,0 +1,213 @@
+#include "OggOpusReader.h"
+#include "TestHarness.h"
+#include "TestSignals.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace rnopus;
+
+namespace {
+
+struct Page {
+    std::vector<uint8_t> bytes;
+};
+
+// Minimal Ogg muxer: lays `packets` out on pages of at most `maxSegments`
+// lacing values, continuing packets across pages as needed.
+class OggBuilder {
+public:
+    explicit OggBuilder(int maxSegments) : maxSegments_(maxSegments) {}
+
+    void add(const std::vector<uint8_t>& packet, int64_t granule) {
+        size_t remaining = packet.size();
+        const uint8_t* data = packet.data();
+        for (;;) {
+            size_t chunk = std::min<size_t>(remaining, 255);
+            lacing_.push_back(static_cast<uint8_t>(chunk));
+            body_.insert(body_.end(), data, data + chunk);
+            data += chunk;
+            remaining -= chunk;
+            bool packetEnds = chunk < 255;
+            if (packetEnds) {
+                granule_ = granule;
+            }
+            if (static_cast<int>(lacing_.size()) == maxSegments_) {
+                flush(!packetEnds);
+            }
+            if (packetEnds) {
+                return;
+            }
+        }
+    }
+
+    // Every packet is complete after a flush, so the next page starts fresh
+    void flush(bool continues = false) {
+        if (lacing_.empty()) {
+            return;
+        }
+        std::vector<uint8_t> page(27 + lacing_.size());
+        std::memcpy(page.data(), "OggS", 4);
+        page[5] = (continued_ ? 0x01 : 0) | (sequence_ == 0 ? 0x02 : 0);
+        // A page where no packet ends carries granule -1
+        int64_t granule = continues && !packetEndedOnPage() ? -1 : granule_;
+        for (int i = 0; i < 8; i++) page[6 + i] = static_cast<uint8_t>(uint64_t(granule) >> (8 * i));
+        for (int i = 0; i < 4; i++) page[14 + i] = static_cast<uint8_t>(0x1234u >> (8 * i));
+        for (int i = 0; i < 4; i++) page[18 + i] = static_cast<uint8_t>(sequence_ >> (8 * i));
+        page[26] = static_cast<uint8_t>(lacing_.size());
+        std::memcpy(page.data() + 27, lacing_.data(), lacing_.size());
+        page.insert(page.end(), body_.begin(), body_.end());
+        uint32_t crc = oggCrc32(page.data(), page.size());
+        for (int i = 0; i < 4; i++) page[22 + i] = static_cast<uint8_t>(crc >> (8 * i));
+        pages.push_back({page});
+        sequence_++;
+        continued_ = continues;
+        lacing_.clear();
+        body_.clear();
+    }
+
+    std::vector<uint8_t> file(const std::vector<size_t>& dropPages = {}) const {
+        std::vector<uint8_t> out;
+        for (size_t i = 0; i < pages.size(); i++) {
+            if (std::find(dropPages.begin(), dropPages.end(), i) == dropPages.end()) {
+                out.insert(out.end(), pages[i].bytes.begin(), pages[i].bytes.end());
+            }
+        }
+        return out;
+    }
+
+    std::vector<Page> pages;
+
+private:
+    bool packetEndedOnPage() const {
+        for (uint8_t value : lacing_) {
+            if (value < 255) return true;
+        }
+        return false;
+    }
+
+    int maxSegments_;
+    std::vector<uint8_t> lacing_;
+    std::vector<uint8_t> body_;
+    uint32_t sequence_ = 0;
+    bool continued_ = false;
+    int64_t granule_ = 0;
+};
+
+std::vector<uint8_t> opusHead(int channels, int preSkip) {
+    std::vector<uint8_t> head(19);
+    std::memcpy(head.data(), "OpusHead", 8);
+    head[8] = 1;
+    head[9] = static_cast<uint8_t>(channels);
+    head[10] = static_cast<uint8_t>(preSkip);
+    head[11] = static_cast<uint8_t>(preSkip >> 8);
+    head[12] = 0x80; // 48000
+    head[13] = 0xBB;
+    return head;
+}
+
+std::vector<uint8_t> opusTags() {
+    std::vector<uint8_t> tags(16);
+    std::memcpy(tags.data(), "OpusTags", 8);
+    return tags;
+}
+
+void addHeaders(OggBuilder& ogg, int channels, int preSkip) {
+    ogg.add(opusHead(channels, preSkip), 0);
+    ogg.flush();
+    ogg.add(opusTags(), 0);
+    ogg.flush();
+}
+
+std::vector<uint8_t> filled(size_t size, uint8_t value) {
+    std::vector<uint8_t> packet(size, value);
+    packet[0] = 0x08;
+    return packet;
+}
+
+} // namespace
+
+TEST(oggJoinsPacketsAcrossPages) {
+    OggBuilder ogg(4);
+    addHeaders(ogg, 1, 0);
+    std::vector<std::vector<uint8_t>> packets = {filled(600, 1), filled(900, 2), filled(100, 3)};
+    for (const auto& packet : packets) {
+        ogg.add(packet, 960);
+    }
+    ogg.flush();
+    std::vector<uint8_t> file = ogg.file();
+
+    OggOpusStream stream = parseOggOpus(file.data(), file.size());
+    CHECK_EQ(stream.corruptPages, 0);
+    CHECK_EQ(stream.packets.size(), packets.size());
+    for (size_t i = 0; i < packets.size(); i++) {
+        CHECK(std::vector<uint8_t>(stream.packets[i].data, stream.packets[i].data + stream.packets[i].size) == packets[i]);
+    }
+}
+
+TEST(oggDropsPacketCutByMissingPage) {
+    // Three segments per page. Packet 1 (600 bytes) starts on page 2 and
+    // ends on page 3, where packet 2 (900 bytes) starts and runs on to page
+    // 4. Without page 3 every CRC still passes, but joining page 2's part of
+    // packet 1 with page 4's continuation would make a packet that never
+    // existed.
+    OggBuilder ogg(3);
+    addHeaders(ogg, 1, 0);
+    std::vector<std::vector<uint8_t>> packets = {filled(100, 0), filled(600, 1), filled(900, 2), filled(100, 3)};
+    for (const auto& packet : packets) {
+        ogg.add(packet, 960);
+    }
+    ogg.flush();
+    CHECK_EQ(ogg.pages.size(), size_t(5));
+
+    std::vector<uint8_t> complete = ogg.file();
+    CHECK_EQ(parseOggOpus(complete.data(), complete.size()).packets.size(), packets.size());
+
+    std::vector<uint8_t> file = ogg.file({3});
+    OggOpusStream stream = parseOggOpus(file.data(), file.size());
+    CHECK_EQ(stream.corruptPages, 0);
+    CHECK_EQ(stream.packets.size(), size_t(2));
+    for (size_t i = 0; i < 2; i++) {
+        std::vector<uint8_t> packet(stream.packets[i].data, stream.packets[i].data + stream.packets[i].size);
+        CHECK(packet == packets[i * 3]);
+    }
+}
+
+TEST(oggTrimsPreSkipWithoutMovingPcm) {
+    const int channels = 2;
+    const int packetCount = 25;
+    EncodeResult encoded = test::encodeSpeech(48000, channels, packetCount, Framing::U16);
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+    const int preSkip = 312;
+    const int64_t totalFrames = int64_t(packetCount) * 960 - 500; // End trimmed mid-packet
+
+    OggBuilder ogg(255);
+    addHeaders(ogg, channels, preSkip);
+    for (size_t i = 0; i < list.packets.size(); i++) {
+        int64_t granule = std::min<int64_t>(int64_t(i + 1) * 960, totalFrames + preSkip);
+        ogg.add(std::vector<uint8_t>(list.packets[i].data, list.packets[i].data + list.packets[i].size), granule);
+        if (i % 10 == 9) ogg.flush();
+    }
+    ogg.flush();
+    std::vector<uint8_t> file = ogg.file();
+
+    OggOpusStream stream = parseOggOpus(file.data(), file.size());
+    CHECK_EQ(stream.packets.size(), list.packets.size());
+    CHECK_EQ(stream.finalGranule, totalFrames + preSkip);
+
+    DecodeResult decoded = decodeOggOpus(stream, 48000);
+    CHECK_EQ(decoded.samplesDecoded, static_cast<int>(totalFrames));
+    CHECK_EQ(decoded.pcmOffset, size_t(preSkip * channels));
+    CHECK_EQ(decoded.pcm.size() - decoded.pcmOffset, size_t(totalFrames * channels));
+
+    // Same samples as a plain decode, shifted by the pre-skip
+    DecoderSession session(48000, channels);
+    DecodeResult reference = session.decode(list.packets);
+    CHECK(std::equal(decoded.pcm.begin() + decoded.pcmOffset, decoded.pcm.end(), reference.pcm.begin() + preSkip * channels));
+
+    // At 16 kHz the pre-skip scales with the rate
+    DecodeResult narrow = decodeOggOpus(stream, 16000);
+    CHECK_EQ(narrow.pcmOffset, size_t(preSkip / 3 * channels));
+    CHECK_EQ(narrow.samplesDecoded, static_cast<int>(totalFrames / 3));
+}
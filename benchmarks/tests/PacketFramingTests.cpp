@@ -0,0 +1,171 @@
+#include "PacketFraming.h"
+#include "TestHarness.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace rnopus;
+
+namespace {
+
+// Three code-0 packets (TOC 0x08: SILK NB 20 ms) of 3, 300 and 1 bytes.
+// 300 needs a two-byte varint and a two-byte self-delimited length.
+std::vector<std::vector<uint8_t>> samplePackets() {
+    std::vector<std::vector<uint8_t>> packets;
+    for (size_t size : {3, 300, 1}) {
+        std::vector<uint8_t> packet(size);
+        packet[0] = 0x08;
+        for (size_t i = 1; i < size; i++) {
+            packet[i] = static_cast<uint8_t>(i * 7);
+        }
+        packets.push_back(packet);
+    }
+    return packets;
+}
+
+std::vector<uint8_t> frame(Framing framing) {
+    std::vector<uint8_t> out;
+    for (const auto& packet : samplePackets()) {
+        appendPacket(out, packet.data(), packet.size(), framing);
+    }
+    return out;
+}
+
+// RFC 6716 Appendix B: a code-0 packet gains its frame length after the TOC
+std::vector<uint8_t> selfDelimited() {
+    std::vector<uint8_t> out;
+    for (const auto& packet : samplePackets()) {
+        size_t length = packet.size() - 1;
+        out.push_back(packet[0]);
+        if (length < 252) {
+            out.push_back(static_cast<uint8_t>(length));
+        } else {
+            out.push_back(static_cast<uint8_t>(252 + (length & 3)));
+            out.push_back(static_cast<uint8_t>((length - 252) >> 2));
+        }
+        out.insert(out.end(), packet.begin() + 1, packet.end());
+    }
+    return out;
+}
+
+void checkPackets(const PacketList& list, size_t count) {
+    auto expected = samplePackets();
+    CHECK_EQ(list.packets.size(), count);
+    for (size_t i = 0; i < count; i++) {
+        CHECK(std::vector<uint8_t>(list.packets[i].data, list.packets[i].data + list.packets[i].size) == expected[i]);
+    }
+}
+
+// Cutting the input at every byte inside the last packet, including inside
+// its prefix, must throw from splitPackets and stop cleanly at the start of
+// that packet from a partial-tail reader.
+void checkTruncatedTail(const std::vector<uint8_t>& input, const FramingOptions& options) {
+    FramingOptions complete = options;
+    size_t lastStart = 0;
+    {
+        PacketReader reader(input.data(), input.size(), complete);
+        PacketView packet;
+        for (int i = 0; i < 2; i++) {
+            CHECK(reader.next(packet));
+        }
+        lastStart = reader.offset();
+    }
+    checkPackets(splitPackets(input.data(), input.size(), options), 3);
+
+    for (size_t cut = lastStart + 1; cut < input.size(); cut++) {
+        CHECK_THROWS(splitPackets(input.data(), cut, options));
+
+        size_t consumed = 0;
+        PacketList list = splitCompletePackets(input.data(), cut, options, consumed);
+        checkPackets(list, 2);
+        CHECK_EQ(consumed, lastStart);
+    }
+}
+
+} // namespace
+
+TEST(packetReaderRoundTripsEveryFraming) {
+    FramingOptions options;
+    options.framing = Framing::U16;
+    checkPackets(splitPackets(frame(Framing::U16).data(), frame(Framing::U16).size(), options), 3);
+
+    std::vector<uint8_t> varint = frame(Framing::Varint);
+    CHECK_EQ(varint.size(), size_t(3 + 300 + 1 + 4));
+    options.framing = Framing::Varint;
+    checkPackets(splitPackets(varint.data(), varint.size(), options), 3);
+
+    std::vector<uint8_t> bare = frame(Framing::Lengths);
+    options.framing = Framing::Lengths;
+    options.lengths = {3, 300, 1};
+    checkPackets(splitPackets(bare.data(), bare.size(), options), 3);
+
+    std::vector<uint8_t> delimited = selfDelimited();
+    options.framing = Framing::SelfDelimited;
+    checkPackets(splitPackets(delimited.data(), delimited.size(), options), 3);
+}
+
+TEST(packetReaderRejectsTruncatedU16Tail) {
+    FramingOptions options;
+    options.framing = Framing::U16;
+    checkTruncatedTail(frame(Framing::U16), options);
+}
+
+TEST(packetReaderRejectsTruncatedVarintTail) {
+    // Ends with a one-byte packet; append a 300-byte one so the cut also
+    // lands between the two bytes of its length prefix
+    FramingOptions options;
+    options.framing = Framing::Varint;
+    checkTruncatedTail(frame(Framing::Varint), options);
+
+    std::vector<uint8_t> input = frame(Framing::Varint);
+    std::vector<uint8_t> tail(300, 0x08);
+    appendPacket(input, tail.data(), tail.size(), Framing::Varint);
+    size_t tailStart = input.size() - 302;
+    CHECK_THROWS(splitPackets(input.data(), tailStart + 1, options));
+    size_t consumed = 0;
+    CHECK_EQ(splitCompletePackets(input.data(), tailStart + 1, options, consumed).packets.size(), size_t(3));
+    CHECK_EQ(consumed, tailStart);
+}
+
+TEST(packetReaderRejectsTruncatedSelfDelimitedTail) {
+    FramingOptions options;
+    options.framing = Framing::SelfDelimited;
+    checkTruncatedTail(selfDelimited(), options);
+}
+
+TEST(packetReaderRejectsOverlongVarint) {
+    const uint8_t input[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01};
+    FramingOptions options;
+    options.framing = Framing::Varint;
+    CHECK_THROWS(splitPackets(input, sizeof(input), options));
+}
+
+TEST(packetReaderFixedFramingDropsShortTail) {
+    std::vector<uint8_t> input(25, 0x08);
+    FramingOptions options;
+    options.packetSize = 10;
+    CHECK_EQ(splitPackets(input.data(), input.size(), options).packets.size(), size_t(2));
+
+    PacketReader reader(input.data(), input.size(), options);
+    PacketView packet;
+    while (reader.next(packet)) {
+    }
+    CHECK_EQ(reader.skippedBytes(), size_t(5));
+
+    size_t consumed = 0;
+    CHECK_EQ(splitCompletePackets(input.data(), input.size(), options, consumed).packets.size(), size_t(2));
+    CHECK_EQ(consumed, size_t(20));
+
+    // A lone short packet is still passed through, as before
+    CHECK_EQ(splitPackets(input.data(), 5, options).packets.size(), size_t(1));
+}
+
+TEST(packetReaderChecksLengthsCoverInput) {
+    std::vector<uint8_t> bare = frame(Framing::Lengths);
+    FramingOptions options;
+    options.framing = Framing::Lengths;
+    options.lengths = {3, 300};
+    CHECK_THROWS(splitPackets(bare.data(), bare.size(), options));
+    options.lengths = {3, 300, 2};
+    CHECK_THROWS(splitPackets(bare.data(), bare.size(), options));
+}
@@ -0,0 +1,137 @@
+#include "PcmRingBuffer.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace rnopus;
+
+namespace {
+
+// Stereo frames whose channels both carry `first`, `first` + 1, ...
+std::vector<float> counterFrames(uint32_t first, size_t frames) {
+    std::vector<float> pcm(frames * 2);
+    for (size_t i = 0; i < frames; i++) {
+        pcm[2 * i] = pcm[2 * i + 1] = static_cast<float>(first + i);
+    }
+    return pcm;
+}
+
+} // namespace
+
+TEST(pcmRingRoundsCapacityToPowerOfTwo) {
+    CHECK_EQ(PcmRingBuffer(1, 1).capacityFrames(), size_t(1));
+    CHECK_EQ(PcmRingBuffer(100, 2).capacityFrames(), size_t(128));
+    CHECK_EQ(PcmRingBuffer(256, 2).capacityFrames(), size_t(256));
+    CHECK_EQ(PcmRingBuffer(257, 1).capacityFrames(), size_t(512));
+    CHECK_THROWS(PcmRingBuffer(0, 1));
+    CHECK_THROWS(PcmRingBuffer(16, 0));
+}
+
+TEST(pcmRingWriteStopsWhenFull) {
+    PcmRingBuffer ring(8, 2);
+    std::vector<float> pcm = counterFrames(1, 6);
+    CHECK_EQ(ring.write(pcm.data(), 6), size_t(6));
+    // Two frames of room: the rest are dropped, the queued audio is kept
+    pcm = counterFrames(7, 5);
+    CHECK_EQ(ring.write(pcm.data(), 5), size_t(2));
+    CHECK_EQ(ring.write(pcm.data(), 1), size_t(0));
+    PcmRingStats stats = ring.stats();
+    CHECK_EQ(stats.framesDropped, uint64_t(4));
+    CHECK_EQ(stats.framesWritten, uint64_t(8));
+    CHECK_EQ(stats.fillFrames, size_t(8));
+
+    std::vector<float> out(16);
+    CHECK_EQ(ring.read(out.data(), 8), size_t(8));
+    CHECK(out == counterFrames(1, 8));
+}
+
+TEST(pcmRingPadsUnderrunWithSilence) {
+    PcmRingBuffer ring(16, 2);
+    std::vector<float> out(20, 1.0f);
+    // Reads before the first write are early, not underruns
+    CHECK_EQ(ring.read(out.data(), 4), size_t(0));
+    CHECK(std::vector<float>(out.begin(), out.begin() + 8) == std::vector<float>(8, 0.0f));
+    CHECK_EQ(ring.stats().underruns, uint64_t(0));
+
+    std::vector<float> pcm = counterFrames(1, 3);
+    ring.write(pcm.data(), 3);
+    std::fill(out.begin(), out.end(), 1.0f);
+    CHECK_EQ(ring.read(out.data(), 10), size_t(3));
+    CHECK(std::vector<float>(out.begin(), out.begin() + 6) == pcm);
+    CHECK(std::vector<float>(out.begin() + 6, out.end()) == std::vector<float>(14, 0.0f));
+    PcmRingStats stats = ring.stats();
+    CHECK_EQ(stats.underruns, uint64_t(1));
+    CHECK_EQ(stats.underrunFrames, uint64_t(7));
+    CHECK_EQ(stats.framesRead, uint64_t(3));
+}
+
+TEST(pcmRingStreamsBetweenThreads) {
+    // A small ring so the positions wrap thousands of times
+    PcmRingBuffer ring(64, 2);
+    constexpr uint32_t kTotal = 1 << 18;
+    std::atomic<bool> producing{true};
+    uint64_t rejected = 0;  // Frames write() turned away, retried or not
+    uint64_t abandoned = 0; // Frames never written
+
+    std::thread producer([&] {
+        uint32_t next = 1;
+        size_t chunk = 1;
+        for (int write = 0; next <= kTotal; write++) {
+            size_t frames = std::min<size_t>(chunk, kTotal + 1 - next);
+            std::vector<float> pcm = counterFrames(next, frames);
+            size_t written = ring.write(pcm.data(), frames);
+            rejected += frames - written;
+            // Usually wait for room and write the rest; now and then let the
+            // rest go, so real drops are mixed in
+            while (written < frames && write % 16 != 0) {
+                std::this_thread::yield();
+                size_t count = ring.write(pcm.data() + written * 2, frames - written);
+                rejected += frames - written - count;
+                written += count;
+            }
+            abandoned += frames - written;
+            next += static_cast<uint32_t>(frames);
+            chunk = chunk % 37 + 1;
+        }
+        producing = false;
+    });
+
+    uint64_t audioFrames = 0;
+    uint64_t skipped = 0;
+    float last = 0;
+    bool ordered = true;
+    std::vector<float> out(2 * 50);
+    size_t chunk = 1;
+    while (true) {
+        bool done = !producing.load();
+        size_t count = ring.read(out.data(), chunk);
+        for (size_t i = 0; i < count; i++) {
+            float value = out[2 * i];
+            ordered = ordered && value > last && out[2 * i + 1] == value;
+            skipped += static_cast<uint64_t>(value - last - 1);
+            last = value;
+        }
+        audioFrames += count;
+        if (done && ring.fillFrames() == 0) {
+            break;
+        }
+        if (count < chunk) {
+            std::this_thread::yield();
+        }
+        chunk = chunk % 50 + 1;
+    }
+    producer.join();
+
+    PcmRingStats stats = ring.stats();
+    CHECK(ordered);
+    CHECK_EQ(stats.framesDropped, rejected);
+    CHECK_EQ(audioFrames, stats.framesRead);
+    CHECK_EQ(stats.framesWritten, stats.framesRead);
+    CHECK_EQ(audioFrames + abandoned, uint64_t(kTotal));
+    // Every gap in the counter is an abandoned frame, and nothing else is lost
+    CHECK_EQ(skipped + (kTotal - static_cast<uint32_t>(last)), abandoned);
+    CHECK(stats.framesRead > 1000 * ring.capacityFrames());
+}
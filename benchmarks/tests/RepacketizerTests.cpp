@@ -0,0 +1,152 @@
+#include "DecoderSession.h"
+#include "Repacketizer.h"
+#include "TestHarness.h"
+#include "TestSignals.h"
+
+#include <vector>
+
+using namespace rnopus;
+
+namespace {
+
+constexpr opus_int32 kRate = 16000;
+
+// The bare packets of a repacketize result
+std::vector<std::vector<uint8_t>> packetsOf(const RepacketizeResult& result) {
+    FramingOptions options;
+    options.framing = Framing::U16;
+    PacketList list = splitPackets(result.data.data(), result.data.size(), options);
+    std::vector<std::vector<uint8_t>> packets;
+    for (const PacketView& packet : list.packets) {
+        packets.emplace_back(packet.data, packet.data + packet.size);
+    }
+    CHECK_EQ(packets.size(), result.lengths.size());
+    return packets;
+}
+
+std::vector<std::vector<uint8_t>> copies(const std::vector<PacketView>& views) {
+    std::vector<std::vector<uint8_t>> packets;
+    for (const PacketView& packet : views) {
+        packets.emplace_back(packet.data, packet.data + packet.size);
+    }
+    return packets;
+}
+
+std::vector<PacketView> viewsOf(const std::vector<std::vector<uint8_t>>& packets) {
+    std::vector<PacketView> views;
+    for (const auto& packet : packets) {
+        views.push_back({packet.data(), packet.size()});
+    }
+    return views;
+}
+
+std::vector<opus_int16> decodeAll(const std::vector<std::vector<uint8_t>>& packets) {
+    DecoderSession decoder(kRate, 1);
+    return decoder.decode(viewsOf(packets)).pcm;
+}
+
+int framesIn(const std::vector<uint8_t>& packet) {
+    return opus_packet_get_nb_frames(packet.data(), static_cast<opus_int32>(packet.size()));
+}
+
+} // namespace
+
+TEST(repacketizerMergeThenSplitRoundTrips) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 25, Framing::U16);
+    std::vector<std::vector<uint8_t>> original = copies(test::packetsOf(encoded, Framing::U16).packets);
+
+    Repacketizer repacketizer;
+    for (int group : {0, 1, 2, 4, 6}) {
+        std::vector<std::vector<uint8_t>> merged = packetsOf(repacketizer.merge(viewsOf(original), group, Framing::U16));
+        RepacketizeResult split = repacketizer.split(viewsOf(merged), Framing::U16);
+        CHECK_EQ(split.framesOut, 25);
+        CHECK(packetsOf(split) == original);
+        CHECK(decodeAll(merged) == decodeAll(original));
+    }
+}
+
+TEST(repacketizerMergeCapsAt120MsAndSplitsOnTocChange) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 15, Framing::U16);
+    std::vector<std::vector<uint8_t>> speech = copies(test::packetsOf(encoded, Framing::U16).packets);
+
+    Repacketizer repacketizer;
+    RepacketizeResult all = repacketizer.merge(viewsOf(speech), 0, Framing::U16);
+    std::vector<std::vector<uint8_t>> merged = packetsOf(all);
+    CHECK_EQ(all.framesOut, 15);
+    CHECK_EQ(merged.size(), size_t(3)); // 6 + 6 + 3 frames of 20 ms
+    for (const auto& packet : merged) {
+        CHECK(opus_packet_get_nb_samples(packet.data(), static_cast<opus_int32>(packet.size()), kRate) <=
+              kRate * 120 / 1000);
+    }
+
+    // Three SILK packets then three CELT ones: different TOCs never share a
+    // packet, even inside one group
+    EncoderConfig config;
+    config.sampleRate = kRate;
+    config.application = OPUS_APPLICATION_RESTRICTED_LOWDELAY;
+    EncoderSession celtEncoder(config);
+    std::vector<opus_int16> pcm = test::speechLike(kRate, 1, 3 * celtEncoder.frameSize());
+    EncodeResult celt = celtEncoder.encode(pcm.data(), pcm.size(), Framing::U16);
+    std::vector<std::vector<uint8_t>> mixed(speech.begin(), speech.begin() + 3);
+    for (const auto& packet : copies(test::packetsOf(celt, Framing::U16).packets)) {
+        CHECK(packet[0] >> 3 != mixed[0][0] >> 3);
+        mixed.push_back(packet);
+    }
+    merged = packetsOf(repacketizer.merge(viewsOf(mixed), 0, Framing::U16));
+    CHECK_EQ(merged.size(), size_t(2));
+    CHECK_EQ(merged[0][0] >> 3, mixed[0][0] >> 3);
+    CHECK_EQ(merged[1][0] >> 3, mixed[3][0] >> 3);
+    CHECK_EQ(framesIn(merged[0]), 3);
+    CHECK_EQ(framesIn(merged[1]), 3);
+}
+
+TEST(repacketizerExtractsFramesInsidePackets) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 12, Framing::U16);
+    std::vector<std::vector<uint8_t>> original = copies(test::packetsOf(encoded, Framing::U16).packets);
+
+    Repacketizer repacketizer;
+    // Four packets of three frames each
+    std::vector<std::vector<uint8_t>> grouped = packetsOf(repacketizer.merge(viewsOf(original), 3, Framing::U16));
+    CHECK_EQ(grouped.size(), size_t(4));
+
+    // Frames 4..7 start on the second frame of packet 1 and end on the
+    // second frame of packet 2
+    RepacketizeResult extracted = repacketizer.extractFrames(viewsOf(grouped), 4, 4, Framing::U16);
+    CHECK_EQ(extracted.framesOut, 4);
+    std::vector<std::vector<uint8_t>> range(original.begin() + 4, original.begin() + 8);
+    CHECK(packetsOf(repacketizer.split(viewsOf(packetsOf(extracted)), Framing::U16)) == range);
+
+    // Open-ended, from inside the last packet
+    extracted = repacketizer.extractFrames(viewsOf(grouped), 10, -1, Framing::U16);
+    CHECK_EQ(extracted.framesOut, 2);
+    range.assign(original.begin() + 10, original.end());
+    CHECK(packetsOf(repacketizer.split(viewsOf(packetsOf(extracted)), Framing::U16)) == range);
+
+    CHECK_EQ(repacketizer.extractFrames(viewsOf(grouped), 12, 5, Framing::U16).framesOut, 0);
+    CHECK_THROWS(repacketizer.extractFrames(viewsOf(grouped), -1, 1, Framing::U16));
+}
+
+TEST(repacketizerPassesZeroLengthPacketsInPlace) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 4, Framing::U16);
+    std::vector<std::vector<uint8_t>> speech = copies(test::packetsOf(encoded, Framing::U16).packets);
+    std::vector<std::vector<uint8_t>> input = {speech[0], {}, speech[1], speech[2], {}, speech[3]};
+    auto lengthsOf = [](const RepacketizeResult& result) {
+        std::vector<bool> empty;
+        for (uint32_t length : result.lengths) {
+            empty.push_back(length == 0);
+        }
+        return empty;
+    };
+
+    Repacketizer repacketizer;
+    RepacketizeResult merged = repacketizer.merge(viewsOf(input), 0, Framing::U16);
+    CHECK(lengthsOf(merged) == std::vector<bool>({false, true, false, true, false}));
+    CHECK_EQ(merged.framesOut, 4);
+
+    RepacketizeResult split = repacketizer.split(viewsOf(input), Framing::U16);
+    CHECK(packetsOf(split) == input);
+
+    RepacketizeResult extracted = repacketizer.extractFrames(viewsOf(input), 1, -1, Framing::U16);
+    CHECK(lengthsOf(extracted) == std::vector<bool>({true, false, true, false}));
+    CHECK_EQ(extracted.framesOut, 3);
+}
@@ -0,0 +1,120 @@
+#include "StreamDecoder.h"
+#include "TestHarness.h"
+#include "TestSignals.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace rnopus;
+
+namespace {
+
+constexpr opus_int32 kRate = 16000;
+
+FramingOptions framingOf(Framing framing, int packetSize = 0) {
+    FramingOptions options;
+    options.framing = framing;
+    options.packetSize = packetSize;
+    return options;
+}
+
+// RFC 6716 Appendix B framing of single-frame (code 0) packets: the frame
+// length follows the TOC byte
+std::vector<uint8_t> selfDelimited(const EncodeResult& encoded) {
+    PacketList list = test::packetsOf(encoded, Framing::U16);
+    std::vector<uint8_t> out;
+    for (const PacketView& packet : list.packets) {
+        CHECK_EQ(packet.data[0] & 3, 0);
+        size_t length = packet.size - 1;
+        out.push_back(packet.data[0]);
+        if (length < 252) {
+            out.push_back(static_cast<uint8_t>(length));
+        } else {
+            out.push_back(static_cast<uint8_t>(252 + (length & 3)));
+            out.push_back(static_cast<uint8_t>((length - 252) >> 2));
+        }
+        out.insert(out.end(), packet.data + 1, packet.data + packet.size);
+    }
+    return out;
+}
+
+// PCM from feeding `data` in two chunks split at `split`
+std::vector<opus_int16> decodeSplit(const std::vector<uint8_t>& data, size_t split, const FramingOptions& framing) {
+    StreamDecoder decoder(kRate, 1, framing);
+    std::vector<opus_int16> pcm = decoder.feed(data.data(), split).pcm;
+    std::vector<opus_int16> rest = decoder.feed(data.data() + split, data.size() - split).pcm;
+    pcm.insert(pcm.end(), rest.begin(), rest.end());
+    CHECK_EQ(decoder.pendingBytes(), size_t(0));
+    return pcm;
+}
+
+// The same stream split at every byte boundary decodes to the same PCM
+void checkEverySplit(const std::vector<uint8_t>& data, const FramingOptions& framing, int packets) {
+    StreamDecoder whole(kRate, 1, framing);
+    DecodeResult expected = whole.feed(data.data(), data.size());
+    CHECK_EQ(expected.packetsDecoded, packets);
+    for (size_t split = 0; split <= data.size(); split++) {
+        if (decodeSplit(data, split, framing) != expected.pcm) {
+            CHECK(!"PCM differs when split");
+            std::printf("    split at byte %zu of %zu\n", split, data.size());
+            return;
+        }
+    }
+}
+
+} // namespace
+
+TEST(streamDecoderSplitsU16AtEveryByte) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 8, Framing::U16);
+    checkEverySplit(encoded.data, framingOf(Framing::U16), 8);
+}
+
+TEST(streamDecoderSplitsVarintAtEveryByte) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 8, Framing::Varint);
+    checkEverySplit(encoded.data, framingOf(Framing::Varint), 8);
+}
+
+TEST(streamDecoderSplitsSelfDelimitedAtEveryByte) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 8, Framing::U16);
+    checkEverySplit(selfDelimited(encoded), framingOf(Framing::SelfDelimited), 8);
+}
+
+TEST(streamDecoderSplitsFixedAtEveryByte) {
+    EncoderConfig config;
+    config.sampleRate = kRate;
+    config.bitrate = 24000;
+    config.vbr = false;
+    EncoderSession encoder(config);
+    std::vector<opus_int16> pcm = test::speechLike(kRate, 1, 8 * size_t(encoder.frameSize()));
+    EncodeResult encoded = encoder.encode(pcm.data(), pcm.size(), Framing::Fixed);
+    checkEverySplit(encoded.data, framingOf(Framing::Fixed, int(encoded.lengths[0])), 8);
+}
+
+TEST(streamDecoderTakesOneByteAtATime) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 8, Framing::Varint);
+    StreamDecoder whole(kRate, 1, framingOf(Framing::Varint));
+    std::vector<opus_int16> expected = whole.feed(encoded.data.data(), encoded.data.size()).pcm;
+
+    StreamDecoder decoder(kRate, 1, framingOf(Framing::Varint));
+    std::vector<opus_int16> pcm;
+    int packets = 0;
+    for (uint8_t byte : encoded.data) {
+        DecodeResult decoded = decoder.feed(&byte, 1);
+        packets += decoded.packetsDecoded;
+        pcm.insert(pcm.end(), decoded.pcm.begin(), decoded.pcm.end());
+    }
+    CHECK_EQ(packets, 8);
+    CHECK(pcm == expected);
+    CHECK_EQ(decoder.pendingBytes(), size_t(0));
+}
+
+TEST(streamDecoderHoldsIncompletePacket) {
+    EncodeResult encoded = test::encodeSpeech(kRate, 1, 2, Framing::U16);
+    StreamDecoder decoder(kRate, 1, framingOf(Framing::U16));
+    size_t first = 2 + encoded.lengths[0];
+    DecodeResult decoded = decoder.feed(encoded.data.data(), first + 3);
+    CHECK_EQ(decoded.packetsDecoded, 1);
+    CHECK_EQ(decoder.pendingBytes(), size_t(3));
+    decoder.reset();
+    CHECK_EQ(decoder.pendingBytes(), size_t(0));
+}
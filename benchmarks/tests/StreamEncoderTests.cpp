@@ -0,0 +1,132 @@
+#include "StreamEncoder.h"
+#include "TestHarness.h"
+#include "TestSignals.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace rnopus;
+
+namespace {
+
+constexpr opus_int32 kRate = 16000;
+constexpr int kFrames = kRate / 50;
+
+StreamEncoderConfig config() {
+    StreamEncoderConfig config;
+    config.encoder.sampleRate = kRate;
+    config.encoder.application = OPUS_APPLICATION_VOIP;
+    config.encoder.bitrate = 24000;
+    return config;
+}
+
+// The same PCM through a one-shot EncoderSession
+EncodeResult reference(const std::vector<opus_int16>& pcm) {
+    EncoderSession encoder(config().encoder);
+    return encoder.encode(pcm.data(), pcm.size(), Framing::U16);
+}
+
+} // namespace
+
+TEST(streamEncoderMatchesOneShotForAnyChunking) {
+    std::vector<opus_int16> pcm = test::speechLike(kRate, 1, 25 * kFrames);
+    EncodeResult expected = reference(pcm);
+
+    for (size_t chunk : {1, 7, 160, 320, 333, 1000}) {
+        StreamEncoder encoder(config());
+        EncodeResult pulled;
+        for (size_t offset = 0; offset < pcm.size(); offset += chunk) {
+            encoder.push(pcm.data() + offset, std::min(chunk, pcm.size() - offset));
+            if (offset % 2000 < chunk) {
+                encoder.pull(pulled, Framing::U16);
+            }
+        }
+        encoder.pull(pulled, Framing::U16);
+        CHECK_EQ(pulled.packetsEncoded, 25);
+        CHECK(pulled.lengths == expected.lengths);
+        CHECK(pulled.data == expected.data);
+    }
+}
+
+TEST(streamEncoderFlushPadsPartialFrame) {
+    std::vector<opus_int16> pcm = test::speechLike(kRate, 1, kFrames + 100);
+    StreamEncoder encoder(config());
+    encoder.push(pcm.data(), pcm.size());
+    CHECK_EQ(encoder.stats().framesBuffered, size_t(100));
+    encoder.flush();
+    CHECK_EQ(encoder.stats().framesBuffered, size_t(0));
+    encoder.flush(); // Nothing left to pad
+
+    EncodeResult pulled;
+    encoder.pull(pulled, Framing::U16);
+    pcm.resize(2 * kFrames, 0);
+    EncodeResult expected = reference(pcm);
+    CHECK_EQ(pulled.packetsEncoded, 2);
+    CHECK_EQ(pulled.samplesEncoded, 2 * kFrames);
+    CHECK(pulled.data == expected.data);
+}
+
+TEST(streamEncoderDropsOldestOnOverflow) {
+    // 100 ms of queue holds five packets. Long enough a stall for the queue
+    // bytes to be compacted many times over.
+    StreamEncoderConfig streamConfig = config();
+    streamConfig.maxQueueMs = 100;
+    StreamEncoder encoder(streamConfig);
+    std::vector<opus_int16> pcm = test::speechLike(kRate, 1, 400 * kFrames);
+    for (size_t offset = 0; offset < pcm.size(); offset += kFrames) {
+        encoder.push(pcm.data() + offset, kFrames);
+    }
+    StreamEncoderStats stats = encoder.stats();
+    CHECK_EQ(stats.packetsEncoded, uint64_t(400));
+    CHECK_EQ(stats.packetsDropped, uint64_t(395));
+    CHECK_EQ(stats.packetsQueued, size_t(5));
+
+    // What is left is the newest five packets, intact
+    EncodeResult pulled;
+    encoder.pull(pulled, Framing::Lengths);
+    EncodeResult expected = reference(pcm);
+    CHECK(pulled.lengths == std::vector<uint32_t>(expected.lengths.end() - 5, expected.lengths.end()));
+    PacketList all = test::packetsOf(expected, Framing::U16);
+    std::vector<uint8_t> newest;
+    for (size_t i = 395; i < 400; i++) {
+        newest.insert(newest.end(), all.packets[i].data, all.packets[i].data + all.packets[i].size);
+    }
+    CHECK(pulled.data == newest);
+    CHECK_EQ(encoder.stats().packetsQueued, size_t(0));
+}
+
+TEST(streamEncoderAdaptsToNetwork) {
+    StreamEncoderConfig streamConfig = config();
+    streamConfig.minBitrate = 8000;
+    streamConfig.maxBitrate = 24000;
+    StreamEncoder encoder(streamConfig);
+    CHECK_EQ(encoder.stats().bitrate, 24000);
+
+    // Heavy loss backs off to the floor and turns FEC on
+    for (int i = 0; i < 20; i++) {
+        encoder.updateNetwork(20, 100);
+    }
+    StreamEncoderStats stats = encoder.stats();
+    CHECK_EQ(stats.bitrate, 8000);
+    CHECK(stats.fec);
+    CHECK_EQ(stats.packetLossPercent, 20);
+
+    // FEC follows the threshold
+    encoder.updateNetwork(1, 100);
+    CHECK(encoder.stats().fec);
+    encoder.updateNetwork(0.5, 100);
+    CHECK(!encoder.stats().fec);
+
+    // A clean network probes back up to the ceiling and no further
+    for (int i = 0; i < 50; i++) {
+        encoder.updateNetwork(0, 50);
+    }
+    stats = encoder.stats();
+    CHECK_EQ(stats.bitrate, 24000);
+    CHECK(!stats.fec);
+    CHECK_EQ(stats.packetLossPercent, 0);
+
+    // High round-trip time alone backs off too
+    encoder.updateNetwork(0, 1000);
+    CHECK(encoder.stats().bitrate < 24000);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+// Minimal test registry for the host-side core tests: no third-party
+// framework, so the tests build wherever the benchmarks do.
+
+#include <cstdio>
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rnopus::test {
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<TestCase>& registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+inline bool registerTest(const char* name, void (*run)()) {
+    registry().push_back({name, run});
+    return true;
+}
+
+struct Failure : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+[[noreturn]] inline void fail(const char* file, int line, const std::string& message) {
+    throw Failure(std::string(file) + ":" + std::to_string(line) + ": " + message);
+}
+
+template <typename A, typename B>
+void checkEqual(const A& actual, const B& expected, const char* actualText, const char* expectedText,
+                const char* file, int line) {
+    if (!(actual == expected)) {
+        std::ostringstream message;
+        message << actualText << " == " << expectedText << " (got " << actual << ", expected " << expected << ")";
+        fail(file, line, message.str());
+    }
+}
+
+} // namespace rnopus::test
+
+#define TEST(name)                                                                        \
+    static void name();                                                                   \
+    static const bool name##Registered = ::rnopus::test::registerTest(#name, name);       \
+    static void name()
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) ::rnopus::test::fail(__FILE__, __LINE__, #condition);           \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                        \
+    ::rnopus::test::checkEqual((actual), (expected), #actual, #expected, __FILE__, __LINE__)
+
+#define CHECK_THROWS(expression)                                                          \
+    do {                                                                                  \
+        bool thrown = false;                                                              \
+        try {                                                                             \
+            (void)(expression);                                                           \
+        } catch (const ::rnopus::test::Failure&) {                                        \
+            throw;                                                                        \
+        } catch (const std::exception&) {                                                 \
+            thrown = true;                                                                \
+        }                                                                                 \
+        if (!thrown) ::rnopus::test::fail(__FILE__, __LINE__, #expression " did not throw"); \
+    } while (0)
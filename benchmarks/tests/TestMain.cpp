@@ -0,0 +1,28 @@
+// Runs every registered test, or those whose name contains argv[1].
+//
+// Usage: core-tests [filter]
+
+#include "TestHarness.h"
+
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int passed = 0;
+    int failed = 0;
+    for (const rnopus::test::TestCase& test : rnopus::test::registry()) {
+        if (filter && !std::strstr(test.name, filter)) {
+            continue;
+        }
+        try {
+            test.run();
+            passed++;
+        } catch (const std::exception& e) {
+            std::printf("FAIL %s\n  %s\n", test.name, e.what());
+            failed++;
+        }
+    }
+    std::printf("%d passed, %d failed\n", passed, failed);
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+// Deterministic inputs for the core tests
+
+#include "EncoderSession.h"
+#include "PacketFraming.h"
+
+#include <cmath>
+#include <vector>
+
+namespace rnopus::test {
+
+// `frames` samples per channel of a harmonic tone under a syllable-rate
+// envelope, loud enough for SILK to code it as voiced speech
+inline std::vector<opus_int16> speechLike(opus_int32 sampleRate, int channels, size_t frames) {
+    std::vector<opus_int16> pcm(frames * channels);
+    double phase = 0;
+    for (size_t i = 0; i < frames; i++) {
+        double t = double(i) / sampleRate;
+        double pitch = 150 + 30 * std::sin(2 * M_PI * 0.5 * t);
+        phase += 2 * M_PI * pitch / sampleRate;
+        double envelope = 0.6 + 0.4 * std::sin(2 * M_PI * 4 * t);
+        double sample = 0;
+        for (int harmonic = 1; harmonic <= 8 && pitch * harmonic < sampleRate / 2; harmonic++) {
+            sample += std::sin(harmonic * phase) / harmonic;
+        }
+        for (int channel = 0; channel < channels; channel++) {
+            pcm[i * channels + channel] = static_cast<opus_int16>(6000 * envelope * sample);
+        }
+    }
+    return pcm;
+}
+
+// Encodes `packets` 20 ms packets of speechLike PCM
+inline EncodeResult encodeSpeech(opus_int32 sampleRate, int channels, int packets, Framing framing,
+                                 bool fec = false) {
+    EncoderConfig config;
+    config.sampleRate = sampleRate;
+    config.channels = channels;
+    config.application = OPUS_APPLICATION_VOIP;
+    config.bitrate = 24000;
+    config.fec = fec;
+    config.packetLossPercent = fec ? 20 : 0;
+    EncoderSession encoder(config);
+    std::vector<opus_int16> pcm = speechLike(sampleRate, channels, size_t(packets) * encoder.frameSize());
+    return encoder.encode(pcm.data(), pcm.size() / channels, framing);
+}
+
+// Views into an encode result's framed buffer
+inline PacketList packetsOf(const EncodeResult& encoded, Framing framing) {
+    FramingOptions options;
+    options.framing = framing;
+    return splitPackets(encoded.data.data(), encoded.data.size(), options);
+}
+
+} // namespace rnopus::test
@@ -0,0 +1,88 @@
+#include "TestHarness.h"
+#include "WavWriter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace rnopus;
+
+namespace {
+
+std::string tempPath(const char* name) {
+    return "/tmp/rnopus-test-" + std::to_string(getpid()) + "-" + name + ".wav";
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+uint32_t readLE32(const uint8_t* p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+} // namespace
+
+TEST(wavWriterStreamsAcrossBuffers) {
+    std::string path = tempPath("stream");
+    std::vector<uint8_t> pcm(50000);
+    for (size_t i = 0; i < pcm.size(); i++) {
+        pcm[i] = static_cast<uint8_t>(i * 31);
+    }
+    {
+        WavWriter writer(path, 16000, 1, 16, 4096);
+        // Small appends, then one spanning several buffers
+        size_t offset = 0;
+        for (size_t chunk : {10, 3000, 2000}) {
+            writer.append(pcm.data() + offset, chunk);
+            offset += chunk;
+        }
+        writer.append(pcm.data() + offset, pcm.size() - offset);
+        CHECK_EQ(writer.dataBytes(), uint64_t(pcm.size()));
+        writer.finalize();
+    }
+    std::vector<uint8_t> file = readFile(path);
+    std::remove(path.c_str());
+    CHECK_EQ(file.size(), kWavHeaderSize + pcm.size());
+    CHECK_EQ(readLE32(file.data() + 4), uint32_t(36 + pcm.size()));
+    CHECK_EQ(readLE32(file.data() + 40), uint32_t(pcm.size()));
+    CHECK(std::equal(pcm.begin(), pcm.end(), file.begin() + kWavHeaderSize));
+}
+
+TEST(wavWriterPadsOddDataChunk) {
+    std::string path = tempPath("odd");
+    const uint8_t samples[] = {0x80, 0x90, 0xA0};
+    {
+        WavWriter writer(path, 8000, 1, 8);
+        writer.append(samples, sizeof(samples));
+        writer.finalize();
+    }
+    std::vector<uint8_t> file = readFile(path);
+    std::remove(path.c_str());
+    CHECK_EQ(file.size(), kWavHeaderSize + 4);
+    CHECK_EQ(readLE32(file.data() + 4), uint32_t(36 + 4));
+    CHECK_EQ(readLE32(file.data() + 40), uint32_t(3));
+    CHECK_EQ(int(file.back()), 0);
+}
+
+TEST(wavWriterCountsOnlyWrittenBytes) {
+    // Every write to /dev/full fails with ENOSPC
+    if (access("/dev/full", W_OK) != 0) {
+        return;
+    }
+    WavWriter writer("/dev/full", 16000, 1, 16, 4096);
+    std::vector<uint8_t> small(100), large(10000);
+    writer.append(small.data(), small.size());
+    CHECK_EQ(writer.dataBytes(), uint64_t(100));
+    CHECK_THROWS(writer.append(large.data(), large.size()));
+    CHECK_EQ(writer.dataBytes(), uint64_t(100));
+    CHECK_THROWS(writer.finalize());
+    CHECK_EQ(writer.dataBytes(), uint64_t(0));
+    CHECK(writer.finalized());
+}
@@ -0,0 +1,459 @@
+#include "Base64.h"
+
+#include <array>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RNOPUS_BASE64_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define RNOPUS_BASE64_NEON 1
+#include <arm_neon.h>
+#if defined(__arm__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+namespace rnopus::base64 {
+
+namespace {
+
+constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+constexpr uint8_t kInvalid = 0xFF;
+
+constexpr std::array<uint8_t, 256> makeDecodingTable() {
+    std::array<uint8_t, 256> table{};
+    for (auto& entry : table) {
+        entry = kInvalid;
+    }
+    for (uint8_t i = 0; i < 64; i++) {
+        table[static_cast<uint8_t>(kAlphabet[i])] = i;
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> kDecodingTable = makeDecodingTable();
+
+// Kernels return how much input they consumed: a multiple of 3 bytes for
+// encode, a multiple of 4 characters for decode. Decode kernels never touch
+// the final quad, so padding is always handled by the scalar path.
+using EncodeBlocks = size_t (*)(const uint8_t* in, size_t size, char* out);
+using DecodeBlocks = size_t (*)(const char* in, size_t size, uint8_t* out);
+
+void encodeScalar(const uint8_t* in, size_t size, char* out) {
+    size_t i = 0;
+    for (; i + 3 <= size; i += 3) {
+        uint32_t triple = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8) | in[i + 2];
+        *out++ = kAlphabet[(triple >> 18) & 0x3F];
+        *out++ = kAlphabet[(triple >> 12) & 0x3F];
+        *out++ = kAlphabet[(triple >> 6) & 0x3F];
+        *out++ = kAlphabet[triple & 0x3F];
+    }
+
+    size_t remaining = size - i;
+    if (remaining == 0) {
+        return;
+    }
+    uint32_t triple = uint32_t(in[i]) << 16;
+    if (remaining == 2) {
+        triple |= uint32_t(in[i + 1]) << 8;
+    }
+    *out++ = kAlphabet[(triple >> 18) & 0x3F];
+    *out++ = kAlphabet[(triple >> 12) & 0x3F];
+    *out++ = remaining == 2 ? kAlphabet[(triple >> 6) & 0x3F] : '=';
+    *out++ = '=';
+}
+
+// `size` must be a multiple of 4. Padding is only accepted in the last quad.
+bool decodeScalar(const char* in, size_t size, uint8_t* out) {
+    for (size_t i = 0; i < size; i += 4) {
+        const bool last = i + 4 == size;
+        uint32_t a = kDecodingTable[static_cast<uint8_t>(in[i])];
+        uint32_t b = kDecodingTable[static_cast<uint8_t>(in[i + 1])];
+        if ((a | b) > 63) {
+            return false;
+        }
+        uint32_t triple = (a << 18) | (b << 12);
+
+        if (last && in[i + 2] == '=') {
+            if (in[i + 3] != '=') {
+                return false;
+            }
+            *out++ = static_cast<uint8_t>(triple >> 16);
+            return true;
+        }
+        uint32_t c = kDecodingTable[static_cast<uint8_t>(in[i + 2])];
+        if (c > 63) {
+            return false;
+        }
+        triple |= c << 6;
+
+        if (last && in[i + 3] == '=') {
+            *out++ = static_cast<uint8_t>(triple >> 16);
+            *out++ = static_cast<uint8_t>(triple >> 8);
+            return true;
+        }
+        uint32_t d = kDecodingTable[static_cast<uint8_t>(in[i + 3])];
+        if (d > 63) {
+            return false;
+        }
+        triple |= d;
+
+        *out++ = static_cast<uint8_t>(triple >> 16);
+        *out++ = static_cast<uint8_t>(triple >> 8);
+        *out++ = static_cast<uint8_t>(triple);
+    }
+    return true;
+}
+
+size_t encodeBlocksScalar(const uint8_t*, size_t, char*) {
+    return 0;
+}
+
+size_t decodeBlocksScalar(const char*, size_t, uint8_t*) {
+    return 0;
+}
+
+#if RNOPUS_BASE64_X86
+
+// Maps 6-bit indices to their alphabet characters by adding a per-range offset.
+__attribute__((target("ssse3")))
+inline __m128i toAsciiSsse3(__m128i indices) {
+    __m128i offset = _mm_set1_epi8(65);
+    offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpgt_epi8(indices, _mm_set1_epi8(25)), _mm_set1_epi8(6)));
+    offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpgt_epi8(indices, _mm_set1_epi8(51)), _mm_set1_epi8(-75)));
+    offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpgt_epi8(indices, _mm_set1_epi8(61)), _mm_set1_epi8(-15)));
+    offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpgt_epi8(indices, _mm_set1_epi8(62)), _mm_set1_epi8(3)));
+    return _mm_add_epi8(indices, offset);
+}
+
+__attribute__((target("ssse3")))
+inline __m128i inRangeSsse3(__m128i chars, char low, char span) {
+    __m128i shifted = _mm_sub_epi8(chars, _mm_set1_epi8(low));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(span)), shifted);
+}
+
+// Maps characters back to 6-bit values; `valid` is all ones where the
+// character belongs to the alphabet.
+__attribute__((target("ssse3")))
+inline __m128i toSextetsSsse3(__m128i chars, __m128i& valid) {
+    __m128i upper = inRangeSsse3(chars, 'A', 25);
+    __m128i lower = inRangeSsse3(chars, 'a', 25);
+    __m128i digit = inRangeSsse3(chars, '0', 9);
+    __m128i plus = _mm_cmpeq_epi8(chars, _mm_set1_epi8('+'));
+    __m128i slash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+    valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+
+    __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-65));
+    shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(-71)));
+    shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(4)));
+    shift = _mm_or_si128(shift, _mm_and_si128(plus, _mm_set1_epi8(19)));
+    shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(16)));
+    return _mm_add_epi8(chars, shift);
+}
+
+// 12 input bytes per iteration; the 16-byte load reads 4 bytes ahead.
+__attribute__((target("ssse3")))
+size_t encodeBlocksSsse3(const uint8_t* in, size_t size, char* out) {
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    size_t i = 0;
+    for (; size - i >= 16; i += 12, out += 16) {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), shuffle);
+        __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        __m128i t1 = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), toAsciiSsse3(_mm_or_si128(t0, t1)));
+    }
+    return i;
+}
+
+// 16 characters per iteration; the 16-byte store writes 4 bytes of slack,
+// which the remaining (at least two) quads overwrite.
+__attribute__((target("ssse3")))
+size_t decodeBlocksSsse3(const char* in, size_t size, uint8_t* out) {
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t i = 0;
+    for (; size - i >= 24; i += 16, out += 12) {
+        __m128i valid;
+        __m128i sextets = toSextetsSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), valid);
+        if (_mm_movemask_epi8(valid) != 0xFFFF) {
+            break;
+        }
+        __m128i merged = _mm_maddubs_epi16(sextets, _mm_set1_epi32(0x01400140));
+        merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(merged, pack));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline __m256i toAsciiAvx2(__m256i indices) {
+    __m256i offset = _mm256_set1_epi8(65);
+    offset = _mm256_add_epi8(offset, _mm256_and_si256(_mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25)), _mm256_set1_epi8(6)));
+    offset = _mm256_add_epi8(offset, _mm256_and_si256(_mm256_cmpgt_epi8(indices, _mm256_set1_epi8(51)), _mm256_set1_epi8(-75)));
+    offset = _mm256_add_epi8(offset, _mm256_and_si256(_mm256_cmpgt_epi8(indices, _mm256_set1_epi8(61)), _mm256_set1_epi8(-15)));
+    offset = _mm256_add_epi8(offset, _mm256_and_si256(_mm256_cmpgt_epi8(indices, _mm256_set1_epi8(62)), _mm256_set1_epi8(3)));
+    return _mm256_add_epi8(indices, offset);
+}
+
+__attribute__((target("avx2")))
+inline __m256i inRangeAvx2(__m256i chars, char low, char span) {
+    __m256i shifted = _mm256_sub_epi8(chars, _mm256_set1_epi8(low));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(span)), shifted);
+}
+
+__attribute__((target("avx2")))
+inline __m256i toSextetsAvx2(__m256i chars, __m256i& valid) {
+    __m256i upper = inRangeAvx2(chars, 'A', 25);
+    __m256i lower = inRangeAvx2(chars, 'a', 25);
+    __m256i digit = inRangeAvx2(chars, '0', 9);
+    __m256i plus = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('+'));
+    __m256i slash = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('/'));
+    valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, _mm256_or_si256(plus, slash)));
+
+    __m256i shift = _mm256_and_si256(upper, _mm256_set1_epi8(-65));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(-71)));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(digit, _mm256_set1_epi8(4)));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(plus, _mm256_set1_epi8(19)));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(slash, _mm256_set1_epi8(16)));
+    return _mm256_add_epi8(chars, shift);
+}
+
+// 24 input bytes per iteration, as two 12-byte lanes loaded 12 bytes apart.
+__attribute__((target("avx2")))
+size_t encodeBlocksAvx2(const uint8_t* in, size_t size, char* out) {
+    const __m256i shuffle = _mm256_set_epi8(
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    size_t i = 0;
+    for (; size - i >= 28; i += 24, out += 32) {
+        __m256i v = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12)), 1);
+        v = _mm256_shuffle_epi8(v, shuffle);
+        __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), toAsciiAvx2(_mm256_or_si256(t0, t1)));
+    }
+    return i;
+}
+
+// 32 characters per iteration; the 32-byte store writes 8 bytes of slack,
+// which the remaining (at least four) quads overwrite.
+__attribute__((target("avx2")))
+size_t decodeBlocksAvx2(const char* in, size_t size, uint8_t* out) {
+    const __m256i pack = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+    size_t i = 0;
+    for (; size - i >= 48; i += 32, out += 24) {
+        __m256i valid;
+        __m256i sextets = toSextetsAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), valid);
+        if (_mm256_movemask_epi8(valid) != -1) {
+            break;
+        }
+        __m256i merged = _mm256_maddubs_epi16(sextets, _mm256_set1_epi32(0x01400140));
+        merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        merged = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(merged, pack), compact);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), merged);
+    }
+    return i;
+}
+
+#endif // RNOPUS_BASE64_X86
+
+#if RNOPUS_BASE64_NEON
+
+inline uint8x16_t toAsciiNeon(uint8x16_t indices) {
+    uint8x16_t offset = vdupq_n_u8(65);
+    offset = vaddq_u8(offset, vandq_u8(vcgtq_u8(indices, vdupq_n_u8(25)), vdupq_n_u8(6)));
+    offset = vaddq_u8(offset, vandq_u8(vcgtq_u8(indices, vdupq_n_u8(51)), vdupq_n_u8(static_cast<uint8_t>(-75))));
+    offset = vaddq_u8(offset, vandq_u8(vcgtq_u8(indices, vdupq_n_u8(61)), vdupq_n_u8(static_cast<uint8_t>(-15))));
+    offset = vaddq_u8(offset, vandq_u8(vcgtq_u8(indices, vdupq_n_u8(62)), vdupq_n_u8(3)));
+    return vaddq_u8(indices, offset);
+}
+
+inline uint8x16_t inRangeNeon(uint8x16_t chars, uint8_t low, uint8_t span) {
+    return vcleq_u8(vsubq_u8(chars, vdupq_n_u8(low)), vdupq_n_u8(span));
+}
+
+inline uint8x16_t toSextetsNeon(uint8x16_t chars, uint8x16_t& valid) {
+    uint8x16_t upper = inRangeNeon(chars, 'A', 25);
+    uint8x16_t lower = inRangeNeon(chars, 'a', 25);
+    uint8x16_t digit = inRangeNeon(chars, '0', 9);
+    uint8x16_t plus = vceqq_u8(chars, vdupq_n_u8('+'));
+    uint8x16_t slash = vceqq_u8(chars, vdupq_n_u8('/'));
+    valid = vandq_u8(valid, vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(digit, vorrq_u8(plus, slash))));
+
+    uint8x16_t shift = vandq_u8(upper, vdupq_n_u8(static_cast<uint8_t>(-65)));
+    shift = vorrq_u8(shift, vandq_u8(lower, vdupq_n_u8(static_cast<uint8_t>(-71))));
+    shift = vorrq_u8(shift, vandq_u8(digit, vdupq_n_u8(4)));
+    shift = vorrq_u8(shift, vandq_u8(plus, vdupq_n_u8(19)));
+    shift = vorrq_u8(shift, vandq_u8(slash, vdupq_n_u8(16)));
+    return vaddq_u8(chars, shift);
+}
+
+inline bool allSetNeon(uint8x16_t mask) {
+#if defined(__aarch64__)
+    return vminvq_u8(mask) == 0xFF;
+#else
+    uint8x8_t folded = vand_u8(vget_low_u8(mask), vget_high_u8(mask));
+    return vget_lane_u64(vreinterpret_u64_u8(folded), 0) == ~uint64_t(0);
+#endif
+}
+
+// 48 input bytes per iteration, de-interleaved into byte triplets.
+size_t encodeBlocksNeon(const uint8_t* in, size_t size, char* out) {
+    size_t i = 0;
+    for (; size - i >= 48; i += 48, out += 64) {
+        uint8x16x3_t bytes = vld3q_u8(in + i);
+        uint8x16x4_t chars;
+        chars.val[0] = toAsciiNeon(vshrq_n_u8(bytes.val[0], 2));
+        chars.val[1] = toAsciiNeon(vorrq_u8(
+            vshlq_n_u8(vandq_u8(bytes.val[0], vdupq_n_u8(0x03)), 4), vshrq_n_u8(bytes.val[1], 4)));
+        chars.val[2] = toAsciiNeon(vorrq_u8(
+            vshlq_n_u8(vandq_u8(bytes.val[1], vdupq_n_u8(0x0F)), 2), vshrq_n_u8(bytes.val[2], 6)));
+        chars.val[3] = toAsciiNeon(vandq_u8(bytes.val[2], vdupq_n_u8(0x3F)));
+        vst4q_u8(reinterpret_cast<uint8_t*>(out), chars);
+    }
+    return i;
+}
+
+// 64 characters per iteration, never including the final quad.
+size_t decodeBlocksNeon(const char* in, size_t size, uint8_t* out) {
+    size_t i = 0;
+    for (; size - i >= 68; i += 64, out += 48) {
+        uint8x16x4_t chars = vld4q_u8(reinterpret_cast<const uint8_t*>(in + i));
+        uint8x16_t valid = vdupq_n_u8(0xFF);
+        uint8x16_t a = toSextetsNeon(chars.val[0], valid);
+        uint8x16_t b = toSextetsNeon(chars.val[1], valid);
+        uint8x16_t c = toSextetsNeon(chars.val[2], valid);
+        uint8x16_t d = toSextetsNeon(chars.val[3], valid);
+        if (!allSetNeon(valid)) {
+            break;
+        }
+        uint8x16x3_t bytes;
+        bytes.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+        bytes.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+        bytes.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+        vst3q_u8(out, bytes);
+    }
+    return i;
+}
+
+#endif // RNOPUS_BASE64_NEON
+
+struct Kernels {
+    EncodeBlocks encodeBlocks;
+    DecodeBlocks decodeBlocks;
+};
+
+Kernels kernelsFor(Kernel kernel) {
+    switch (kernel) {
+#if RNOPUS_BASE64_X86
+        case Kernel::Ssse3:
+            return {encodeBlocksSsse3, decodeBlocksSsse3};
+        case Kernel::Avx2:
+            return {encodeBlocksAvx2, decodeBlocksAvx2};
+#endif
+#if RNOPUS_BASE64_NEON
+        case Kernel::Neon:
+            return {encodeBlocksNeon, decodeBlocksNeon};
+#endif
+        default:
+            return {encodeBlocksScalar, decodeBlocksScalar};
+    }
+}
+
+} // namespace
+
+bool isSupported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return true;
+#if RNOPUS_BASE64_X86
+        case Kernel::Ssse3:
+            return __builtin_cpu_supports("ssse3");
+        case Kernel::Avx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#if RNOPUS_BASE64_NEON
+        case Kernel::Neon:
+#if defined(__arm__) && defined(__linux__)
+            return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#else
+            return true;
+#endif
+#endif
+        default:
+            return false;
+    }
+}
+
+Kernel bestKernel() {
+    static const Kernel best = [] {
+        for (Kernel kernel : {Kernel::Avx2, Kernel::Ssse3, Kernel::Neon}) {
+            if (isSupported(kernel)) {
+                return kernel;
+            }
+        }
+        return Kernel::Scalar;
+    }();
+    return best;
+}
+
+const char* kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return "scalar";
+        case Kernel::Neon:
+            return "neon";
+        case Kernel::Ssse3:
+            return "ssse3";
+        case Kernel::Avx2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+std::string encode(const uint8_t* data, size_t size) {
+    return encode(data, size, bestKernel());
+}
+
+std::string encode(const uint8_t* data, size_t size, Kernel kernel) {
+    std::string encoded(4 * ((size + 2) / 3), '\0');
+    if (size == 0) {
+        return encoded;
+    }
+    size_t consumed = isSupported(kernel) ? kernelsFor(kernel).encodeBlocks(data, size, &encoded[0]) : 0;
+    encodeScalar(data + consumed, size - consumed, &encoded[consumed / 3 * 4]);
+    return encoded;
+}
+
+bool decode(const char* data, size_t size, std::vector<uint8_t>& out) {
+    return decode(data, size, out, bestKernel());
+}
+
+bool decode(const char* data, size_t size, std::vector<uint8_t>& out, Kernel kernel) {
+    out.clear();
+    if (size == 0) {
+        return true;
+    }
+    if (size % 4 != 0) {
+        return false;
+    }
+
+    size_t padding = data[size - 1] == '=' ? (data[size - 2] == '=' ? 2 : 1) : 0;
+    out.resize(size / 4 * 3 - padding);
+
+    size_t consumed = isSupported(kernel) ? kernelsFor(kernel).decodeBlocks(data, size, out.data()) : 0;
+    if (!decodeScalar(data + consumed, size - consumed, out.data() + consumed / 4 * 3)) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+} // namespace rnopus::base64
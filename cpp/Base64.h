@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rnopus::base64 {
+
+// Vectorized kernels. Each one handles the bulk of the input and leaves the
+// tail (and anything it cannot validate) to the scalar code.
+enum class Kernel {
+    Scalar,
+    Neon,
+    Ssse3,
+    Avx2,
+};
+
+// Whether the kernel was compiled in and the running CPU supports it.
+bool isSupported(Kernel kernel);
+
+// Fastest supported kernel, detected once on first use.
+Kernel bestKernel();
+
+const char* kernelName(Kernel kernel);
+
+std::string encode(const uint8_t* data, size_t size);
+std::string encode(const uint8_t* data, size_t size, Kernel kernel);
+
+// Strict RFC 4648 decoding: rejects bad lengths, characters outside the
+// alphabet and misplaced padding. Returns false and clears `out` on error.
+bool decode(const char* data, size_t size, std::vector<uint8_t>& out);
+bool decode(const char* data, size_t size, std::vector<uint8_t>& out, Kernel kernel);
+
+} // namespace rnopus::base64
@@ -0,0 +1,71 @@
+#include "BatchDecoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace rnopus {
+
+namespace {
+
+struct BatchState {
+    std::vector<BatchStream> streams;
+    std::vector<BatchStreamResult> results;
+    std::function<void(std::vector<BatchStreamResult>)> done;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> remaining{0};
+};
+
+BatchStreamResult decodeStream(const BatchStream& stream) {
+    BatchStreamResult result;
+    try {
+        DecoderSession session(stream.sampleRate, stream.channels);
+        session.setOutputRate(stream.outputRate, stream.quality);
+        DecodeOptions options = stream.options;
+        options.wholeStream = true;
+        result.decoded = session.decode(stream.packets.data(), stream.packets.size(), stream.framing, options);
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    return result;
+}
+
+// Decodes streams until none are left. Every stream's result is written by
+// exactly one worker, and the last one to finish hands them all over.
+void drain(const std::shared_ptr<BatchState>& state) {
+    const size_t count = state->streams.size();
+    for (size_t index = state->next.fetch_add(1); index < count; index = state->next.fetch_add(1)) {
+        state->results[index] = decodeStream(state->streams[index]);
+        // Release the packets as soon as they are decoded
+        std::vector<uint8_t>().swap(state->streams[index].packets);
+        if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            state->done(std::move(state->results));
+            return;
+        }
+    }
+}
+
+} // namespace
+
+void decodeBatch(ThreadPool& pool, std::vector<BatchStream> streams,
+                 std::function<void(std::vector<BatchStreamResult>)> done) {
+    if (streams.empty()) {
+        done({});
+        return;
+    }
+    auto state = std::make_shared<BatchState>();
+    state->results.resize(streams.size());
+    state->remaining = streams.size();
+    state->streams = std::move(streams);
+    state->done = std::move(done);
+
+    // Leave one worker to the session queues sharing the pool, so live
+    // decoders and jitter buffers keep running under a large batch
+    const size_t workers = std::min(std::max<size_t>(pool.size(), 2) - 1, state->streams.size());
+    for (size_t i = 0; i < workers; i++) {
+        pool.submit([state] { drain(state); });
+    }
+}
+
+} // namespace rnopus
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "DecoderSession.h"
+#include "PacketFraming.h"
+#include "Resampler.h"
+#include "ThreadPool.h"
+
+namespace rnopus {
+
+// One independent stream of a batch, with its own copy of the packets
+struct BatchStream {
+    std::vector<uint8_t> packets;
+    FramingOptions framing;
+    DecodeOptions options;
+    opus_int32 sampleRate = 48000;
+    int channels = 1;
+    int outputRate = 0; // Resample to this rate; 0 keeps sampleRate
+    ResamplerQuality quality = ResamplerQuality::Medium;
+};
+
+struct BatchStreamResult {
+    DecodeResult decoded;
+    std::string error; // Set instead of `decoded` when the stream failed
+};
+
+// Decodes every stream with its own DecoderSession, in parallel across
+// `pool`. At most pool.size() - 1 tasks (at least one) are queued, leaving a
+// worker for other work on the pool; each pulls the next undecoded stream,
+// so long and short streams balance across the workers. Each stream is
+// decoded as a whole (DecodeOptions::wholeStream), so resampled output
+// covers exactly its duration.
+// A failing stream only fails its own result. `done` runs once, on the
+// worker that finishes last, with the results in input order.
+void decodeBatch(ThreadPool& pool, std::vector<BatchStream> streams,
+                 std::function<void(std::vector<BatchStreamResult>)> done);
+
+} // namespace rnopus
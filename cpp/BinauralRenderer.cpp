@@ -0,0 +1,209 @@
+#include "BinauralRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define RNOPUS_BINAURAL_SSE 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define RNOPUS_BINAURAL_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace rnopus {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kHeadRadius = 0.0875;  // Metres
+constexpr double kSpeedOfSound = 343.0; // Metres per second
+constexpr int kShadowTaps = 32;         // Truncation of the head shadow filter
+
+// out[i] += gain * in[i]. Every tap of every filter goes through here, so it
+// carries the renderer's cost. SSE2 and NEON are baseline on the 64-bit
+// targets we ship, so there is no runtime dispatch.
+void multiplyAdd(float* out, const float* in, float gain, size_t count) {
+    size_t i = 0;
+#if RNOPUS_BINAURAL_SSE
+    __m128 g = _mm_set1_ps(gain);
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(g, _mm_loadu_ps(in + i)));
+        __m128 b = _mm_add_ps(_mm_loadu_ps(out + i + 4), _mm_mul_ps(g, _mm_loadu_ps(in + i + 4)));
+        _mm_storeu_ps(out + i, a);
+        _mm_storeu_ps(out + i + 4, b);
+    }
+#elif RNOPUS_BINAURAL_NEON
+    float32x4_t g = vdupq_n_f32(gain);
+    for (; i + 8 <= count; i += 8) {
+        vst1q_f32(out + i, vmlaq_f32(vld1q_f32(out + i), vld1q_f32(in + i), g));
+        vst1q_f32(out + i + 4, vmlaq_f32(vld1q_f32(out + i + 4), vld1q_f32(in + i + 4), g));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] += gain * in[i];
+    }
+}
+
+// (n + 1)^2 for a full-sphere ambisonic layout of `channels`, with or
+// without the two non-diegetic channels; 0 if `channels` is neither
+int ambisonicChannelCount(int channels) {
+    for (int order = 0; order <= 14; order++) {
+        int full = (order + 1) * (order + 1);
+        if (channels == full || channels == full + 2) {
+            return full;
+        }
+    }
+    return 0;
+}
+
+// Impulse response of the Brown-Duda head shadow filter for a source at
+// `angle` radians from the ear axis, bilinear-transformed at `sampleRate`
+void headShadow(double angle, int sampleRate, double* response) {
+    const double alphaMin = 0.1;
+    const double angleMin = 150.0 * kPi / 180.0;
+    double alpha = (1 + alphaMin / 2) + (1 - alphaMin / 2) * std::cos(angle / angleMin * kPi);
+    double omega0 = kSpeedOfSound / kHeadRadius;
+    double a = alpha * sampleRate / omega0;
+    double b = sampleRate / omega0;
+    double b0 = (1 + a) / (1 + b);
+    double b1 = (1 - a) / (1 + b);
+    double a1 = (1 - b) / (1 + b);
+
+    double previousIn = 0;
+    double previousOut = 0;
+    for (int n = 0; n < kShadowTaps; n++) {
+        double in = n == 0 ? 1.0 : 0.0;
+        double out = b0 * in + b1 * previousIn - a1 * previousOut;
+        response[n] = out;
+        previousIn = in;
+        previousOut = out;
+    }
+}
+
+} // namespace
+
+BinauralFilters defaultBinauralFilters(int ambisonicChannels, int sampleRate) {
+    if (ambisonicChannelCount(ambisonicChannels) < 4) {
+        throw std::invalid_argument("Binaural rendering needs at least first-order ambisonics");
+    }
+
+    // Woodworth interaural delay, longest for a source behind the far ear
+    const double maxDelay = kHeadRadius / kSpeedOfSound * (1 + kPi / 2) * sampleRate;
+
+    BinauralFilters filters;
+    filters.channels = 4;
+    filters.length = static_cast<int>(std::ceil(maxDelay)) + 1 + kShadowTaps;
+    filters.taps.assign(size_t(filters.channels) * 2 * filters.length, 0.0f);
+
+    // Cube of virtual loudspeakers; first-order sampling decoder with max-rE
+    // weighting (SN3D input, so order 1 is scaled by 3)
+    const double elevation = std::atan(1 / std::sqrt(2.0));
+    const double orderOneGain = 3 * 0.5774;
+    double shadow[kShadowTaps];
+    for (int speaker = 0; speaker < 8; speaker++) {
+        double azimuth = (45 + 90 * (speaker % 4)) * kPi / 180;
+        double theta = speaker < 4 ? elevation : -elevation;
+        double x = std::cos(azimuth) * std::cos(theta);
+        double y = std::sin(azimuth) * std::cos(theta);
+        double z = std::sin(theta);
+        // ACN order: W, Y, Z, X
+        const double decode[4] = {1.0 / 8, orderOneGain * y / 8, orderOneGain * z / 8, orderOneGain * x / 8};
+
+        for (int ear = 0; ear < 2; ear++) {
+            // Left ear on +y
+            double cosine = ear == 0 ? y : -y;
+            double angle = std::acos(std::max(-1.0, std::min(1.0, cosine)));
+            double delay = kHeadRadius / kSpeedOfSound * sampleRate *
+                           (angle <= kPi / 2 ? 1 - cosine : 1 + angle - kPi / 2);
+            headShadow(angle, sampleRate, shadow);
+
+            // Fractional delay by linear interpolation between two taps
+            int whole = static_cast<int>(delay);
+            double fraction = delay - whole;
+            for (int channel = 0; channel < 4; channel++) {
+                float* taps = filters.taps.data() + (size_t(channel) * 2 + ear) * filters.length;
+                for (int n = 0; n < kShadowTaps; n++) {
+                    double value = decode[channel] * shadow[n];
+                    taps[whole + n] += static_cast<float>(value * (1 - fraction));
+                    taps[whole + n + 1] += static_cast<float>(value * fraction);
+                }
+            }
+        }
+    }
+    return filters;
+}
+
+BinauralRenderer::BinauralRenderer(BinauralFilters filters) : filters_(std::move(filters)) {
+    if (filters_.channels <= 0 || filters_.length <= 0 ||
+        filters_.taps.size() != size_t(filters_.channels) * 2 * filters_.length) {
+        throw std::invalid_argument("Binaural filters must hold channels x 2 x length taps");
+    }
+}
+
+void BinauralRenderer::process(const float* in, int inputChannels, size_t frames, float* out) {
+    const size_t history = filters_.length - 1;
+    const int filtered = std::min(filters_.channels, inputChannels);
+    const int ambisonic = ambisonicChannelCount(inputChannels);
+    const bool nonDiegetic = ambisonic > 0 && inputChannels == ambisonic + 2;
+
+    if (frames > capacity_) {
+        // Grow the per-channel blocks, keeping each channel's history
+        std::vector<float> grown(size_t(filters_.channels) * (history + frames), 0.0f);
+        for (int channel = 0; channel < filters_.channels && !input_.empty(); channel++) {
+            std::copy_n(input_.data() + channel * (history + capacity_), history,
+                        grown.data() + channel * (history + frames));
+        }
+        input_.swap(grown);
+        capacity_ = frames;
+        ears_.resize(2 * frames);
+    }
+    const size_t stride = history + capacity_;
+
+    for (int channel = 0; channel < filtered; channel++) {
+        float* block = input_.data() + channel * stride + history;
+        for (size_t i = 0; i < frames; i++) {
+            block[i] = in[i * inputChannels + channel];
+        }
+    }
+
+    std::fill(ears_.begin(), ears_.begin() + 2 * frames, 0.0f);
+    for (int channel = 0; channel < filtered; channel++) {
+        const float* signal = input_.data() + channel * stride + history;
+        for (int ear = 0; ear < 2; ear++) {
+            const float* taps = filters_.taps.data() + (size_t(channel) * 2 + ear) * filters_.length;
+            float* earOut = ears_.data() + ear * frames;
+            for (int tap = 0; tap < filters_.length; tap++) {
+                if (taps[tap] != 0.0f) {
+                    multiplyAdd(earOut, signal - tap, taps[tap], frames);
+                }
+            }
+        }
+        // The last `history` frames become the next call's history
+        float* base = input_.data() + channel * stride;
+        std::memmove(base, base + frames, history * sizeof(float));
+    }
+
+    const float* left = ears_.data();
+    const float* right = ears_.data() + frames;
+    for (size_t i = 0; i < frames; i++) {
+        float l = left[i];
+        float r = right[i];
+        if (nonDiegetic) {
+            l += in[i * inputChannels + ambisonic];
+            r += in[i * inputChannels + ambisonic + 1];
+        }
+        out[2 * i] = l;
+        out[2 * i + 1] = r;
+    }
+}
+
+void BinauralRenderer::reset() {
+    std::fill(input_.begin(), input_.end(), 0.0f);
+}
+
+} // namespace rnopus
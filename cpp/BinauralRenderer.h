@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rnopus {
+
+// Per-channel head-related filters in the spherical harmonic domain: each
+// ambisonic channel (ACN order, SN3D) is convolved with one FIR per ear and
+// the results are summed. taps[(channel * 2 + ear) * length + tap], ear 0
+// is left.
+struct BinauralFilters {
+    int channels = 0;
+    int length = 0;
+    std::vector<float> taps;
+};
+
+// Filters built from a spherical head model (interaural delay and head
+// shadow) over a cube of virtual loudspeakers decoded at first order with
+// max-rE weighting. A light default that localizes left/right and
+// front/back cues; supply measured SH-domain HRIRs for better elevation.
+// Higher-order channels get no filter. Throws std::invalid_argument for
+// fewer than 4 channels.
+BinauralFilters defaultBinauralFilters(int ambisonicChannels, int sampleRate);
+
+// Renders ambisonic PCM to binaural stereo with the filters above. Keeps
+// the filter history between calls so blocks join seamlessly. Not thread
+// safe.
+class BinauralRenderer {
+public:
+    // Throws std::invalid_argument if the taps do not match the size.
+    explicit BinauralRenderer(BinauralFilters filters);
+
+    // Renders `frames` frames of interleaved input with `inputChannels`
+    // channels into interleaved stereo `out`. Ambisonic channels without a
+    // filter are dropped; a trailing non-diegetic stereo pair (RFC 8486) is
+    // mixed in as is.
+    void process(const float* in, int inputChannels, size_t frames, float* out);
+
+    // Clears the filter history.
+    void reset();
+
+    int channels() const { return filters_.channels; }
+
+private:
+    BinauralFilters filters_;
+    // Planar input per channel: length - 1 frames of history, then the block
+    std::vector<float> input_;
+    size_t capacity_ = 0; // Frames of block space per channel in input_
+    std::vector<float> ears_; // Left block, then right block
+};
+
+} // namespace rnopus
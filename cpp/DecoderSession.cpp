@@ -0,0 +1,385 @@
+#include "DecoderSession.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+namespace rnopus {
+
+namespace {
+
+// Sequence jumps longer than this are treated as a stream restart rather
+// than loss (about a second of 20 ms packets).
+constexpr uint32_t kMaxConcealedRun = 50;
+
+int decodeFrame(OpusDecoder* decoder, const uint8_t* data, size_t size, opus_int16* pcm, int frames, int fec) {
+    return opus_decode(decoder, data, static_cast<opus_int32>(size), pcm, frames, fec);
+}
+
+int decodeFrame(OpusDecoder* decoder, const uint8_t* data, size_t size, float* pcm, int frames, int fec) {
+    return opus_decode_float(decoder, data, static_cast<opus_int32>(size), pcm, frames, fec);
+}
+
+// One packet position in the output timeline
+struct Slot {
+    const PacketView* packet; // Null when lost
+    int frames;               // Per channel
+    int64_t position;         // Sequence number or input index
+};
+
+// Resamples interleaved PCM in place and returns the frames it now holds.
+// For a whole stream the resampler is flushed, and the output realigned and
+// trimmed to the input's duration.
+template <typename Sample>
+int resamplePcm(Resampler& resampler, std::vector<Sample>& pcm, int channels, bool wholeStream) {
+    size_t frames = pcm.size() / channels;
+    std::vector<Sample> out(resampler.maxOutputFrames(frames) * channels);
+    size_t produced = resampler.process(pcm.data(), frames, out.data());
+    if (wholeStream) {
+        out.resize((produced + resampler.maxFlushFrames()) * channels);
+        produced += resampler.flush(out.data() + produced * channels);
+        size_t skip = std::min(resampler.delay(), produced);
+        size_t duration = static_cast<size_t>(
+            (uint64_t(frames) * 2 * resampler.outputRate() + resampler.inputRate()) / (2 * resampler.inputRate()));
+        out.erase(out.begin(), out.begin() + skip * channels);
+        produced = std::min(produced - skip, duration);
+    }
+    out.resize(produced * channels);
+    pcm.swap(out);
+    return static_cast<int>(produced);
+}
+
+} // namespace
+
+SampleFormat parseSampleFormat(const std::string& name) {
+    if (name == "int16") return SampleFormat::Int16;
+    if (name == "float32") return SampleFormat::Float32;
+    throw std::invalid_argument("Unknown output format: " + name);
+}
+
+DecoderSession::DecoderSession(opus_int32 sampleRate, int channels)
+    : sampleRate_(sampleRate), channels_(channels), lastPacketFrames_(sampleRate / 50) {
+    if (sampleRate != 8000 && sampleRate != 12000 && sampleRate != 16000 && sampleRate != 24000 && sampleRate != 48000) {
+        throw std::runtime_error("Unsupported sample rate " + std::to_string(sampleRate) +
+                                 " (expected 8000, 12000, 16000, 24000 or 48000)");
+    }
+    if (channels != 1 && channels != 2) {
+        throw std::runtime_error("Unsupported channel count " + std::to_string(channels) + " (expected 1 or 2)");
+    }
+
+    int error = 0;
+    decoder_ = opus_decoder_create(sampleRate, channels, &error);
+    if (error != OPUS_OK || !decoder_) {
+        throw std::runtime_error(std::string("Failed to create Opus decoder: ") + opus_strerror(error));
+    }
+}
+
+DecoderSession::~DecoderSession() {
+    if (dred_) {
+        opus_dred_free(dred_);
+    }
+    if (dredDecoder_) {
+        opus_dred_decoder_destroy(dredDecoder_);
+    }
+    if (decoder_) {
+        opus_decoder_destroy(decoder_);
+    }
+}
+
+DecodeResult DecoderSession::decode(const uint8_t* input, size_t inputSize, const FramingOptions& framing, const DecodeOptions& options) {
+    PacketList list = splitPackets(input, inputSize, framing);
+    return decode(list.packets, options);
+}
+
+DecodeResult DecoderSession::decode(const std::vector<PacketView>& packets, SampleFormat format) {
+    DecodeOptions options;
+    options.format = format;
+    return decode(packets, options);
+}
+
+DecodeResult DecoderSession::decode(const std::vector<PacketView>& packets, const DecodeOptions& options) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    DecodeResult decoded;
+    decoded.format = options.format;
+    bool recover = options.concealLoss || options.dred || !options.sequenceNumbers.empty();
+    if (options.format == SampleFormat::Float32 && recover) {
+        decodeWithRecovery(packets, options, decoded.pcmFloat, decoded);
+    } else if (options.format == SampleFormat::Float32) {
+        decodeAll(packets, decoded.pcmFloat, decoded);
+    } else if (recover) {
+        decodeWithRecovery(packets, options, decoded.pcm, decoded);
+    } else {
+        decodeAll(packets, decoded.pcm, decoded);
+    }
+    decoded.outputSamples = decoded.samplesDecoded;
+    if (resampler_) {
+        decoded.outputSamples = options.format == SampleFormat::Float32
+            ? resamplePcm(*resampler_, decoded.pcmFloat, channels_, options.wholeStream)
+            : resamplePcm(*resampler_, decoded.pcm, channels_, options.wholeStream);
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    decoded.processingTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+    stats_.decodeCalls++;
+    stats_.packetsDecoded += decoded.packetsDecoded;
+    stats_.packetsConcealed += decoded.packetsConcealed;
+    stats_.packetsRecovered += decoded.packetsRecovered;
+    stats_.packetsDredRecovered += decoded.packetsDredRecovered;
+    stats_.packetsLate += decoded.packetsLate;
+    stats_.samplesDecoded += decoded.samplesDecoded;
+    stats_.samplesRecovered += decoded.samplesRecovered;
+    stats_.samplesConcealed += decoded.samplesConcealed;
+    stats_.processingTimeMs += decoded.processingTimeMs;
+
+    return decoded;
+}
+
+template <typename Sample>
+void DecoderSession::decodeAll(const std::vector<PacketView>& packets, std::vector<Sample>& pcm, DecodeResult& decoded) {
+    // The TOC byte says how many samples each packet holds, so the output is
+    // sized exactly once and every packet decodes straight into its slot.
+    size_t totalFrames = 0;
+    for (const PacketView& packet : packets) {
+        if (packet.size == 0) {
+            continue;
+        }
+        int frames = packetFrames(packet);
+        if (frames > 0) {
+            totalFrames += frames;
+        }
+    }
+
+    pcm.resize(totalFrames * channels_);
+    size_t offset = 0; // In frames
+
+    for (const PacketView& packet : packets) {
+        if (packet.size == 0) {
+            continue;
+        }
+
+        int samplesDecoded = decodePacket(packet, pcm.data() + offset * channels_, static_cast<int>(totalFrames - offset));
+
+        // Packets the pre-scan rejected are malformed, so libopus rejects
+        // them here as well
+        if (samplesDecoded < 0) {
+            stats_.packetsFailed++;
+            continue;
+        }
+
+        offset += samplesDecoded;
+        decoded.samplesDecoded += samplesDecoded;
+        decoded.packetsDecoded++;
+    }
+    // Only shrinks (a packet that passed the pre-scan failed to decode), so
+    // this never reallocates.
+    pcm.resize(offset * channels_);
+}
+
+template <typename Sample>
+void DecoderSession::decodeWithRecovery(const std::vector<PacketView>& packets, const DecodeOptions& options,
+                                        std::vector<Sample>& pcm, DecodeResult& decoded) {
+    const std::vector<uint32_t>& sequence = options.sequenceNumbers;
+    if (!sequence.empty() && sequence.size() != packets.size()) {
+        throw std::invalid_argument("Expected one sequence number per packet");
+    }
+
+    // Lay out the timeline first: present packets take their own duration,
+    // lost ones the duration of the packet before them.
+    std::vector<Slot> slots;
+    slots.reserve(packets.size());
+    size_t totalFrames = 0;
+    for (size_t i = 0; i < packets.size(); i++) {
+        int64_t position = static_cast<int64_t>(i);
+        if (!sequence.empty()) {
+            position = sequence[i] & 0xFFFF;
+            if (lastSequence_ >= 0) {
+                uint32_t delta = static_cast<uint32_t>(position - lastSequence_) & 0xFFFF;
+                if (delta == 0 || delta >= 0x8000) {
+                    decoded.packetsLate++;
+                    continue;
+                }
+                if (delta - 1 <= kMaxConcealedRun) {
+                    for (uint32_t missing = 1; missing < delta; missing++) {
+                        slots.push_back({nullptr, lastPacketFrames_, (lastSequence_ + missing) & 0xFFFF});
+                        totalFrames += lastPacketFrames_;
+                    }
+                }
+            }
+            lastSequence_ = position;
+        }
+
+        const PacketView& packet = packets[i];
+        if (packet.size == 0) {
+            slots.push_back({nullptr, lastPacketFrames_, position});
+        } else {
+            // A malformed packet keeps its place in the timeline and is
+            // concealed like a lost one.
+            int frames = packetFrames(packet);
+            if (frames > 0) {
+                lastPacketFrames_ = frames;
+            }
+            slots.push_back({&packet, frames > 0 ? frames : lastPacketFrames_, position});
+        }
+        totalFrames += slots.back().frames;
+    }
+
+    pcm.resize(totalFrames * channels_);
+    size_t offset = 0; // In frames
+    // Packet whose DRED data is loaded, and how far back it reaches
+    const PacketView* dredSource = nullptr;
+    DredCoverage dredCoverage;
+
+    for (size_t i = 0; i < slots.size(); i++) {
+        const Slot& slot = slots[i];
+        Sample* out = pcm.data() + offset * channels_;
+
+        if (slot.packet) {
+            int samplesDecoded = decodeFrame(decoder_, slot.packet->data, slot.packet->size, out, slot.frames, 0);
+            if (samplesDecoded >= 0) {
+                offset += samplesDecoded;
+                decoded.samplesDecoded += samplesDecoded;
+                decoded.packetsDecoded++;
+                continue;
+            }
+            stats_.packetsFailed++;
+        }
+
+        // Lost: prefer the redundant copy carried by the next packet, which
+        // is then decoded normally in its own slot.
+        const PacketView* next = i + 1 < slots.size() ? slots[i + 1].packet : nullptr;
+        int samples = -1;
+        if (next && hasFec(*next)) {
+            samples = recoverPacket(*next, out, slot.frames);
+            if (samples > 0) {
+                decoded.packetsRecovered++;
+            }
+        }
+        if (samples <= 0 && options.dred) {
+            // Deeper in a burst, fall back on the DRED history of the first
+            // packet after it, parsed once for the whole burst.
+            size_t j = i + 1;
+            int distance = slot.frames; // From this slot to that packet
+            while (j < slots.size() && !slots[j].packet) {
+                distance += slots[j].frames;
+                j++;
+            }
+            if (j < slots.size()) {
+                if (dredSource != slots[j].packet) {
+                    dredSource = slots[j].packet;
+                    dredCoverage = parseDred(*dredSource, std::min<int>(distance, sampleRate_));
+                }
+                if (dredCoverage.covers(distance, slot.frames)) {
+                    samples = recoverPacketDred(distance, out, slot.frames);
+                    if (samples > 0) {
+                        decoded.packetsDredRecovered++;
+                    }
+                }
+            }
+        }
+        if (samples > 0) {
+            decoded.samplesRecovered += samples;
+        } else {
+            samples = concealPacket(out, slot.frames);
+            decoded.packetsConcealed++;
+            decoded.samplesConcealed += slot.frames;
+        }
+        if (samples < 0) {
+            // Keep the timeline even if libopus cannot conceal
+            std::fill(out, out + slot.frames * channels_, Sample(0));
+            samples = slot.frames;
+        }
+
+        offset += samples;
+        decoded.samplesDecoded += samples;
+        decoded.gaps.push_back(slot.position);
+    }
+    pcm.resize(offset * channels_);
+}
+
+int DecoderSession::decodePacket(const PacketView& packet, opus_int16* pcm, int maxFrames) {
+    return decodeFrame(decoder_, packet.data, packet.size, pcm, maxFrames, 0);
+}
+
+int DecoderSession::decodePacket(const PacketView& packet, float* pcm, int maxFrames) {
+    return decodeFrame(decoder_, packet.data, packet.size, pcm, maxFrames, 0);
+}
+
+int DecoderSession::concealPacket(opus_int16* pcm, int frames) {
+    return decodeFrame(decoder_, nullptr, 0, pcm, frames, 0);
+}
+
+int DecoderSession::concealPacket(float* pcm, int frames) {
+    return decodeFrame(decoder_, nullptr, 0, pcm, frames, 0);
+}
+
+int DecoderSession::recoverPacket(const PacketView& next, opus_int16* pcm, int frames) {
+    return decodeFrame(decoder_, next.data, next.size, pcm, frames, 1);
+}
+
+int DecoderSession::recoverPacket(const PacketView& next, float* pcm, int frames) {
+    return decodeFrame(decoder_, next.data, next.size, pcm, frames, 1);
+}
+
+DredCoverage DecoderSession::parseDred(const PacketView& next, int maxFrames) {
+    if (dredUnsupported_) {
+        return {};
+    }
+    if (!dred_) {
+        int error = OPUS_OK;
+        dredDecoder_ = opus_dred_decoder_create(&error);
+        if (error == OPUS_OK && dredDecoder_) {
+            dred_ = opus_dred_alloc(&error);
+        }
+        if (error != OPUS_OK || !dred_) {
+            // OPUS_UNIMPLEMENTED unless libopus was built with DRED
+            dredUnsupported_ = true;
+            return {};
+        }
+    }
+    DredCoverage coverage;
+    int reach = opus_dred_parse(dredDecoder_, dred_, next.data, static_cast<opus_int32>(next.size),
+                                maxFrames, sampleRate_, &coverage.end, 0);
+    if (reach <= 0) {
+        return {};
+    }
+    coverage.reach = reach;
+    return coverage;
+}
+
+int DecoderSession::recoverPacketDred(int offset, opus_int16* pcm, int frames) {
+    return dred_ ? opus_decoder_dred_decode(decoder_, dred_, offset, pcm, frames) : OPUS_INVALID_STATE;
+}
+
+int DecoderSession::recoverPacketDred(int offset, float* pcm, int frames) {
+    return dred_ ? opus_decoder_dred_decode_float(decoder_, dred_, offset, pcm, frames) : OPUS_INVALID_STATE;
+}
+
+int DecoderSession::packetFrames(const PacketView& packet) const {
+    return opus_decoder_get_nb_samples(decoder_, packet.data, static_cast<opus_int32>(packet.size));
+}
+
+int DecoderSession::setGain(int gainQ8) {
+    return opus_decoder_ctl(decoder_, OPUS_SET_GAIN(gainQ8));
+}
+
+void DecoderSession::setOutputRate(int outputRate, ResamplerQuality quality) {
+    if (outputRate == 0 || outputRate == sampleRate_) {
+        resampler_.reset();
+        return;
+    }
+    resampler_ = std::make_unique<Resampler>(sampleRate_, outputRate, channels_, quality);
+}
+
+int DecoderSession::reset() {
+    if (resampler_) {
+        resampler_->reset();
+    }
+    lastSequence_ = -1;
+    lastPacketFrames_ = sampleRate_ / 50;
+    return opus_decoder_ctl(decoder_, OPUS_RESET_STATE);
+}
+
+} // namespace rnopus
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PacketFraming.h"
+#include "Resampler.h"
+
+#if __has_include("opus/opus.h")
+#include "opus/opus.h"
+#elif __has_include("opus.h")
+#include "opus.h"
+#else
+#error "Could not find opus.h"
+#endif
+
+namespace rnopus {
+
+// Output sample type: opus_decode or opus_decode_float.
+enum class SampleFormat {
+    Int16,
+    Float32,
+};
+
+// Maps "int16" and "float32" to a SampleFormat. Throws
+// std::invalid_argument for anything else.
+SampleFormat parseSampleFormat(const std::string& name);
+
+// Float PCM to int16 on the same 1/32768 scale as libopus, clamped
+inline opus_int16 floatToInt16(float sample) {
+    float scaled = std::round(sample * 32768.0f);
+    return static_cast<opus_int16>(std::max(-32768.0f, std::min(32767.0f, scaled)));
+}
+
+struct DecodeOptions {
+    SampleFormat format = SampleFormat::Int16;
+    // Zero-length packets, packets libopus rejects and sequence gaps count
+    // as lost. Each lost packet is rebuilt from the in-band FEC of the packet
+    // after it when that carries any (opus_packet_has_lbrr), and concealed
+    // (PLC) otherwise, so the output timeline has no holes.
+    bool concealLoss = false;
+    // Optional RTP-style 16-bit sequence number per packet. Gaps, including
+    // the one between the previous call and this one, are filled as lost
+    // packets; duplicates and late packets are dropped. Implies concealLoss.
+    std::vector<uint32_t> sequenceNumbers;
+    // Also rebuild lost packets from Deep Redundancy (DRED): the first packet
+    // after a burst can carry up to a second of low-bitrate history. Needs a
+    // libopus built with DRED support; without it loss falls back to FEC and
+    // PLC. Implies concealLoss.
+    bool dred = false;
+    // The packets are a whole stream, decoded by a session that has decoded
+    // nothing since it was created or reset. With an output rate, the
+    // resampler is then flushed at the end and its delay trimmed from the
+    // start, so outputSamples is samplesDecoded at the output rate.
+    bool wholeStream = false;
+};
+
+struct DecodeResult {
+    SampleFormat format = SampleFormat::Int16;
+    std::vector<opus_int16> pcm; // Interleaved, SampleFormat::Int16
+    std::vector<float> pcmFloat; // Interleaved, SampleFormat::Float32
+    size_t pcmOffset = 0;        // Leading samples (all channels) of the PCM that are not output
+    int samplesDecoded = 0;      // Per channel at the decoding rate, including concealed audio
+    int outputSamples = 0;       // Per channel in the PCM: samplesDecoded after resampling
+    int packetsDecoded = 0;
+    int packetsConcealed = 0;    // Lost packets filled by PLC
+    int packetsRecovered = 0;    // Lost packets rebuilt from in-band FEC
+    int packetsDredRecovered = 0; // Lost packets rebuilt from DRED
+    int packetsLate = 0;         // Duplicate or out-of-order, dropped
+    int samplesRecovered = 0;    // Per channel, from FEC or DRED
+    int samplesConcealed = 0;    // Per channel, from PLC
+    // Where each lost packet was: its sequence number when they are given,
+    // otherwise its index in the input
+    std::vector<int64_t> gaps;
+    double processingTimeMs = 0;
+};
+
+// Audio a packet's DRED data can rebuild, in frames before that packet:
+// from `reach` back down to `end`. The last `end` frames before the packet
+// are not covered.
+struct DredCoverage {
+    int reach = 0;
+    int end = 0;
+
+    // Whether the `frames` frames starting `offset` before the packet are
+    // all covered
+    bool covers(int offset, int frames) const { return offset <= reach && offset - frames >= end; }
+};
+
+// Running totals over the lifetime of a session (reset() keeps them).
+struct DecoderStats {
+    uint64_t decodeCalls = 0;
+    uint64_t packetsDecoded = 0;
+    uint64_t packetsFailed = 0;
+    uint64_t packetsConcealed = 0;
+    uint64_t packetsRecovered = 0;
+    uint64_t packetsDredRecovered = 0;
+    uint64_t packetsLate = 0;
+    uint64_t samplesDecoded = 0;
+    uint64_t samplesRecovered = 0;
+    uint64_t samplesConcealed = 0;
+    double processingTimeMs = 0;
+};
+
+// One OpusDecoder with its own SILK/CELT state and statistics. Not thread
+// safe; callers serialize access per session.
+class DecoderSession {
+public:
+    // Any Opus output rate (8, 12, 16, 24 or 48 kHz), mono or stereo.
+    // Throws std::runtime_error for anything else.
+    DecoderSession(opus_int32 sampleRate, int channels);
+    ~DecoderSession();
+
+    DecoderSession(const DecoderSession&) = delete;
+    DecoderSession& operator=(const DecoderSession&) = delete;
+
+    // Splits the input according to `framing` and decodes every packet in
+    // order. Packets libopus rejects are counted as failed. Without
+    // concealLoss they are skipped, as are zero-length entries.
+    DecodeResult decode(const uint8_t* input, size_t inputSize, const FramingOptions& framing,
+                        const DecodeOptions& options = {});
+    DecodeResult decode(const std::vector<PacketView>& packets, const DecodeOptions& options = {});
+    DecodeResult decode(const std::vector<PacketView>& packets, SampleFormat format);
+
+    // Decodes one packet into `pcm`, which has room for `maxFrames` samples
+    // per channel. Returns the samples per channel or an Opus error code.
+    // Leaves the statistics alone; streaming callers keep their own.
+    int decodePacket(const PacketView& packet, opus_int16* pcm, int maxFrames);
+    int decodePacket(const PacketView& packet, float* pcm, int maxFrames);
+
+    // Packet loss concealment: extrapolates `frames` samples per channel
+    // from the decoder history (opus_decode with a NULL packet).
+    int concealPacket(opus_int16* pcm, int frames);
+    int concealPacket(float* pcm, int frames);
+
+    // Rebuilds the `frames` samples per channel before `next` from the
+    // in-band FEC (LBRR) data carried by `next`.
+    int recoverPacket(const PacketView& next, opus_int16* pcm, int frames);
+    int recoverPacket(const PacketView& next, float* pcm, int frames);
+
+    // Parses the DRED data in `next`, looking up to `maxFrames` samples per
+    // channel back. Returns the span before `next` it covers, empty when
+    // there is none or libopus lacks DRED support. The result stays loaded
+    // for recoverPacketDred until the next parse.
+    DredCoverage parseDred(const PacketView& next, int maxFrames);
+
+    // Rebuilds `frames` samples per channel starting `offset` frames before
+    // the packet last given to parseDred.
+    int recoverPacketDred(int offset, opus_int16* pcm, int frames);
+    int recoverPacketDred(int offset, float* pcm, int frames);
+
+    static bool hasFec(const PacketView& packet) {
+        return opus_packet_has_lbrr(packet.data, static_cast<opus_int32>(packet.size)) > 0;
+    }
+
+    // Samples per channel the packet decodes to at this session's rate
+    // (opus_decoder_get_nb_samples), or an Opus error code.
+    int packetFrames(const PacketView& packet) const;
+
+    // Samples per channel in the longest possible packet (120 ms). A buffer
+    // this size holds any single packet.
+    int maxPacketFrames() const { return sampleRate_ / 1000 * 120; }
+
+    // Output gain in Q7.8 dB (OPUS_SET_GAIN). Returns an Opus error code.
+    int setGain(int gainQ8);
+
+    // Resamples the PCM of every later decode() to `outputRate`, any rate
+    // such as 44100, with state carried across calls. 0 or the decoding rate
+    // turns it off. Only DecodeResult::outputSamples is at the output rate;
+    // the other counts and the stats stay at the decoding rate. Throws
+    // std::invalid_argument for an unsupported ratio.
+    void setOutputRate(int outputRate, ResamplerQuality quality = ResamplerQuality::Medium);
+
+    // Drops the decoder and resampler history (OPUS_RESET_STATE). Returns
+    // an Opus error code.
+    int reset();
+
+    opus_int32 sampleRate() const { return sampleRate_; }
+    // Rate of decode() output
+    int outputRate() const { return resampler_ ? resampler_->outputRate() : sampleRate_; }
+    int channels() const { return channels_; }
+    const DecoderStats& stats() const { return stats_; }
+
+private:
+    template <typename Sample>
+    void decodeAll(const std::vector<PacketView>& packets, std::vector<Sample>& pcm, DecodeResult& decoded);
+    template <typename Sample>
+    void decodeWithRecovery(const std::vector<PacketView>& packets, const DecodeOptions& options,
+                            std::vector<Sample>& pcm, DecodeResult& decoded);
+
+    OpusDecoder* decoder_ = nullptr;
+    opus_int32 sampleRate_;
+    int channels_;
+    std::unique_ptr<Resampler> resampler_; // Null without an output rate
+    DecoderStats stats_;
+    // Loss recovery state carried between calls; cleared by reset()
+    int64_t lastSequence_ = -1;
+    int lastPacketFrames_;
+    // Created on first use; neural DRED decoding is only paid for on loss
+    OpusDREDDecoder* dredDecoder_ = nullptr;
+    OpusDRED* dred_ = nullptr;
+    bool dredUnsupported_ = false;
+};
+
+} // namespace rnopus
@@ -0,0 +1,166 @@
+#include "EncoderSession.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+namespace rnopus {
+
+namespace {
+
+int encodeFrameWith(OpusEncoder* encoder, const opus_int16* pcm, int frameSize, uint8_t* packet, int maxBytes) {
+    return opus_encode(encoder, pcm, frameSize, packet, maxBytes);
+}
+
+int encodeFrameWith(OpusEncoder* encoder, const float* pcm, int frameSize, uint8_t* packet, int maxBytes) {
+    return opus_encode_float(encoder, pcm, frameSize, packet, maxBytes);
+}
+
+// Frame durations Opus can encode, in half milliseconds
+bool isValidFrameDuration(double frameDurationMs) {
+    static const int kHalfMs[] = {5, 10, 20, 40, 80, 120, 160, 200, 240};
+    double halfMs = frameDurationMs * 2;
+    return std::any_of(std::begin(kHalfMs), std::end(kHalfMs), [halfMs](int valid) { return halfMs == valid; });
+}
+
+void check(int error, const char* setting) {
+    if (error != OPUS_OK) {
+        throw std::runtime_error(std::string("Invalid encoder ") + setting + ": " + opus_strerror(error));
+    }
+}
+
+} // namespace
+
+int parseApplication(const std::string& name) {
+    if (name == "voip") return OPUS_APPLICATION_VOIP;
+    if (name == "audio") return OPUS_APPLICATION_AUDIO;
+    if (name == "restricted-lowdelay") return OPUS_APPLICATION_RESTRICTED_LOWDELAY;
+    throw std::invalid_argument("Unknown application: " + name);
+}
+
+EncoderSession::EncoderSession(const EncoderConfig& config)
+    : sampleRate_(config.sampleRate), channels_(config.channels) {
+    if (!isValidFrameDuration(config.frameDurationMs)) {
+        throw std::invalid_argument("Unsupported frame duration " + std::to_string(config.frameDurationMs) +
+                                    " ms (expected 2.5, 5, 10, 20, 40, 60, 80, 100 or 120)");
+    }
+    frameSize_ = static_cast<int>(config.sampleRate * config.frameDurationMs / 1000);
+
+    int error = 0;
+    encoder_ = opus_encoder_create(config.sampleRate, config.channels, config.application, &error);
+    if (error != OPUS_OK || !encoder_) {
+        throw std::runtime_error(std::string("Failed to create Opus encoder: ") + opus_strerror(error));
+    }
+
+    try {
+        check(opus_encoder_ctl(encoder_, OPUS_SET_BITRATE(config.bitrate)), "bitrate");
+        check(opus_encoder_ctl(encoder_, OPUS_SET_VBR(config.vbr ? 1 : 0)), "VBR");
+        check(opus_encoder_ctl(encoder_, OPUS_SET_VBR_CONSTRAINT(config.constrainedVbr ? 1 : 0)), "VBR constraint");
+        if (config.complexity >= 0) {
+            check(opus_encoder_ctl(encoder_, OPUS_SET_COMPLEXITY(config.complexity)), "complexity");
+        }
+        check(opus_encoder_ctl(encoder_, OPUS_SET_INBAND_FEC(config.fec ? 1 : 0)), "FEC");
+        check(opus_encoder_ctl(encoder_, OPUS_SET_PACKET_LOSS_PERC(config.packetLossPercent)), "packet loss");
+        check(opus_encoder_ctl(encoder_, OPUS_SET_DTX(config.dtx ? 1 : 0)), "DTX");
+    } catch (...) {
+        opus_encoder_destroy(encoder_);
+        throw;
+    }
+}
+
+EncoderSession::~EncoderSession() {
+    if (encoder_) {
+        opus_encoder_destroy(encoder_);
+    }
+}
+
+EncodeResult EncoderSession::encode(const opus_int16* pcm, size_t frames, Framing framing) {
+    return encodeAll(pcm, frames, framing);
+}
+
+EncodeResult EncoderSession::encode(const float* pcm, size_t frames, Framing framing) {
+    return encodeAll(pcm, frames, framing);
+}
+
+template <typename Sample>
+EncodeResult EncoderSession::encodeAll(const Sample* pcm, size_t frames, Framing framing) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    EncodeResult encoded;
+    const size_t packets = (frames + frameSize_ - 1) / frameSize_;
+    const size_t frameSamples = static_cast<size_t>(frameSize_) * channels_;
+
+    // Size the output for the configured bitrate; VBR peaks just grow it.
+    encoded.data.reserve(packets * (static_cast<size_t>(bitrate()) * frameSize_ / sampleRate_ / 8 + 4));
+    encoded.lengths.reserve(packets);
+
+    uint8_t packet[kMaxPacketBytes];
+    std::vector<Sample> padded;
+    for (size_t i = 0; i < packets; i++) {
+        const Sample* frame = pcm + i * frameSamples;
+        size_t available = std::min<size_t>(frameSize_, frames - i * frameSize_);
+        if (available < static_cast<size_t>(frameSize_)) {
+            padded.assign(frameSamples, Sample(0));
+            std::copy(frame, frame + available * channels_, padded.begin());
+            frame = padded.data();
+        }
+
+        int size = encodeFrameWith(encoder_, frame, frameSize_, packet, kMaxPacketBytes);
+        if (size < 0) {
+            throw std::runtime_error(std::string("Opus encode failed: ") + opus_strerror(size));
+        }
+        appendPacket(encoded.data, packet, static_cast<size_t>(size), framing);
+        encoded.lengths.push_back(static_cast<uint32_t>(size));
+        encoded.packetsEncoded++;
+        encoded.samplesEncoded += frameSize_;
+        stats_.bytesEncoded += size;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    encoded.processingTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+    stats_.encodeCalls++;
+    stats_.packetsEncoded += encoded.packetsEncoded;
+    stats_.samplesEncoded += encoded.samplesEncoded;
+    stats_.processingTimeMs += encoded.processingTimeMs;
+    return encoded;
+}
+
+int EncoderSession::encodeFrame(const opus_int16* pcm, uint8_t* packet, int maxBytes) {
+    return encodeFrameWith(encoder_, pcm, frameSize_, packet, maxBytes);
+}
+
+int EncoderSession::encodeFrame(const float* pcm, uint8_t* packet, int maxBytes) {
+    return encodeFrameWith(encoder_, pcm, frameSize_, packet, maxBytes);
+}
+
+int EncoderSession::setBitrate(int bitrate) {
+    return opus_encoder_ctl(encoder_, OPUS_SET_BITRATE(bitrate));
+}
+
+int EncoderSession::bitrate() const {
+    opus_int32 bitrate = 0;
+    opus_encoder_ctl(encoder_, OPUS_GET_BITRATE(&bitrate));
+    return bitrate;
+}
+
+int EncoderSession::setPacketLossPercent(int percent) {
+    return opus_encoder_ctl(encoder_, OPUS_SET_PACKET_LOSS_PERC(percent));
+}
+
+int EncoderSession::setFec(bool enabled) {
+    return opus_encoder_ctl(encoder_, OPUS_SET_INBAND_FEC(enabled ? 1 : 0));
+}
+
+int EncoderSession::reset() {
+    return opus_encoder_ctl(encoder_, OPUS_RESET_STATE);
+}
+
+int EncoderSession::lookahead() const {
+    opus_int32 samples = 0;
+    opus_encoder_ctl(encoder_, OPUS_GET_LOOKAHEAD(&samples));
+    return samples;
+}
+
+} // namespace rnopus
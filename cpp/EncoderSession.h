@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "PacketFraming.h"
+
+#if __has_include("opus/opus.h")
+#include "opus/opus.h"
+#elif __has_include("opus.h")
+#include "opus.h"
+#else
+#error "Could not find opus.h"
+#endif
+
+namespace rnopus {
+
+// Maps "voip", "audio" and "restricted-lowdelay" to an OPUS_APPLICATION_*
+// value. Throws std::invalid_argument for anything else.
+int parseApplication(const std::string& name);
+
+struct EncoderConfig {
+    opus_int32 sampleRate = 48000; // 8, 12, 16, 24 or 48 kHz
+    int channels = 1;              // 1 or 2
+    int application = OPUS_APPLICATION_AUDIO;
+    int bitrate = OPUS_AUTO;       // Bits per second, or OPUS_AUTO
+    bool vbr = true;
+    bool constrainedVbr = true;
+    int complexity = -1;           // 0-10, or -1 for the libopus default
+    bool fec = false;              // In-band FEC (SILK modes only)
+    int packetLossPercent = 0;     // Expected loss, tunes FEC
+    bool dtx = false;
+    // 2.5, 5, 10, 20, 40, 60, 80, 100 or 120
+    double frameDurationMs = 20;
+};
+
+struct EncodeResult {
+    // The packets, framed as requested
+    std::vector<uint8_t> data;
+    // Bare size of each packet, whatever the framing
+    std::vector<uint32_t> lengths;
+    int packetsEncoded = 0;
+    int samplesEncoded = 0; // Per channel, including the padding of the last frame
+    double processingTimeMs = 0;
+};
+
+// Running totals over the lifetime of a session (reset() keeps them).
+struct EncoderStats {
+    uint64_t encodeCalls = 0;
+    uint64_t packetsEncoded = 0;
+    uint64_t bytesEncoded = 0; // Packet bytes, without framing
+    uint64_t samplesEncoded = 0;
+    double processingTimeMs = 0;
+};
+
+// One OpusEncoder configured once at creation. Not thread safe; callers
+// serialize access per session.
+class EncoderSession {
+public:
+    // Throws std::runtime_error if libopus rejects the format or a setting,
+    // std::invalid_argument for an unsupported frame duration.
+    explicit EncoderSession(const EncoderConfig& config);
+    ~EncoderSession();
+
+    EncoderSession(const EncoderSession&) = delete;
+    EncoderSession& operator=(const EncoderSession&) = delete;
+
+    // Encodes `frames` samples per channel of interleaved PCM into packets of
+    // frameSize() each. A partial last frame is padded with silence. Throws
+    // std::runtime_error if libopus fails on a frame.
+    EncodeResult encode(const opus_int16* pcm, size_t frames, Framing framing);
+    EncodeResult encode(const float* pcm, size_t frames, Framing framing);
+
+    // Encodes exactly one frame into `packet`. Returns the packet size or an
+    // Opus error code.
+    int encodeFrame(const opus_int16* pcm, uint8_t* packet, int maxBytes);
+    int encodeFrame(const float* pcm, uint8_t* packet, int maxBytes);
+
+    // Current target in bits per second (resolves OPUS_AUTO)
+    int bitrate() const;
+
+    // Return an Opus error code.
+    int setBitrate(int bitrate);
+    int setPacketLossPercent(int percent);
+    int setFec(bool enabled);
+
+    // Drops the encoder history (OPUS_RESET_STATE). Returns an Opus error code.
+    int reset();
+
+    // Samples per channel in each packet
+    int frameSize() const { return frameSize_; }
+    // Samples per channel the decoder should skip at the start (the
+    // OpusHead pre-skip), at this session's rate
+    int lookahead() const;
+    opus_int32 sampleRate() const { return sampleRate_; }
+    int channels() const { return channels_; }
+    const EncoderStats& stats() const { return stats_; }
+
+    // Largest packet opus_encode may produce, as libopus recommends
+    static constexpr int kMaxPacketBytes = 4000;
+
+private:
+    template <typename Sample>
+    EncodeResult encodeAll(const Sample* pcm, size_t frames, Framing framing);
+
+    OpusEncoder* encoder_ = nullptr;
+    opus_int32 sampleRate_;
+    int channels_;
+    int frameSize_;
+    EncoderStats stats_;
+};
+
+} // namespace rnopus
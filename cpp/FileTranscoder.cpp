@@ -0,0 +1,213 @@
+#include "FileTranscoder.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "MappedFile.h"
+#include "WavWriter.h"
+
+namespace rnopus {
+
+namespace {
+
+std::string errnoMessage(const char* what, const std::string& path) {
+    return std::string(what) + " " + path + ": " + std::strerror(errno);
+}
+
+// Buffered sequential writer for converted packet files. The file is
+// removed unless close() succeeds.
+class PacketFileWriter {
+public:
+    static constexpr size_t kBufferSize = 256 * 1024;
+
+    explicit PacketFileWriter(const std::string& path) : path_(path) {
+        fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            throw std::runtime_error(errnoMessage("Failed to open", path));
+        }
+        buffer_.reserve(kBufferSize + 2 * 1024);
+    }
+
+    ~PacketFileWriter() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            unlink(path_.c_str());
+        }
+    }
+
+    PacketFileWriter(const PacketFileWriter&) = delete;
+    PacketFileWriter& operator=(const PacketFileWriter&) = delete;
+
+    void append(const uint8_t* packet, size_t size, Framing framing) {
+        appendPacket(buffer_, packet, size, framing);
+        if (buffer_.size() >= kBufferSize) {
+            flush();
+        }
+    }
+
+    // Returns the bytes written.
+    uint64_t close() {
+        flush();
+        int fd = fd_;
+        fd_ = -1;
+        if (::close(fd) != 0) {
+            std::string message = errnoMessage("Failed to close", path_);
+            unlink(path_.c_str());
+            throw std::runtime_error(message);
+        }
+        return written_;
+    }
+
+private:
+    void flush() {
+        const uint8_t* data = buffer_.data();
+        size_t size = buffer_.size();
+        while (size > 0) {
+            ssize_t count = write(fd_, data, size);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(errnoMessage("Failed to write", path_));
+            }
+            data += count;
+            size -= static_cast<size_t>(count);
+        }
+        written_ += buffer_.size();
+        buffer_.clear();
+    }
+
+    std::string path_;
+    int fd_ = -1;
+    std::vector<uint8_t> buffer_;
+    uint64_t written_ = 0;
+};
+
+double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace
+
+TranscodeSummary transcodeToWav(const std::string& inputPath, const std::string& outputPath,
+                                const FramingOptions& framing, opus_int32 sampleRate, int channels) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    MappedFile input(inputPath);
+    PacketReader reader(input.data(), input.size(), framing);
+    DecoderSession session(sampleRate, channels);
+
+    const int maxFrames = session.maxPacketFrames();
+    std::vector<opus_int16> pcm(static_cast<size_t>(maxFrames) * channels);
+
+    TranscodeSummary summary;
+    WavWriter writer(outputPath, static_cast<uint32_t>(sampleRate), static_cast<uint16_t>(channels));
+    try {
+        PacketView packet;
+        while (reader.next(packet)) {
+            if (packet.size == 0) {
+                continue;
+            }
+            int samples = session.decodePacket(packet, pcm.data(), maxFrames);
+            if (samples < 0) {
+                summary.packetsFailed++;
+                continue;
+            }
+            writer.append(pcm.data(), static_cast<size_t>(samples) * channels);
+            summary.samplesDecoded += samples;
+            summary.packetsDecoded++;
+        }
+        writer.finalize();
+        summary.dataBytes = writer.dataBytes();
+    } catch (...) {
+        unlink(outputPath.c_str());
+        throw;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    summary.processingTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    summary.durationMs = 1000.0 * summary.samplesDecoded / sampleRate;
+    return summary;
+}
+
+PaddingSummary padPacketFile(const std::string& inputPath, const std::string& outputPath,
+                             const FramingOptions& framing, int paddedSize) {
+    if (paddedSize <= 0) {
+        throw std::invalid_argument("paddedSize must be positive");
+    }
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    MappedFile input(inputPath);
+    PacketReader reader(input.data(), input.size(), framing);
+    PacketFileWriter writer(outputPath);
+    std::vector<uint8_t> packet(paddedSize);
+
+    PaddingSummary summary;
+    summary.inputBytes = input.size();
+    PacketView view;
+    while (reader.next(view)) {
+        if (view.size == 0) {
+            throw std::invalid_argument("Packet " + std::to_string(summary.packets) + " is empty; fixed framing cannot carry it");
+        }
+        if (view.size > static_cast<size_t>(paddedSize)) {
+            throw std::invalid_argument("Packet " + std::to_string(summary.packets) + " is " + std::to_string(view.size) +
+                                        " bytes, larger than paddedSize");
+        }
+        std::memcpy(packet.data(), view.data, view.size);
+        int error = opus_packet_pad(packet.data(), static_cast<opus_int32>(view.size), paddedSize);
+        if (error != OPUS_OK) {
+            throw std::invalid_argument("Packet " + std::to_string(summary.packets) + " cannot be padded: " + opus_strerror(error));
+        }
+        writer.append(packet.data(), packet.size(), Framing::Fixed);
+        summary.packets++;
+    }
+    summary.truncatedBytes = reader.skippedBytes();
+    summary.outputBytes = writer.close();
+
+    summary.processingTimeMs = elapsedMs(startTime);
+    return summary;
+}
+
+PaddingSummary unpadPacketFile(const std::string& inputPath, const std::string& outputPath, int paddedSize,
+                               Framing framing) {
+    if (framing != Framing::U16 && framing != Framing::Varint) {
+        throw std::invalid_argument("Unpadded packets need u16 or varint framing");
+    }
+    FramingOptions fixed;
+    fixed.framing = Framing::Fixed;
+    fixed.packetSize = paddedSize;
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    MappedFile input(inputPath);
+    PacketReader reader(input.data(), input.size(), fixed);
+    PacketFileWriter writer(outputPath);
+    std::vector<uint8_t> packet(paddedSize);
+
+    PaddingSummary summary;
+    summary.inputBytes = input.size();
+    PacketView view;
+    while (reader.next(view)) {
+        // The mapping is read-only; unpad a copy
+        std::memcpy(packet.data(), view.data, view.size);
+        opus_int32 size = opus_packet_unpad(packet.data(), static_cast<opus_int32>(view.size));
+        if (size < 0) {
+            throw std::invalid_argument("Packet " + std::to_string(summary.packets) + " cannot be unpadded: " + opus_strerror(size));
+        }
+        writer.append(packet.data(), static_cast<size_t>(size), framing);
+        summary.packets++;
+    }
+    summary.truncatedBytes = reader.skippedBytes();
+    summary.outputBytes = writer.close();
+
+    summary.processingTimeMs = elapsedMs(startTime);
+    return summary;
+}
+
+} // namespace rnopus
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "DecoderSession.h"
+#include "PacketFraming.h"
+
+namespace rnopus {
+
+struct TranscodeSummary {
+    uint64_t samplesDecoded = 0; // Per channel
+    uint64_t packetsDecoded = 0;
+    uint64_t packetsFailed = 0;
+    uint64_t dataBytes = 0;      // PCM bytes in the WAV file
+    double durationMs = 0;
+    double processingTimeMs = 0;
+};
+
+// Decodes a file of framed Opus packets into a 16-bit WAV file. Packets go
+// from the memory-mapped input through one decoder straight into a
+// WavWriter, so memory use does not grow with the file. Packets libopus
+// rejects are skipped and counted.
+//
+// Throws std::runtime_error on I/O errors and std::invalid_argument on
+// malformed framing; the partial output file is removed in both cases.
+TranscodeSummary transcodeToWav(const std::string& inputPath, const std::string& outputPath,
+                                const FramingOptions& framing, opus_int32 sampleRate, int channels);
+
+struct PaddingSummary {
+    uint64_t packets = 0;
+    uint64_t inputBytes = 0;
+    uint64_t outputBytes = 0;
+    // Trailing input shorter than one fixed-size packet, which is skipped
+    uint64_t truncatedBytes = 0;
+    double processingTimeMs = 0;
+};
+
+// Pads every packet of a framed file to exactly `paddedSize` bytes with
+// opus_packet_pad and writes them back to back: the fixed-size layout of
+// decodeMultipleOpusPackets. The padding is part of the Opus packet, so the
+// audio does not change. One pass over the memory-mapped input.
+//
+// Throws std::invalid_argument for a packet larger than `paddedSize` or of
+// zero length, which fixed framing cannot carry; I/O errors and malformed
+// framing throw as in transcodeToWav. The partial output file is removed.
+PaddingSummary padPacketFile(const std::string& inputPath, const std::string& outputPath,
+                             const FramingOptions& framing, int paddedSize);
+
+// Reverses padPacketFile: strips the padding of each `paddedSize` packet
+// with opus_packet_unpad and writes the packets with `framing`, which must
+// be U16 or Varint. A short last packet is not written; truncatedBytes
+// says how long it was.
+PaddingSummary unpadPacketFile(const std::string& inputPath, const std::string& outputPath, int paddedSize,
+                               Framing framing);
+
+} // namespace rnopus
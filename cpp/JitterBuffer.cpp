@@ -0,0 +1,285 @@
+#include "JitterBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace rnopus {
+
+namespace {
+
+// RMS below which a frame may be dropped to shrink the delay (about -40 dBFS)
+constexpr float kQuietRms = 0.01f;
+
+bool isQuiet(const float* pcm, size_t count) {
+    double energy = 0;
+    for (size_t i = 0; i < count; i++) {
+        energy += double(pcm[i]) * pcm[i];
+    }
+    return count == 0 || std::sqrt(energy / count) < kQuietRms;
+}
+
+} // namespace
+
+JitterBuffer::JitterBuffer(opus_int32 sampleRate, int channels, const JitterBufferConfig& config)
+    : session_(sampleRate, channels), config_(config), lastFrames_(sampleRate / 50) {
+    if (config.minDelayMs < 0 || config.maxDelayMs < config.minDelayMs) {
+        throw std::invalid_argument("Expected 0 <= minDelayMs <= maxDelayMs");
+    }
+    pending_.reserve(static_cast<size_t>(session_.maxPacketFrames()) * channels);
+}
+
+int64_t JitterBuffer::unwrap(uint32_t sequence) const {
+    if (highestSequence_ < 0) {
+        return sequence & 0xFFFF;
+    }
+    int16_t delta = static_cast<int16_t>((sequence - static_cast<uint32_t>(highestSequence_)) & 0xFFFF);
+    return highestSequence_ + delta;
+}
+
+void JitterBuffer::updateJitter(int64_t timestamp, double arrivalMs) {
+    double transitMs = arrivalMs - timestamp / 48.0;
+    if (haveTransit_) {
+        double d = std::fabs(transitMs - lastTransitMs_);
+        stats_.jitterMs += (d - stats_.jitterMs) / 16;
+    }
+    lastTransitMs_ = transitMs;
+    haveTransit_ = true;
+}
+
+void JitterBuffer::push(uint32_t sequence, int64_t timestamp, const uint8_t* data, size_t size, double arrivalMs) {
+    stats_.packetsReceived++;
+    if (size == 0) {
+        return; // Nothing to play; the slot is concealed when its turn comes
+    }
+
+    int64_t position = unwrap(sequence);
+    if (nextSequence_ >= 0 && position < nextSequence_) {
+        stats_.packetsLate++;
+        return;
+    }
+    if (packets_.count(position)) {
+        stats_.packetsDuplicate++;
+        return;
+    }
+
+    // A malformed packet keeps its slot and is concealed on playout
+    PacketView view{data, size};
+    int frames = session_.packetFrames(view);
+    if (frames > 0) {
+        lastFrames_ = frames;
+    } else {
+        frames = lastFrames_;
+    }
+
+    if (timestamp < 0) {
+        timestamp = position * (int64_t(frames) * 48000 / session_.sampleRate());
+    }
+    updateJitter(timestamp, arrivalMs);
+
+    packets_.emplace(position, Packet{std::vector<uint8_t>(data, data + size), frames});
+    bufferedFrames_ += frames;
+    highestSequence_ = std::max(highestSequence_, position);
+
+    // A sender far ahead of playout (or a stalled consumer): keep the newest
+    // audio rather than growing without bound.
+    while (packets_.size() > 1 && bufferedMs() > 2.0 * config_.maxDelayMs) {
+        stats_.packetsDropped++;
+        erase(packets_.begin());
+        if (nextSequence_ >= 0) {
+            // Every buffered packet is at or after nextSequence_, so the
+            // numbers skipped besides the dropped one never arrived.
+            int64_t next = packets_.begin()->first;
+            stats_.packetsLost += next - nextSequence_ - 1;
+            nextSequence_ = next;
+        }
+    }
+}
+
+void JitterBuffer::erase(std::map<int64_t, Packet>::iterator it) {
+    bufferedFrames_ -= it->second.frames;
+    packets_.erase(it);
+}
+
+double JitterBuffer::bufferedMs() const {
+    return framesToMs(bufferedFrames_) + framesToMs((pending_.size() - pendingOffset_) / session_.channels());
+}
+
+double JitterBuffer::targetDelayMs() const {
+    double target = framesToMs(lastFrames_) + 4 * stats_.jitterMs;
+    return std::min<double>(std::max<double>(target, config_.minDelayMs), config_.maxDelayMs);
+}
+
+void JitterBuffer::produceFrame() {
+    const int channels = session_.channels();
+    pending_.clear();
+    pendingOffset_ = 0;
+
+    auto it = packets_.find(nextSequence_);
+    if (it != packets_.end()) {
+        const Packet& packet = it->second;
+        pending_.resize(static_cast<size_t>(packet.frames) * channels);
+        int samples = session_.decodePacket({packet.data.data(), packet.data.size()}, pending_.data(), packet.frames);
+        bool decoded = samples >= 0;
+        erase(it);
+        nextSequence_++;
+
+        if (!decoded) {
+            samples = session_.concealPacket(pending_.data(), packet.frames);
+            stats_.packetsConcealed++;
+            samplesConcealed_ += packet.frames;
+        } else {
+            stats_.packetsDecoded++;
+            // Time compression: once the buffer holds well over the target,
+            // skip quiet frames (or any frame past the maximum delay).
+            double delayMs = framesToMs(bufferedFrames_);
+            bool overTarget = delayMs > targetDelayMs() + 2 * framesToMs(samples);
+            if (overTarget && (delayMs > config_.maxDelayMs || isQuiet(pending_.data(), samples * channels))) {
+                stats_.packetsDropped++;
+                pending_.clear();
+                return;
+            }
+        }
+        if (samples < 0) {
+            std::fill(pending_.begin(), pending_.end(), 0.0f);
+            samples = packet.frames;
+        }
+        pending_.resize(static_cast<size_t>(samples) * channels);
+        samplesProduced_ += samples;
+        underrunFrames_ = 0;
+        return;
+    }
+
+    const int frames = lastFrames_;
+    pending_.resize(static_cast<size_t>(frames) * channels);
+    int samples = -1;
+
+    if (!packets_.empty()) {
+        // The packet due now has not arrived but later ones have: it is lost.
+        // A gap longer than the maximum delay is a sender restart, skipped
+        // rather than concealed.
+        int64_t gap = packets_.begin()->first - nextSequence_;
+        if (framesToMs(gap * frames) > config_.maxDelayMs) {
+            stats_.packetsLost += gap;
+            nextSequence_ = packets_.begin()->first;
+            pending_.clear();
+            return;
+        }
+
+        stats_.packetsLost++;
+        auto next = packets_.find(nextSequence_ + 1);
+        if (next != packets_.end()) {
+            PacketView view{next->second.data.data(), next->second.data.size()};
+            if (DecoderSession::hasFec(view)) {
+                samples = session_.recoverPacket(view, pending_.data(), frames);
+                if (samples > 0) {
+                    stats_.packetsRecovered++;
+                }
+            }
+        }
+        if (samples <= 0 && config_.dred) {
+            auto first = packets_.begin();
+            int distance = static_cast<int>(std::min<int64_t>((first->first - nextSequence_) * frames, session_.sampleRate()));
+            if (dredSequence_ != first->first) {
+                dredSequence_ = first->first;
+                dredCoverage_ = session_.parseDred({first->second.data.data(), first->second.data.size()}, distance);
+            }
+            if (dredCoverage_.covers(distance, frames)) {
+                samples = session_.recoverPacketDred(distance, pending_.data(), frames);
+                if (samples > 0) {
+                    stats_.packetsDredRecovered++;
+                }
+            }
+        }
+        nextSequence_++;
+        underrunFrames_ = 0;
+    } else {
+        // Nothing buffered: stretch the audio with PLC and wait. After a
+        // maximum delay's worth, go back to buffering.
+        stats_.underruns++;
+        underrunFrames_ += frames;
+        if (framesToMs(underrunFrames_) >= config_.maxDelayMs) {
+            playing_ = false;
+            underrunFrames_ = 0;
+        }
+    }
+
+    if (samples <= 0) {
+        samples = session_.concealPacket(pending_.data(), frames);
+        stats_.packetsConcealed++;
+    }
+    if (samples < 0) {
+        std::fill(pending_.begin(), pending_.end(), 0.0f);
+        samples = frames;
+    }
+    pending_.resize(static_cast<size_t>(samples) * channels);
+    samplesProduced_ += samples;
+    samplesConcealed_ += samples;
+}
+
+bool JitterBuffer::pull(float* pcm, int frames) {
+    const size_t count = static_cast<size_t>(frames) * session_.channels();
+
+    if (!playing_) {
+        if (packets_.empty() || bufferedMs() < targetDelayMs()) {
+            std::fill(pcm, pcm + count, 0.0f);
+            return false;
+        }
+        playing_ = true;
+        if (nextSequence_ < 0) {
+            nextSequence_ = packets_.begin()->first;
+        } else if (packets_.begin()->first > nextSequence_) {
+            stats_.packetsLost += packets_.begin()->first - nextSequence_;
+            nextSequence_ = packets_.begin()->first;
+        }
+    }
+
+    size_t written = 0;
+    while (written < count) {
+        if (pendingOffset_ == pending_.size()) {
+            produceFrame();
+            continue;
+        }
+        size_t n = std::min(count - written, pending_.size() - pendingOffset_);
+        std::copy_n(pending_.data() + pendingOffset_, n, pcm + written);
+        pendingOffset_ += n;
+        written += n;
+    }
+    return true;
+}
+
+bool JitterBuffer::pull(opus_int16* pcm, int frames) {
+    convert_.resize(static_cast<size_t>(frames) * session_.channels());
+    bool playing = pull(convert_.data(), frames);
+    for (size_t i = 0; i < convert_.size(); i++) {
+        pcm[i] = floatToInt16(convert_[i]);
+    }
+    return playing;
+}
+
+JitterBufferStats JitterBuffer::stats() const {
+    JitterBufferStats stats = stats_;
+    stats.targetDelayMs = targetDelayMs();
+    stats.currentDelayMs = bufferedMs();
+    stats.concealmentRatio = samplesProduced_ ? double(samplesConcealed_) / samplesProduced_ : 0;
+    stats.bufferedPackets = packets_.size();
+    return stats;
+}
+
+void JitterBuffer::reset() {
+    packets_.clear();
+    bufferedFrames_ = 0;
+    pending_.clear();
+    pendingOffset_ = 0;
+    playing_ = false;
+    nextSequence_ = -1;
+    highestSequence_ = -1;
+    lastFrames_ = session_.sampleRate() / 50;
+    underrunFrames_ = 0;
+    dredSequence_ = -1;
+    haveTransit_ = false;
+    stats_.jitterMs = 0;
+    session_.reset();
+}
+
+} // namespace rnopus
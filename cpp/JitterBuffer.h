@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "DecoderSession.h"
+
+namespace rnopus {
+
+struct JitterBufferConfig {
+    int minDelayMs = 20;
+    int maxDelayMs = 400;
+    // Rebuild lost packets from DRED when FEC cannot (see DecodeOptions::dred)
+    bool dred = false;
+};
+
+struct JitterBufferStats {
+    uint64_t packetsReceived = 0;
+    uint64_t packetsDecoded = 0;
+    uint64_t packetsLate = 0;       // Arrived after their playout time
+    uint64_t packetsDuplicate = 0;
+    uint64_t packetsLost = 0;       // Never arrived in time
+    uint64_t packetsRecovered = 0;  // Lost, rebuilt from in-band FEC
+    uint64_t packetsDredRecovered = 0; // Lost, rebuilt from DRED
+    uint64_t packetsConcealed = 0;  // Lost or undecodable, filled by PLC
+    uint64_t packetsDropped = 0;    // Discarded to bring the delay down
+    uint64_t underruns = 0;         // Pulls that found the buffer empty
+    double jitterMs = 0;            // RFC 3550 interarrival jitter
+    double targetDelayMs = 0;
+    double currentDelayMs = 0;      // Audio buffered ahead of the playout point
+    double concealmentRatio = 0;    // Share of the output not decoded from its own packet
+    size_t bufferedPackets = 0;
+};
+
+// Reorders packets by sequence number, holds them for a delay that follows
+// the measured jitter, and plays them out as fixed-size PCM pulls. Packets
+// that miss their turn are rebuilt from FEC or concealed. Owns its decoder;
+// not thread safe, callers serialize access.
+class JitterBuffer {
+public:
+    // Throws std::runtime_error for an unsupported rate or channel count.
+    JitterBuffer(opus_int32 sampleRate, int channels, const JitterBufferConfig& config = {});
+
+    // `sequence` is the 16-bit RTP sequence number. `timestamp` is in 48 kHz
+    // units (the Opus RTP clock), or negative to derive it from the sequence
+    // number. `arrivalMs` is the local receive time on a monotonic clock.
+    void push(uint32_t sequence, int64_t timestamp, const uint8_t* data, size_t size, double arrivalMs);
+
+    // Writes exactly `frames` samples per channel. Returns false (and
+    // silence) while the initial delay is still building up.
+    bool pull(float* pcm, int frames);
+    bool pull(opus_int16* pcm, int frames);
+
+    JitterBufferStats stats() const;
+
+    // Drops every buffered packet and the decoder history; stats are kept.
+    void reset();
+
+    opus_int32 sampleRate() const { return session_.sampleRate(); }
+    int channels() const { return session_.channels(); }
+
+private:
+    struct Packet {
+        std::vector<uint8_t> data;
+        int frames;
+    };
+
+    int64_t unwrap(uint32_t sequence) const;
+    void updateJitter(int64_t timestamp, double arrivalMs);
+    void produceFrame();
+    void erase(std::map<int64_t, Packet>::iterator it);
+    double framesToMs(int64_t frames) const { return 1000.0 * frames / session_.sampleRate(); }
+    double bufferedMs() const;
+    double targetDelayMs() const;
+
+    DecoderSession session_;
+    JitterBufferConfig config_;
+    std::map<int64_t, Packet> packets_; // By extended sequence number
+    int64_t bufferedFrames_ = 0;        // Sum over packets_
+
+    // Decoded audio not yet handed out
+    std::vector<float> pending_;
+    size_t pendingOffset_ = 0;
+    std::vector<float> convert_; // Scratch for int16 pulls
+
+    bool playing_ = false;
+    int64_t nextSequence_ = -1;
+    int64_t highestSequence_ = -1;
+    int lastFrames_;
+    int64_t underrunFrames_ = 0; // Concealed since the buffer ran dry
+    int64_t dredSequence_ = -1;  // Packet whose DRED data is loaded
+    DredCoverage dredCoverage_;
+
+    bool haveTransit_ = false;
+    double lastTransitMs_ = 0;
+
+    JitterBufferStats stats_;
+    uint64_t samplesProduced_ = 0;
+    uint64_t samplesConcealed_ = 0;
+};
+
+} // namespace rnopus
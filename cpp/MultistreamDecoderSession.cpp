@@ -0,0 +1,211 @@
+#include "MultistreamDecoderSession.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+namespace rnopus {
+
+namespace {
+
+// RFC 7845 section 5.1.1.2: streams, coupled streams and mapping table for
+// 1 to 8 channels in Vorbis order
+struct VorbisLayout {
+    int streams;
+    int coupled;
+    uint8_t mapping[8];
+};
+
+constexpr VorbisLayout kVorbisLayouts[8] = {
+    {1, 0, {0}},
+    {1, 1, {0, 1}},
+    {2, 1, {0, 2, 1}},
+    {2, 2, {0, 1, 2, 3}},
+    {3, 2, {0, 4, 1, 2, 3}},
+    {4, 2, {0, 4, 1, 2, 3, 5}},
+    {4, 3, {0, 4, 1, 2, 3, 5, 6}},
+    {5, 3, {0, 6, 1, 2, 3, 4, 5, 7}},
+};
+
+int decodeFrame(OpusMSDecoder* decoder, const uint8_t* data, size_t size, opus_int16* pcm, int frames) {
+    return opus_multistream_decode(decoder, data, static_cast<opus_int32>(size), pcm, frames, 0);
+}
+
+int decodeFrame(OpusMSDecoder* decoder, const uint8_t* data, size_t size, float* pcm, int frames) {
+    return opus_multistream_decode_float(decoder, data, static_cast<opus_int32>(size), pcm, frames, 0);
+}
+
+// Reorders interleaved samples into one contiguous block per channel
+template <typename Sample>
+void deinterleave(std::vector<Sample>& pcm, int channels) {
+    if (channels == 1 || pcm.empty()) {
+        return;
+    }
+    const size_t frames = pcm.size() / channels;
+    std::vector<Sample> planar(pcm.size());
+    for (int channel = 0; channel < channels; channel++) {
+        Sample* out = planar.data() + channel * frames;
+        const Sample* in = pcm.data() + channel;
+        for (size_t i = 0; i < frames; i++) {
+            out[i] = in[i * channels];
+        }
+    }
+    pcm.swap(planar);
+}
+
+} // namespace
+
+OpusHead defaultChannelLayout(int channels, int mappingFamily) {
+    OpusHead head;
+    head.channels = channels;
+    head.mappingFamily = mappingFamily;
+    if (mappingFamily == 0 && (channels == 1 || channels == 2)) {
+        head.streamCount = 1;
+        head.coupledCount = channels - 1;
+        head.mapping = channels == 1 ? std::vector<uint8_t>{0} : std::vector<uint8_t>{0, 1};
+        return head;
+    }
+    if (mappingFamily == 1 && channels >= 1 && channels <= 8) {
+        const VorbisLayout& layout = kVorbisLayouts[channels - 1];
+        head.streamCount = layout.streams;
+        head.coupledCount = layout.coupled;
+        head.mapping.assign(layout.mapping, layout.mapping + channels);
+        return head;
+    }
+    throw std::invalid_argument("No default layout for " + std::to_string(channels) +
+                                " channels in mapping family " + std::to_string(mappingFamily));
+}
+
+MultistreamDecoderSession::MultistreamDecoderSession(opus_int32 sampleRate, const OpusHead& head)
+    : sampleRate_(sampleRate),
+      channels_(head.channels),
+      streamCount_(head.streamCount),
+      coupledCount_(head.coupledCount),
+      lastPacketFrames_(sampleRate / 50) {
+    if (head.mapping.size() != static_cast<size_t>(head.channels)) {
+        throw std::runtime_error("Channel mapping needs one entry per channel");
+    }
+
+    int error = 0;
+    decoder_ = opus_multistream_decoder_create(sampleRate, head.channels, head.streamCount, head.coupledCount,
+                                               head.mapping.data(), &error);
+    if (error != OPUS_OK || !decoder_) {
+        throw std::runtime_error(std::string("Failed to create Opus multistream decoder: ") + opus_strerror(error));
+    }
+    if (head.outputGain != 0) {
+        opus_multistream_decoder_ctl(decoder_, OPUS_SET_GAIN(head.outputGain));
+    }
+}
+
+MultistreamDecoderSession::~MultistreamDecoderSession() {
+    if (decoder_) {
+        opus_multistream_decoder_destroy(decoder_);
+    }
+}
+
+DecodeResult MultistreamDecoderSession::decode(const uint8_t* input, size_t inputSize, const FramingOptions& framing,
+                                               const DecodeOptions& options, bool planar) {
+    PacketList list = splitPackets(input, inputSize, framing);
+    return decode(list.packets, options, planar);
+}
+
+DecodeResult MultistreamDecoderSession::decode(const std::vector<PacketView>& packets, const DecodeOptions& options,
+                                               bool planar) {
+    if (!options.sequenceNumbers.empty() || options.dred) {
+        throw std::invalid_argument("sequenceNumbers and dred are not supported for multistream decoding");
+    }
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    DecodeResult decoded;
+    decoded.format = options.format;
+    if (options.format == SampleFormat::Float32) {
+        decodeAll(packets, options.concealLoss, decoded.pcmFloat, decoded);
+        if (planar) {
+            deinterleave(decoded.pcmFloat, channels_);
+        }
+    } else {
+        decodeAll(packets, options.concealLoss, decoded.pcm, decoded);
+        if (planar) {
+            deinterleave(decoded.pcm, channels_);
+        }
+    }
+
+    decoded.outputSamples = decoded.samplesDecoded;
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    decoded.processingTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+    stats_.decodeCalls++;
+    stats_.packetsDecoded += decoded.packetsDecoded;
+    stats_.packetsConcealed += decoded.packetsConcealed;
+    stats_.samplesDecoded += decoded.samplesDecoded;
+    stats_.samplesConcealed += decoded.samplesConcealed;
+    stats_.processingTimeMs += decoded.processingTimeMs;
+    return decoded;
+}
+
+template <typename Sample>
+void MultistreamDecoderSession::decodeAll(const std::vector<PacketView>& packets, bool concealLoss,
+                                          std::vector<Sample>& pcm, DecodeResult& decoded) {
+    // Every stream in a packet has the same duration, so the TOC of the
+    // first one sizes the output exactly, as in DecoderSession.
+    std::vector<int> frames(packets.size(), 0);
+    size_t totalFrames = 0;
+    for (size_t i = 0; i < packets.size(); i++) {
+        const PacketView& packet = packets[i];
+        int packetFrames = packet.size == 0
+            ? OPUS_INVALID_PACKET
+            : opus_packet_get_nb_samples(packet.data, static_cast<opus_int32>(packet.size), sampleRate_);
+        if (packetFrames > 0) {
+            lastPacketFrames_ = packetFrames;
+        } else if (concealLoss) {
+            packetFrames = lastPacketFrames_;
+        } else {
+            packetFrames = 0;
+        }
+        frames[i] = packetFrames;
+        totalFrames += packetFrames;
+    }
+
+    pcm.resize(totalFrames * channels_);
+    size_t offset = 0; // In frames
+
+    for (size_t i = 0; i < packets.size(); i++) {
+        if (frames[i] == 0) {
+            continue;
+        }
+        const PacketView& packet = packets[i];
+        Sample* out = pcm.data() + offset * channels_;
+
+        int samples = packet.size == 0 ? OPUS_INVALID_PACKET : decodeFrame(decoder_, packet.data, packet.size, out, frames[i]);
+        if (samples >= 0) {
+            decoded.packetsDecoded++;
+        } else {
+            if (packet.size != 0) {
+                stats_.packetsFailed++;
+            }
+            if (!concealLoss) {
+                continue;
+            }
+            samples = decodeFrame(decoder_, nullptr, 0, out, frames[i]);
+            if (samples < 0) {
+                std::fill(out, out + frames[i] * channels_, Sample(0));
+                samples = frames[i];
+            }
+            decoded.packetsConcealed++;
+            decoded.samplesConcealed += samples;
+            decoded.gaps.push_back(static_cast<int64_t>(i));
+        }
+        offset += samples;
+        decoded.samplesDecoded += samples;
+    }
+    pcm.resize(offset * channels_);
+}
+
+int MultistreamDecoderSession::reset() {
+    lastPacketFrames_ = sampleRate_ / 50;
+    return opus_multistream_decoder_ctl(decoder_, OPUS_RESET_STATE);
+}
+
+} // namespace rnopus
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DecoderSession.h"
+#include "OggOpusReader.h"
+
+#if __has_include("opus/opus_multistream.h")
+#include "opus/opus_multistream.h"
+#elif __has_include("opus_multistream.h")
+#include "opus_multistream.h"
+#else
+#error "Could not find opus_multistream.h"
+#endif
+
+namespace rnopus {
+
+// Stream layout for `channels` under mapping family 0 (mono/stereo) or 1
+// (Vorbis channel order, 1 to 8 channels: mono, stereo, LCR, quad, 5.0,
+// 5.1, 6.1, 7.1), as an encoder would write it into the OpusHead. Family
+// 255 has no default; its layout must be given. Throws
+// std::invalid_argument for anything else.
+OpusHead defaultChannelLayout(int channels, int mappingFamily);
+
+// An OpusMSDecoder for multistream packets: several mono or coupled Opus
+// streams whose decoded channels are routed by a mapping table (RFC 7845
+// section 5.1.1). Not thread safe; callers serialize access per session.
+class MultistreamDecoderSession {
+public:
+    // Takes the layout from `head` (channels, streamCount, coupledCount,
+    // mapping) and applies its output gain. Any Opus output rate. Throws
+    // std::runtime_error if libopus rejects the layout.
+    MultistreamDecoderSession(opus_int32 sampleRate, const OpusHead& head);
+    ~MultistreamDecoderSession();
+
+    MultistreamDecoderSession(const MultistreamDecoderSession&) = delete;
+    MultistreamDecoderSession& operator=(const MultistreamDecoderSession&) = delete;
+
+    // Decodes every packet in order. PCM is interleaved, or with `planar`
+    // one block of samplesDecoded samples per channel, in output channel
+    // order. With concealLoss, zero-length and undecodable packets are
+    // concealed (PLC); otherwise they are skipped. sequenceNumbers and dred
+    // are not supported here.
+    DecodeResult decode(const std::vector<PacketView>& packets, const DecodeOptions& options, bool planar);
+    DecodeResult decode(const uint8_t* input, size_t inputSize, const FramingOptions& framing,
+                        const DecodeOptions& options, bool planar);
+
+    // Drops the decoder history (OPUS_RESET_STATE). Returns an Opus error code.
+    int reset();
+
+    opus_int32 sampleRate() const { return sampleRate_; }
+    int channels() const { return channels_; }
+    int streamCount() const { return streamCount_; }
+    int coupledCount() const { return coupledCount_; }
+    const DecoderStats& stats() const { return stats_; }
+
+private:
+    template <typename Sample>
+    void decodeAll(const std::vector<PacketView>& packets, bool concealLoss, std::vector<Sample>& pcm,
+                   DecodeResult& decoded);
+
+    OpusMSDecoder* decoder_ = nullptr;
+    opus_int32 sampleRate_;
+    int channels_;
+    int streamCount_;
+    int coupledCount_;
+    int lastPacketFrames_;
+    DecoderStats stats_;
+};
+
+} // namespace rnopus
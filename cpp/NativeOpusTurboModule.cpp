@@ -1,289 +1,1932 @@
 #include "NativeOpusTurboModule.h"
+#include "Base64.h"
+#include "BatchDecoder.h"
+#include "ThreadPool.h"
+#include "DecoderSession.h"
+#include "EncoderSession.h"
+#include "FileTranscoder.h"
+#include "JitterBuffer.h"
+#include "MappedFile.h"
+#include "MultistreamDecoderSession.h"
+#include "ProjectionDecoderSession.h"
+#include "Repacketizer.h"
+#include "OggOpusReader.h"
+#include "PcmRingBuffer.h"
+#include "StreamDecoder.h"
+#include "StreamEncoder.h"
+#include "WavWriter.h"
 #include <stdexcept> // For runtime_error
 #include <chrono> // For timing
 #include <vector> // Ensure vector is included
+#include <algorithm> // For std::min
+#include <memory> // For shared_ptr
+#include <functional>
+#include <cstring> // For memcpy
 
 namespace facebook::react {
 
-// Constructor: Create the single decoder instance
-NativeOpusTurboModule::NativeOpusTurboModule(std::shared_ptr<CallInvoker> jsinvoker)
-    : NativeOpusTurboModuleCxxSpec(std::move(jsinvoker)) {
-    int error = 0;
-    opusDecoder = opus_decoder_create(DEFAULT_SAMPLE_RATE, DEFAULT_CHANNELS, &error);
-    if (error != OPUS_OK || !opusDecoder) {
-        // Handle error appropriately - maybe log or throw an exception
-        // For now, we'll leave it null, and methods will check
-        opusDecoder = nullptr;
-        // Consider logging: fprintf(stderr, "Failed to create Opus decoder: %s\n", opus_strerror(error));
+namespace {
+
+// Hands a native output vector (PCM, or encoded packets) to JS without
+// copying it. The ArrayBuffer keeps this object alive for as long as JS holds
+// a view on it.
+template <typename Sample>
+class PcmBuffer : public jsi::MutableBuffer {
+public:
+    explicit PcmBuffer(std::vector<Sample> samples) : samples_(std::move(samples)) {}
+
+    size_t size() const override {
+        return samples_.size() * sizeof(Sample);
+    }
+
+    uint8_t* data() override {
+        return reinterpret_cast<uint8_t*>(samples_.data());
+    }
+
+private:
+    std::vector<Sample> samples_;
+};
+
+// Resolves an ArrayBuffer or any ArrayBuffer view (Uint8Array, DataView, ...)
+// to the bytes it covers, without copying.
+void getPacketBytes(jsi::Runtime &rt, const jsi::Object &packets, const uint8_t*& data, size_t& size) {
+    if (packets.isArrayBuffer(rt)) {
+        jsi::ArrayBuffer buffer = packets.getArrayBuffer(rt);
+        data = buffer.data(rt);
+        size = buffer.size(rt);
+        return;
     }
+
+    jsi::Value bufferValue = packets.getProperty(rt, "buffer");
+    if (!bufferValue.isObject() || !bufferValue.getObject(rt).isArrayBuffer(rt)) {
+        throw std::invalid_argument("Expected an ArrayBuffer or a typed array");
+    }
+    jsi::ArrayBuffer buffer = bufferValue.getObject(rt).getArrayBuffer(rt);
+    size_t byteOffset = static_cast<size_t>(packets.getProperty(rt, "byteOffset").asNumber());
+    size_t byteLength = static_cast<size_t>(packets.getProperty(rt, "byteLength").asNumber());
+    if (byteOffset + byteLength > buffer.size(rt)) {
+        throw std::out_of_range("Typed array view exceeds its buffer");
+    }
+    data = buffer.data(rt) + byteOffset;
+    size = byteLength;
 }
 
-// Destructor: Clean up the decoder
-NativeOpusTurboModule::~NativeOpusTurboModule() {
-    if (opusDecoder) {
-        opus_decoder_destroy(opusDecoder);
-        opusDecoder = nullptr;
-    }
-}
-
-// Base64 encoding/decoding utility methods
-std::string NativeOpusTurboModule::base64_encode(const std::vector<uint8_t>& input) {
-    static const char* encoding_table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    static const int mod_table[] = {0, 2, 1};
-    
-    size_t input_length = input.size();
-    size_t output_length = 4 * ((input_length + 2) / 3);
-    
-    std::string encoded_data(output_length, '\0');
-    size_t i, j;
-    
-    for (i = 0, j = 0; i < input_length;) {
-        uint32_t octet_a = i < input_length ? input[i++] : 0;
-        uint32_t octet_b = i < input_length ? input[i++] : 0;
-        uint32_t octet_c = i < input_length ? input[i++] : 0;
-        
-        uint32_t triple = (octet_a << 16) + (octet_b << 8) + octet_c;
-        
-        encoded_data[j++] = encoding_table[(triple >> 18) & 0x3F];
-        encoded_data[j++] = encoding_table[(triple >> 12) & 0x3F];
-        encoded_data[j++] = encoding_table[(triple >> 6) & 0x3F];
-        encoded_data[j++] = encoding_table[triple & 0x3F];
-    }
-    
-    for (i = 0; i < mod_table[input_length % 3]; i++)
-        encoded_data[output_length - 1 - i] = '=';
-    
-    return encoded_data;
+// Reads DecodeOptions: {framing?, packetSize?, lengths?}. Framing defaults
+// to "fixed", which needs packetSize.
+rnopus::FramingOptions parseFramingOptions(jsi::Runtime &rt, const jsi::Object &options) {
+    rnopus::FramingOptions framing;
+    jsi::Value framingName = options.getProperty(rt, "framing");
+    if (framingName.isString()) {
+        framing.framing = rnopus::parseFraming(framingName.getString(rt).utf8(rt));
+    }
+
+    jsi::Value packetSize = options.getProperty(rt, "packetSize");
+    if (packetSize.isNumber()) {
+        framing.packetSize = static_cast<int>(packetSize.getNumber());
+    }
+
+    if (framing.framing == rnopus::Framing::Lengths) {
+        jsi::Value lengthsValue = options.getProperty(rt, "lengths");
+        if (!lengthsValue.isObject() || !lengthsValue.getObject(rt).isArray(rt)) {
+            throw std::invalid_argument("lengths framing requires a lengths array");
+        }
+        jsi::Array lengths = lengthsValue.getObject(rt).getArray(rt);
+        size_t count = lengths.size(rt);
+        framing.lengths.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            double length = lengths.getValueAtIndex(rt, i).asNumber();
+            if (length < 0) {
+                throw std::invalid_argument("Packet lengths must not be negative");
+            }
+            framing.lengths.push_back(static_cast<uint32_t>(length));
+        }
+    }
+
+    return framing;
 }
 
-std::vector<uint8_t> NativeOpusTurboModule::base64_decode(const std::string& input) {
-    static const int decoding_table[256] = {
-        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-        -1, -1, -1, 62, -1, -1, -1, 63, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1,
-        -1, -1, -1, -1, -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
-        15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1, -1, 26, 27, 28,
-        29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48,
-        49, 50, 51, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+// Reads `outputFormat`: "int16" (default) or "float32".
+rnopus::SampleFormat parseSampleFormat(jsi::Runtime &rt, const jsi::Object &options) {
+    jsi::Value outputFormat = options.getProperty(rt, "outputFormat");
+    if (outputFormat.isString()) {
+        return rnopus::parseSampleFormat(outputFormat.getString(rt).utf8(rt));
+    }
+    return rnopus::SampleFormat::Int16;
+}
+
+// Reads the per-call decode settings: outputFormat, concealLoss, dred and
+// sequenceNumbers.
+rnopus::DecodeOptions parseDecodeOptions(jsi::Runtime &rt, const jsi::Object &options) {
+    rnopus::DecodeOptions decodeOptions;
+    decodeOptions.format = parseSampleFormat(rt, options);
+
+    jsi::Value concealLoss = options.getProperty(rt, "concealLoss");
+    decodeOptions.concealLoss = concealLoss.isBool() && concealLoss.getBool();
+    jsi::Value dred = options.getProperty(rt, "dred");
+    decodeOptions.dred = dred.isBool() && dred.getBool();
+
+    jsi::Value sequenceValue = options.getProperty(rt, "sequenceNumbers");
+    if (sequenceValue.isObject() && sequenceValue.getObject(rt).isArray(rt)) {
+        jsi::Array sequence = sequenceValue.getObject(rt).getArray(rt);
+        size_t count = sequence.size(rt);
+        decodeOptions.sequenceNumbers.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            decodeOptions.sequenceNumbers.push_back(static_cast<uint32_t>(sequence.getValueAtIndex(rt, i).asNumber()));
+        }
+    }
+    return decodeOptions;
+}
+
+// Reads EncoderConfig: sampleRate and channels, plus optional application,
+// bitrate, vbr, constrainedVbr, complexity, fec, packetLossPercent, dtx and
+// frameDurationMs.
+rnopus::EncoderConfig parseEncoderConfig(jsi::Runtime &rt, const jsi::Object &config) {
+    rnopus::EncoderConfig encoderConfig;
+    encoderConfig.sampleRate = static_cast<opus_int32>(config.getProperty(rt, "sampleRate").asNumber());
+    encoderConfig.channels = static_cast<int>(config.getProperty(rt, "channels").asNumber());
+
+    jsi::Value application = config.getProperty(rt, "application");
+    if (application.isString()) {
+        encoderConfig.application = rnopus::parseApplication(application.getString(rt).utf8(rt));
+    }
+    auto readInt = [&](const char* name, int& target) {
+        jsi::Value value = config.getProperty(rt, name);
+        if (value.isNumber()) {
+            target = static_cast<int>(value.getNumber());
+        }
     };
-    
-    size_t input_length = input.size();
-    if (input_length % 4 != 0) return {};
-    
-    size_t output_length = input_length / 4 * 3;
-    if (input.length() >= 1 && input[input_length - 1] == '=') output_length--;
-    if (input.length() >= 2 && input[input_length - 2] == '=') output_length--;
-    
-    std::vector<uint8_t> decoded_data(output_length);
-    
-    for (size_t i = 0, j = 0; i < input_length;) {
-        uint32_t sextet_a = input[i] == '=' ? 0 & i++ : decoding_table[static_cast<int>(input[i++])];
-        uint32_t sextet_b = input[i] == '=' ? 0 & i++ : decoding_table[static_cast<int>(input[i++])];
-        uint32_t sextet_c = input[i] == '=' ? 0 & i++ : decoding_table[static_cast<int>(input[i++])];
-        uint32_t sextet_d = input[i] == '=' ? 0 & i++ : decoding_table[static_cast<int>(input[i++])];
-        
-        uint32_t triple = (sextet_a << 18) + (sextet_b << 12) + (sextet_c << 6) + sextet_d;
-        
-        if (j < output_length) decoded_data[j++] = (triple >> 16) & 0xFF;
-        if (j < output_length) decoded_data[j++] = (triple >> 8) & 0xFF;
-        if (j < output_length) decoded_data[j++] = triple & 0xFF;
-    }
-    
-    return decoded_data;
+    auto readBool = [&](const char* name, bool& target) {
+        jsi::Value value = config.getProperty(rt, name);
+        if (value.isBool()) {
+            target = value.getBool();
+        }
+    };
+    readInt("bitrate", encoderConfig.bitrate);
+    readBool("vbr", encoderConfig.vbr);
+    readBool("constrainedVbr", encoderConfig.constrainedVbr);
+    readInt("complexity", encoderConfig.complexity);
+    readBool("fec", encoderConfig.fec);
+    readInt("packetLossPercent", encoderConfig.packetLossPercent);
+    readBool("dtx", encoderConfig.dtx);
+    jsi::Value frameDurationMs = config.getProperty(rt, "frameDurationMs");
+    if (frameDurationMs.isNumber()) {
+        encoderConfig.frameDurationMs = frameDurationMs.getNumber();
+    }
+    return encoderConfig;
 }
 
-// Modified decodeMultipleOpusPackets (Base64 version)
-jsi::Value NativeOpusTurboModule::decodeMultipleOpusPackets(jsi::Runtime &rt, std::string packetsBase64, double packetSize) {
-    int packetSizeInt = (int)packetSize;
-    jsi::Object result = jsi::Object(rt);
+// Reads the optional `outputSampleRate` and `resampleQuality` ("low",
+// "medium" (default) or "high") of a decoder config. Returns 0 when no
+// output rate is set.
+int parseOutputRate(jsi::Runtime &rt, const jsi::Object &config, rnopus::ResamplerQuality& quality) {
+    jsi::Value outputRate = config.getProperty(rt, "outputSampleRate");
+    if (!outputRate.isNumber()) {
+        return 0;
+    }
+    jsi::Value qualityName = config.getProperty(rt, "resampleQuality");
+    if (qualityName.isString()) {
+        quality = rnopus::parseResamplerQuality(qualityName.getString(rt).utf8(rt));
+    }
+    return static_cast<int>(outputRate.getNumber());
+}
+
+void configureResampling(jsi::Runtime &rt, const jsi::Object &config, rnopus::DecoderSession& session) {
+    rnopus::ResamplerQuality quality = rnopus::ResamplerQuality::Medium;
+    int outputRate = parseOutputRate(rt, config, quality);
+    if (outputRate > 0) {
+        session.setOutputRate(outputRate, quality);
+    }
+}
+
+// Snapshots one entry of a decodeOpusBatch call. Per-stream `sampleRate`,
+// `channels`, `outputSampleRate` and `resampleQuality` override the batch
+// options; framing and decode options are per stream only.
+rnopus::BatchStream parseBatchStream(jsi::Runtime &rt, const jsi::Object &stream, const rnopus::BatchStream& defaults) {
+    rnopus::BatchStream parsed;
+    const uint8_t* bytes = nullptr;
+    size_t size = 0;
+    getPacketBytes(rt, stream.getProperty(rt, "packets").asObject(rt), bytes, size);
+    parsed.packets.assign(bytes, bytes + size);
+    parsed.framing = parseFramingOptions(rt, stream);
+    parsed.options = parseDecodeOptions(rt, stream);
+
+    jsi::Value sampleRate = stream.getProperty(rt, "sampleRate");
+    parsed.sampleRate = sampleRate.isNumber() ? static_cast<opus_int32>(sampleRate.getNumber()) : defaults.sampleRate;
+    jsi::Value channels = stream.getProperty(rt, "channels");
+    parsed.channels = channels.isNumber() ? static_cast<int>(channels.getNumber()) : defaults.channels;
+    parsed.quality = defaults.quality;
+    int outputRate = parseOutputRate(rt, stream, parsed.quality);
+    parsed.outputRate = outputRate > 0 ? outputRate : defaults.outputRate;
+    return parsed;
+}
+
+// Reads a multistream layout: the bytes of an `opusHead`, or `channels`
+// with an optional `mappingFamily` (default 0 up to stereo, 1 above) and,
+// for family 255 or a non-default layout, `streamCount`, `coupledCount`
+// and `mapping`.
+rnopus::OpusHead parseChannelLayout(jsi::Runtime &rt, const jsi::Object &config) {
+    jsi::Value opusHead = config.getProperty(rt, "opusHead");
+    if (opusHead.isObject()) {
+        const uint8_t* headBytes = nullptr;
+        size_t headSize = 0;
+        getPacketBytes(rt, opusHead.getObject(rt), headBytes, headSize);
+        return rnopus::parseOpusHead(headBytes, headSize);
+    }
+
+    int channels = static_cast<int>(config.getProperty(rt, "channels").asNumber());
+    jsi::Value family = config.getProperty(rt, "mappingFamily");
+    int mappingFamily = family.isNumber() ? static_cast<int>(family.getNumber()) : (channels <= 2 ? 0 : 1);
+    jsi::Value mappingValue = config.getProperty(rt, "mapping");
+    if (!mappingValue.isObject()) {
+        return rnopus::defaultChannelLayout(channels, mappingFamily);
+    }
+
+    rnopus::OpusHead head;
+    head.channels = channels;
+    head.mappingFamily = mappingFamily;
+    head.streamCount = static_cast<int>(config.getProperty(rt, "streamCount").asNumber());
+    head.coupledCount = static_cast<int>(config.getProperty(rt, "coupledCount").asNumber());
+    jsi::Array mapping = mappingValue.getObject(rt).getArray(rt);
+    size_t count = mapping.size(rt);
+    head.mapping.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        head.mapping.push_back(static_cast<uint8_t>(mapping.getValueAtIndex(rt, i).asNumber()));
+    }
+    return head;
+}
+
+// Reads an ambisonic layout: the bytes of a family 3 `opusHead`, or
+// `channels`, `streamCount`, `coupledCount` and the `demixingMatrix` gains.
+rnopus::OpusHead parseProjectionLayout(jsi::Runtime &rt, const jsi::Object &config) {
+    jsi::Value opusHead = config.getProperty(rt, "opusHead");
+    if (opusHead.isObject()) {
+        const uint8_t* headBytes = nullptr;
+        size_t headSize = 0;
+        getPacketBytes(rt, opusHead.getObject(rt), headBytes, headSize);
+        rnopus::OpusHead head = rnopus::parseOpusHead(headBytes, headSize);
+        if (head.mappingFamily != 3) {
+            throw std::invalid_argument("Projection decoding needs channel mapping family 3");
+        }
+        return head;
+    }
 
-    if (!opusDecoder) {
+    rnopus::OpusHead head;
+    head.channels = static_cast<int>(config.getProperty(rt, "channels").asNumber());
+    head.mappingFamily = 3;
+    head.streamCount = static_cast<int>(config.getProperty(rt, "streamCount").asNumber());
+    head.coupledCount = static_cast<int>(config.getProperty(rt, "coupledCount").asNumber());
+    jsi::Array matrix = config.getProperty(rt, "demixingMatrix").asObject(rt).getArray(rt);
+    size_t count = matrix.size(rt);
+    head.demixingMatrix.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        head.demixingMatrix.push_back(static_cast<int16_t>(matrix.getValueAtIndex(rt, i).asNumber()));
+    }
+    return head;
+}
+
+// Reads custom `binauralFilters` (a Float32Array laid out as in
+// BinauralFilters) of `binauralFilterLength` taps. No filters means the
+// built-in defaults.
+rnopus::BinauralFilters parseBinauralFilters(jsi::Runtime &rt, const jsi::Object &config) {
+    rnopus::BinauralFilters filters;
+    jsi::Value tapsValue = config.getProperty(rt, "binauralFilters");
+    if (!tapsValue.isObject()) {
+        return filters;
+    }
+    jsi::Object taps = tapsValue.getObject(rt);
+    if (!taps.instanceOf(rt, rt.global().getPropertyAsFunction(rt, "Float32Array"))) {
+        throw std::invalid_argument("binauralFilters must be a Float32Array");
+    }
+    const uint8_t* bytes = nullptr;
+    size_t size = 0;
+    getPacketBytes(rt, taps, bytes, size);
+    filters.length = static_cast<int>(config.getProperty(rt, "binauralFilterLength").asNumber());
+    if (filters.length <= 0) {
+        throw std::invalid_argument("binauralFilterLength must be positive");
+    }
+    filters.taps.resize(size / sizeof(float));
+    std::memcpy(filters.taps.data(), bytes, filters.taps.size() * sizeof(float));
+    filters.channels = static_cast<int>(filters.taps.size() / (2 * size_t(filters.length)));
+    return filters;
+}
+
+// Resolve/reject pair of a JS promise. Only touched on the JS thread; worker
+// threads settle it through the CallInvoker.
+struct PromiseHandle {
+    jsi::Function resolve;
+    jsi::Function reject;
+};
+
+jsi::Value makePromise(jsi::Runtime &rt, std::function<void(std::shared_ptr<PromiseHandle>)> executor) {
+    jsi::Function promiseCtor = rt.global().getPropertyAsFunction(rt, "Promise");
+    return promiseCtor.callAsConstructor(rt, jsi::Function::createFromHostFunction(
+        rt,
+        jsi::PropNameID::forAscii(rt, "executor"),
+        2,
+        [executor = std::move(executor)](jsi::Runtime &rt, const jsi::Value&, const jsi::Value* args, size_t) -> jsi::Value {
+            executor(std::make_shared<PromiseHandle>(PromiseHandle{
+                args[0].getObject(rt).getFunction(rt),
+                args[1].getObject(rt).getFunction(rt),
+            }));
+            return jsi::Value::undefined();
+        }));
+}
+
+// Settles the promise on the JS thread with the value `builder` produces
+// there. Callers pass their only reference so the JS functions are never
+// released off the JS thread.
+void settlePromise(const std::shared_ptr<CallInvoker>& jsInvoker, std::shared_ptr<PromiseHandle> promise, NativeOpusTurboModule::ResultBuilder builder) {
+    jsInvoker->invokeAsync([promise = std::move(promise), builder = std::move(builder)](jsi::Runtime &rt) {
+        try {
+            promise->resolve.call(rt, builder(rt));
+        } catch (const std::exception& e) {
+            promise->reject.call(rt, jsi::String::createFromUtf8(rt, e.what()));
+        }
+    });
+}
+
+NativeOpusTurboModule::ResultBuilder errorResult(std::string message) {
+    return [message = std::move(message)](jsi::Runtime &rt) -> jsi::Value {
+        jsi::Object result = jsi::Object(rt);
         result.setProperty(rt, "success", false);
-        result.setProperty(rt, "error", jsi::String::createFromUtf8(rt, "Decoder not initialized"));
+        result.setProperty(rt, "error", jsi::String::createFromUtf8(rt, message));
+        return result;
+    };
+}
+
+NativeOpusTurboModule::ResultBuilder successResult() {
+    return [](jsi::Runtime &rt) -> jsi::Value {
+        jsi::Object result = jsi::Object(rt);
+        result.setProperty(rt, "success", true);
+        return result;
+    };
+}
+
+NativeOpusTurboModule::ResultBuilder handleResult(int handle) {
+    return [handle](jsi::Runtime &rt) -> jsi::Value {
+        jsi::Object result = jsi::Object(rt);
+        result.setProperty(rt, "success", true);
+        result.setProperty(rt, "handle", handle);
+        return result;
+    };
+}
+
+// Wraps PCM in an Int16Array or Float32Array that starts `offset` samples
+// in. The vector moves into the ArrayBuffer; nothing is copied on the JS
+// thread.
+template <typename Sample>
+jsi::Value pcmArray(jsi::Runtime &rt, std::vector<Sample> pcm, const char* arrayType, size_t offset) {
+    size_t length = pcm.size() - offset;
+    jsi::ArrayBuffer buffer(rt, std::make_shared<PcmBuffer<Sample>>(std::move(pcm)));
+    jsi::Function constructor = rt.global().getPropertyAsFunction(rt, arrayType);
+    if (offset == 0) {
+        return constructor.callAsConstructor(rt, buffer);
+    }
+    return constructor.callAsConstructor(rt, buffer, static_cast<double>(offset * sizeof(Sample)), static_cast<double>(length));
+}
+
+jsi::Value pcmArray(jsi::Runtime &rt, std::vector<opus_int16> pcm, size_t offset = 0) {
+    return pcmArray(rt, std::move(pcm), "Int16Array", offset);
+}
+
+jsi::Value pcmArray(jsi::Runtime &rt, std::vector<float> pcm, size_t offset = 0) {
+    return pcmArray(rt, std::move(pcm), "Float32Array", offset);
+}
+
+// Resolves with the decoded PCM and the per-call counters
+NativeOpusTurboModule::ResultBuilder pcmResult(rnopus::DecodeResult decodedResult) {
+    auto decoded = std::make_shared<rnopus::DecodeResult>(std::move(decodedResult));
+    return [decoded](jsi::Runtime &rt) -> jsi::Value {
+        jsi::Value pcm = decoded->format == rnopus::SampleFormat::Float32
+            ? pcmArray(rt, std::move(decoded->pcmFloat), decoded->pcmOffset)
+            : pcmArray(rt, std::move(decoded->pcm), decoded->pcmOffset);
+
+        jsi::Object result = jsi::Object(rt);
+        result.setProperty(rt, "success", true);
+        result.setProperty(rt, "pcm", pcm);
+        result.setProperty(rt, "samplesDecoded", decoded->samplesDecoded);
+        result.setProperty(rt, "outputSamples", decoded->outputSamples);
+        result.setProperty(rt, "packetsDecoded", decoded->packetsDecoded);
+        result.setProperty(rt, "packetsConcealed", decoded->packetsConcealed);
+        result.setProperty(rt, "packetsRecovered", decoded->packetsRecovered);
+        result.setProperty(rt, "packetsDredRecovered", decoded->packetsDredRecovered);
+        result.setProperty(rt, "packetsLate", decoded->packetsLate);
+        result.setProperty(rt, "samplesRecovered", decoded->samplesRecovered);
+        result.setProperty(rt, "samplesConcealed", decoded->samplesConcealed);
+        jsi::Array gaps(rt, decoded->gaps.size());
+        for (size_t i = 0; i < decoded->gaps.size(); i++) {
+            gaps.setValueAtIndex(rt, i, static_cast<double>(decoded->gaps[i]));
+        }
+        result.setProperty(rt, "gaps", gaps);
+        result.setProperty(rt, "processingTimeMs", decoded->processingTimeMs);
+        return result;
+    };
+}
+
+// Resolves with one pcmResult or errorResult per stream, in input order
+NativeOpusTurboModule::ResultBuilder batchResult(std::vector<rnopus::BatchStreamResult> streamResults, double processingTimeMs) {
+    std::vector<NativeOpusTurboModule::ResultBuilder> builders;
+    builders.reserve(streamResults.size());
+    size_t failed = 0;
+    for (rnopus::BatchStreamResult& streamResult : streamResults) {
+        if (streamResult.error.empty()) {
+            builders.push_back(pcmResult(std::move(streamResult.decoded)));
+        } else {
+            builders.push_back(errorResult(std::move(streamResult.error)));
+            failed++;
+        }
+    }
+    return [builders = std::move(builders), failed, processingTimeMs](jsi::Runtime &rt) -> jsi::Value {
+        jsi::Array results(rt, builders.size());
+        for (size_t i = 0; i < builders.size(); i++) {
+            results.setValueAtIndex(rt, i, builders[i](rt));
+        }
+        jsi::Object result = jsi::Object(rt);
+        result.setProperty(rt, "success", true);
+        result.setProperty(rt, "results", results);
+        result.setProperty(rt, "streamsFailed", static_cast<double>(failed));
+        result.setProperty(rt, "processingTimeMs", processingTimeMs);
+        return result;
+    };
+}
+
+// Writes the decoded PCM into `ring` instead of returning it, and resolves
+// with the per-call counters plus what the ring accepted
+NativeOpusTurboModule::ResultBuilder ringResult(rnopus::DecodeResult decodedResult, rnopus::PcmRingBuffer& ring) {
+    size_t frames = decodedResult.pcmFloat.size() / ring.channels();
+    size_t framesWritten = ring.write(decodedResult.pcmFloat.data(), frames);
+    decodedResult.pcmFloat = {};
+
+    auto decoded = std::make_shared<rnopus::DecodeResult>(std::move(decodedResult));
+    return [decoded, frames, framesWritten](jsi::Runtime &rt) -> jsi::Value {
+        jsi::Object result = jsi::Object(rt);
+        result.setProperty(rt, "success", true);
+        result.setProperty(rt, "samplesDecoded", decoded->samplesDecoded);
+        result.setProperty(rt, "outputSamples", decoded->outputSamples);
+        result.setProperty(rt, "packetsDecoded", decoded->packetsDecoded);
+        result.setProperty(rt, "packetsConcealed", decoded->packetsConcealed);
+        result.setProperty(rt, "packetsRecovered", decoded->packetsRecovered);
+        result.setProperty(rt, "packetsDredRecovered", decoded->packetsDredRecovered);
+        result.setProperty(rt, "packetsLate", decoded->packetsLate);
+        result.setProperty(rt, "samplesRecovered", decoded->samplesRecovered);
+        result.setProperty(rt, "samplesConcealed", decoded->samplesConcealed);
+        result.setProperty(rt, "framesWritten", static_cast<double>(framesWritten));
+        result.setProperty(rt, "framesDropped", static_cast<double>(frames - framesWritten));
+        result.setProperty(rt, "processingTimeMs", decoded->processingTimeMs);
+        return result;
+    };
+}
+
+// Encoded packets as a Uint8Array plus the size of each one
+NativeOpusTurboModule::ResultBuilder encodeResult(rnopus::EncodeResult encodeResult) {
+    auto encoded = std::make_shared<rnopus::EncodeResult>(std::move(encodeResult));
+    return [encoded](jsi::Runtime &rt) -> jsi::Value {
+        jsi::ArrayBuffer buffer(rt, std::make_shared<PcmBuffer<uint8_t>>(std::move(encoded->data)));
+        jsi::Value packets = rt.global().getPropertyAsFunction(rt, "Uint8Array").callAsConstructor(rt, buffer);
+        jsi::Array lengths(rt, encoded->lengths.size());
+        for (size_t i = 0; i < encoded->lengths.size(); i++) {
+            lengths.setValueAtIndex(rt, i, static_cast<double>(encoded->lengths[i]));
+        }
+
+        jsi::Object result = jsi::Object(rt);
+        result.setProperty(rt, "success", true);
+        result.setProperty(rt, "packets", packets);
+        result.setProperty(rt, "lengths", lengths);
+        result.setProperty(rt, "packetsEncoded", encoded->packetsEncoded);
+        result.setProperty(rt, "samplesEncoded", encoded->samplesEncoded);
+        result.setProperty(rt, "processingTimeMs", encoded->processingTimeMs);
+        return result;
+    };
+}
+
+// Reads `framing` for encoder output: "u16" (default), "varint" or "lengths"
+rnopus::Framing parseOutputFraming(jsi::Runtime &rt, const jsi::Object &options) {
+    jsi::Value framingName = options.getProperty(rt, "framing");
+    if (framingName.isString()) {
+        return rnopus::parseFraming(framingName.getString(rt).utf8(rt));
+    }
+    return rnopus::Framing::U16;
+}
+
+// Reads `outputFraming` for repacketized or unpadded packets. Defaults to
+// the input framing when it is "u16" or "varint", "u16" otherwise.
+rnopus::Framing parseConvertedFraming(jsi::Runtime &rt, const jsi::Object &options, rnopus::Framing input) {
+    jsi::Value framingName = options.getProperty(rt, "outputFraming");
+    if (framingName.isString()) {
+        return rnopus::parseFraming(framingName.getString(rt).utf8(rt));
+    }
+    return input == rnopus::Framing::Varint ? input : rnopus::Framing::U16;
+}
+
+NativeOpusTurboModule::ResultBuilder repacketizeResult(rnopus::RepacketizeResult repacketized) {
+    auto packed = std::make_shared<rnopus::RepacketizeResult>(std::move(repacketized));
+    return [packed](jsi::Runtime &rt) -> jsi::Value {
+        size_t packetCount = packed->lengths.size();
+        jsi::ArrayBuffer buffer(rt, std::make_shared<PcmBuffer<uint8_t>>(std::move(packed->data)));
+        jsi::Value packets = rt.global().getPropertyAsFunction(rt, "Uint8Array").callAsConstructor(rt, buffer);
+        jsi::Array lengths(rt, packetCount);
+        for (size_t i = 0; i < packetCount; i++) {
+            lengths.setValueAtIndex(rt, i, static_cast<double>(packed->lengths[i]));
+        }
+
+        jsi::Object result = jsi::Object(rt);
+        result.setProperty(rt, "success", true);
+        result.setProperty(rt, "packets", packets);
+        result.setProperty(rt, "lengths", lengths);
+        result.setProperty(rt, "packetCount", static_cast<double>(packetCount));
+        result.setProperty(rt, "frameCount", packed->framesOut);
+        result.setProperty(rt, "processingTimeMs", packed->processingTimeMs);
         return result;
+    };
+}
+
+NativeOpusTurboModule::ResultBuilder paddingResult(const rnopus::PaddingSummary& summary, const std::string& outputPath) {
+    return [summary, outputPath](jsi::Runtime &rt) -> jsi::Value {
+        jsi::Object result = jsi::Object(rt);
+        result.setProperty(rt, "success", true);
+        result.setProperty(rt, "filepath", jsi::String::createFromUtf8(rt, outputPath));
+        result.setProperty(rt, "packets", static_cast<double>(summary.packets));
+        result.setProperty(rt, "inputBytes", static_cast<double>(summary.inputBytes));
+        result.setProperty(rt, "outputBytes", static_cast<double>(summary.outputBytes));
+        result.setProperty(rt, "truncatedBytes", static_cast<double>(summary.truncatedBytes));
+        result.setProperty(rt, "processingTimeMs", summary.processingTimeMs);
+        return result;
+    };
+}
+
+jsi::Object jitterStatsObject(jsi::Runtime &rt, const rnopus::JitterBufferStats& stats) {
+    jsi::Object result = jsi::Object(rt);
+    result.setProperty(rt, "packetsReceived", static_cast<double>(stats.packetsReceived));
+    result.setProperty(rt, "packetsDecoded", static_cast<double>(stats.packetsDecoded));
+    result.setProperty(rt, "packetsLate", static_cast<double>(stats.packetsLate));
+    result.setProperty(rt, "packetsDuplicate", static_cast<double>(stats.packetsDuplicate));
+    result.setProperty(rt, "packetsLost", static_cast<double>(stats.packetsLost));
+    result.setProperty(rt, "packetsRecovered", static_cast<double>(stats.packetsRecovered));
+    result.setProperty(rt, "packetsDredRecovered", static_cast<double>(stats.packetsDredRecovered));
+    result.setProperty(rt, "packetsConcealed", static_cast<double>(stats.packetsConcealed));
+    result.setProperty(rt, "packetsDropped", static_cast<double>(stats.packetsDropped));
+    result.setProperty(rt, "underruns", static_cast<double>(stats.underruns));
+    result.setProperty(rt, "jitterMs", stats.jitterMs);
+    result.setProperty(rt, "targetDelayMs", stats.targetDelayMs);
+    result.setProperty(rt, "currentDelayMs", stats.currentDelayMs);
+    result.setProperty(rt, "concealmentRatio", stats.concealmentRatio);
+    result.setProperty(rt, "bufferedPackets", static_cast<double>(stats.bufferedPackets));
+    return result;
+}
+
+} // namespace
+
+// Constructor: Create the module-wide decoder used by the legacy methods
+NativeOpusTurboModule::NativeOpusTurboModule(std::shared_ptr<CallInvoker> jsinvoker)
+    : NativeOpusTurboModuleCxxSpec(std::move(jsinvoker)),
+      workerPool(std::make_shared<rnopus::ThreadPool>()) {
+    try {
+        defaultDecoder = makeEntry(std::make_shared<rnopus::DecoderSession>(DEFAULT_SAMPLE_RATE, DEFAULT_CHANNELS));
+    } catch (const std::exception&) {
+        // Leave it null; the legacy methods report "Decoder not initialized"
+        defaultDecoder = nullptr;
     }
+}
 
+// Destructor: Finish queued work before the sessions go away
+NativeOpusTurboModule::~NativeOpusTurboModule() {
+    workerPool->shutdown();
+    // Handles restart with the next module instance
+    for (const auto& ring : pcmRings) {
+        rnopus::unregisterPcmRing(ring.first);
+    }
+}
+
+template <typename Session>
+std::shared_ptr<NativeOpusTurboModule::SessionEntry<Session>> NativeOpusTurboModule::makeEntry(std::shared_ptr<Session> session) {
+    auto entry = std::make_shared<SessionEntry<Session>>();
+    entry->session = std::move(session);
+    entry->queue = std::make_shared<rnopus::SerialQueue>(workerPool);
+    return entry;
+}
+
+template <typename Session>
+std::shared_ptr<NativeOpusTurboModule::SessionEntry<Session>> NativeOpusTurboModule::findEntry(const SessionMap<Session>& sessions, double handle) {
+    auto it = sessions.find(static_cast<int>(handle));
+    return it == sessions.end() ? nullptr : it->second;
+}
+
+template <typename Session>
+jsi::Value NativeOpusTurboModule::runOnSession(jsi::Runtime &rt, std::shared_ptr<SessionEntry<Session>> entry, const char* missingError,
+                                               std::function<ResultBuilder(Session&)> work) {
+    if (!entry) {
+        return resolvedPromise(rt, errorResult(missingError));
+    }
+    return makePromise(rt, [this, entry, missingError, work = std::move(work)](std::shared_ptr<PromiseHandle> promise) {
+        entry->queue->post([this, entry, missingError, work, promise = std::move(promise)]() mutable {
+            ResultBuilder builder;
+            try {
+                // Null when the session failed to open on the queue
+                builder = entry->session ? work(*entry->session) : errorResult(missingError);
+            } catch (const std::exception& e) {
+                builder = errorResult(e.what());
+            }
+            settlePromise(jsInvoker_, std::move(promise), std::move(builder));
+        });
+    });
+}
+
+jsi::Value NativeOpusTurboModule::resolvedPromise(jsi::Runtime &rt, ResultBuilder builder) {
+    return makePromise(rt, [this, builder = std::move(builder)](std::shared_ptr<PromiseHandle> promise) {
+        settlePromise(jsInvoker_, std::move(promise), builder);
+    });
+}
+
+// Base64 encoding/decoding utility methods (vectorized, see Base64.cpp)
+std::string NativeOpusTurboModule::base64_encode(const uint8_t* data, size_t size) {
+    return rnopus::base64::encode(data, size);
+}
+
+std::vector<uint8_t> NativeOpusTurboModule::base64_decode(const std::string& input) {
+    std::vector<uint8_t> decoded_data;
+    rnopus::base64::decode(input.data(), input.size(), decoded_data);
+    return decoded_data;
+}
+
+// Runs on the default decoder's queue
+NativeOpusTurboModule::ResultBuilder NativeOpusTurboModule::decodeBase64Packets(rnopus::DecoderSession& session, const std::string& packetsBase64, int packetSize) {
     try {
         std::vector<uint8_t> inputData = base64_decode(packetsBase64);
         if (inputData.empty() && !packetsBase64.empty()) { // Handle invalid base64
-             result.setProperty(rt, "success", false);
-             result.setProperty(rt, "error", jsi::String::createFromUtf8(rt, "Invalid base64 input"));
-             return result;
-        }
-         if (inputData.empty() && packetsBase64.empty()) { // Handle empty input explicitly
-             result.setProperty(rt, "success", true);
-             result.setProperty(rt, "decodedDataBase64", jsi::String::createFromUtf8(rt, ""));
-             result.setProperty(rt, "samplesDecoded", 0);
-             result.setProperty(rt, "packetsDecoded", 0);
-             result.setProperty(rt, "processingTimeMs", 0.0);
-             return result;
-         }
-
-        // ---- Start of logic moved from processRawOpusBytes ----
-        const unsigned char* inputBytes = inputData.data();
-        size_t inputSize = inputData.size();
+            return errorResult("Invalid base64 input");
+        }
+        if (inputData.empty()) { // Handle empty input explicitly
+            return [](jsi::Runtime &rt) -> jsi::Value {
+                jsi::Object result = jsi::Object(rt);
+                result.setProperty(rt, "success", true);
+                result.setProperty(rt, "decodedDataBase64", jsi::String::createFromUtf8(rt, ""));
+                result.setProperty(rt, "samplesDecoded", 0);
+                result.setProperty(rt, "packetsDecoded", 0);
+                result.setProperty(rt, "processingTimeMs", 0.0);
+                return result;
+            };
+        }
 
         auto startTime = std::chrono::high_resolution_clock::now();
 
-        std::vector<opus_int16> outputBuffer;
-        outputBuffer.reserve(inputSize * 4); // Approximate reserve
+        rnopus::FramingOptions framing;
+        framing.packetSize = packetSize;
+        rnopus::DecodeResult decoded = session.decode(inputData.data(), inputData.size(), framing);
+        std::vector<uint8_t>().swap(inputData); // Not needed past this point
 
-        int totalSamplesDecoded = 0;
-        int packetsDecoded = 0;
+        // Encode straight from the PCM buffer; no intermediate byte copy
+        auto outputBase64 = std::make_shared<std::string>(base64_encode(
+            reinterpret_cast<const uint8_t*>(decoded.pcm.data()),
+            decoded.pcm.size() * sizeof(opus_int16)
+        ));
 
-        for (size_t offset = 0; offset < inputSize; offset += packetSizeInt) {
-            size_t packetBytes = std::min((size_t)packetSizeInt, inputSize - offset);
+        auto endTime = std::chrono::high_resolution_clock::now();
+        double processingTime = std::chrono::duration<double, std::milli>(endTime - startTime).count();
 
-            if (packetBytes < packetSizeInt && offset > 0) {
-                break;
+        int samplesDecoded = decoded.samplesDecoded;
+        int packetsDecoded = decoded.packetsDecoded;
+
+        return [outputBase64, samplesDecoded, packetsDecoded, processingTime](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "decodedDataBase64", jsi::String::createFromUtf8(rt, *outputBase64));
+            result.setProperty(rt, "samplesDecoded", samplesDecoded);
+            result.setProperty(rt, "packetsDecoded", packetsDecoded);
+            result.setProperty(rt, "processingTimeMs", processingTime);
+            return result;
+        };
+    } catch (const std::exception& e) {
+        return errorResult(e.what());
+    }
+}
+
+// Snapshots the packets on the JS thread and decodes them on the entry's queue
+jsi::Value NativeOpusTurboModule::queueBufferDecode(jsi::Runtime &rt, std::shared_ptr<DecoderEntry> entry, const jsi::Object& packets, const jsi::Object& options) {
+    auto input = std::make_shared<std::vector<uint8_t>>();
+    auto framing = std::make_shared<rnopus::FramingOptions>();
+    auto decodeOptions = std::make_shared<rnopus::DecodeOptions>();
+    std::shared_ptr<rnopus::PcmRingBuffer> ring;
+    try {
+        // JS may mutate or release the buffer once we return, so the packets
+        // are snapshotted here. They are a small fraction of the PCM size.
+        const uint8_t* inputBytes = nullptr;
+        size_t inputSize = 0;
+        getPacketBytes(rt, packets, inputBytes, inputSize);
+        input->assign(inputBytes, inputBytes + inputSize);
+        *framing = parseFramingOptions(rt, options);
+        *decodeOptions = parseDecodeOptions(rt, options);
+        jsi::Value ringHandle = options.getProperty(rt, "ring");
+        if (ringHandle.isNumber()) {
+            int handle = static_cast<int>(ringHandle.getNumber());
+            auto it = pcmRings.find(handle);
+            if (it == pcmRings.end()) {
+                throw std::invalid_argument("Unknown PCM ring handle");
+            }
+            // Queued work holds the entry, so a destroyed producer releases
+            // the ring only once its last write has run
+            std::weak_ptr<DecoderEntry>& producer = pcmRingProducers[handle];
+            std::shared_ptr<DecoderEntry> owner = producer.lock();
+            if (owner && owner != entry) {
+                throw std::invalid_argument("PCM ring is already written by another decoder");
             }
+            producer = entry;
+            ring = it->second;
+            decodeOptions->format = rnopus::SampleFormat::Float32;
+        }
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+
+    return runOnSession<rnopus::DecoderSession>(rt, entry, "Unknown decoder handle", [input, framing, decodeOptions, ring](rnopus::DecoderSession& session) {
+        if (!ring) {
+            return pcmResult(session.decode(input->data(), input->size(), *framing, *decodeOptions));
+        }
+        if (ring->channels() != session.channels()) {
+            return errorResult("PCM ring channel count does not match the decoder");
+        }
+        return ringResult(session.decode(input->data(), input->size(), *framing, *decodeOptions), *ring);
+    });
+}
+
+// Modified decodeMultipleOpusPackets (Base64 version)
+jsi::Value NativeOpusTurboModule::decodeMultipleOpusPackets(jsi::Runtime &rt, std::string packetsBase64, double packetSize) {
+    auto input = std::make_shared<std::string>(std::move(packetsBase64));
+    int packetSizeInt = (int)packetSize;
+
+    return runOnSession<rnopus::DecoderSession>(rt, defaultDecoder, "Decoder not initialized", [this, input, packetSizeInt](rnopus::DecoderSession& session) {
+        return decodeBase64Packets(session, *input, packetSizeInt);
+    });
+}
+
+// Zero-copy variant: reads packets from an ArrayBuffer / Uint8Array and
+// resolves the PCM as an Int16Array backed by the native output buffer.
+jsi::Value NativeOpusTurboModule::decodeOpusPacketsBuffer(jsi::Runtime &rt, jsi::Object packets, jsi::Object options) {
+    if (!defaultDecoder) {
+        return resolvedPromise(rt, errorResult("Decoder not initialized"));
+    }
+    return queueBufferDecode(rt, defaultDecoder, packets, options);
+}
+
+// New method to reset decoder state. Queued behind pending decodes so it
+// takes effect between calls rather than in the middle of one.
+jsi::Value NativeOpusTurboModule::resetDecoderState(jsi::Runtime &rt) {
+    return runOnSession<rnopus::DecoderSession>(rt, defaultDecoder, "Decoder not initialized", [](rnopus::DecoderSession& session) {
+        int error = session.reset();
+        return error == OPUS_OK ? successResult() : errorResult(opus_strerror(error));
+    });
+}
+
+// Replaces the module-wide decoder. Calls already queued finish on the old
+// one; everything issued afterwards uses the new rate and channel count.
+jsi::Value NativeOpusTurboModule::configureDefaultDecoder(jsi::Runtime &rt, jsi::Object config) {
+    ResultBuilder builder;
+    try {
+        auto sampleRate = static_cast<opus_int32>(config.getProperty(rt, "sampleRate").asNumber());
+        int channels = static_cast<int>(config.getProperty(rt, "channels").asNumber());
+        auto session = std::make_shared<rnopus::DecoderSession>(sampleRate, channels);
+        configureResampling(rt, config, *session);
+        defaultDecoder = makeEntry(std::move(session));
+        builder = successResult();
+    } catch (const std::exception& e) {
+        builder = errorResult(e.what());
+    }
+    return resolvedPromise(rt, std::move(builder));
+}
+
+// Decoder sessions: each handle owns its own OpusDecoder, statistics and
+// queue, so independent streams decode in parallel.
+jsi::Value NativeOpusTurboModule::createDecoder(jsi::Runtime &rt, jsi::Object config) {
+    ResultBuilder builder;
+    try {
+        auto sampleRate = static_cast<opus_int32>(config.getProperty(rt, "sampleRate").asNumber());
+        int channels = static_cast<int>(config.getProperty(rt, "channels").asNumber());
+        auto session = std::make_shared<rnopus::DecoderSession>(sampleRate, channels);
+        configureResampling(rt, config, *session);
+        int handle = nextHandle++;
+        decoders[handle] = makeEntry(std::move(session));
+        builder = handleResult(handle);
+    } catch (const std::exception& e) {
+        builder = errorResult(e.what());
+    }
+    return resolvedPromise(rt, std::move(builder));
+}
+
+jsi::Value NativeOpusTurboModule::decodeWithDecoder(jsi::Runtime &rt, double handle, jsi::Object packets, jsi::Object options) {
+    std::shared_ptr<DecoderEntry> entry = findEntry(decoders, handle);
+    if (!entry) {
+        return resolvedPromise(rt, errorResult("Unknown decoder handle"));
+    }
+    return queueBufferDecode(rt, entry, packets, options);
+}
+
+jsi::Value NativeOpusTurboModule::resetDecoder(jsi::Runtime &rt, double handle) {
+    return runOnSession<rnopus::DecoderSession>(rt, findEntry(decoders, handle), "Unknown decoder handle", [](rnopus::DecoderSession& session) {
+        int error = session.reset();
+        return error == OPUS_OK ? successResult() : errorResult(opus_strerror(error));
+    });
+}
+
+// The handle is invalid as soon as this returns; the OpusDecoder itself is
+// released once the decodes already queued on it have finished.
+jsi::Value NativeOpusTurboModule::destroyDecoder(jsi::Runtime &rt, double handle) {
+    std::shared_ptr<DecoderEntry> entry = findEntry(decoders, handle);
+    decoders.erase(static_cast<int>(handle));
+    return runOnSession<rnopus::DecoderSession>(rt, entry, "Unknown decoder handle", [](rnopus::DecoderSession&) {
+        return successResult();
+    });
+}
+
+// Read on the queue so the numbers include every decode issued before
+jsi::Value NativeOpusTurboModule::getDecoderStats(jsi::Runtime &rt, double handle) {
+    return runOnSession<rnopus::DecoderSession>(rt, findEntry(decoders, handle), "Unknown decoder handle", [](rnopus::DecoderSession& session) -> ResultBuilder {
+        rnopus::DecoderStats stats = session.stats();
+        opus_int32 sampleRate = session.sampleRate();
+        int outputSampleRate = session.outputRate();
+        int channels = session.channels();
+        return [stats, sampleRate, outputSampleRate, channels](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "sampleRate", static_cast<double>(sampleRate));
+            result.setProperty(rt, "outputSampleRate", outputSampleRate);
+            result.setProperty(rt, "channels", channels);
+            result.setProperty(rt, "decodeCalls", static_cast<double>(stats.decodeCalls));
+            result.setProperty(rt, "packetsDecoded", static_cast<double>(stats.packetsDecoded));
+            result.setProperty(rt, "packetsFailed", static_cast<double>(stats.packetsFailed));
+            result.setProperty(rt, "packetsConcealed", static_cast<double>(stats.packetsConcealed));
+            result.setProperty(rt, "packetsRecovered", static_cast<double>(stats.packetsRecovered));
+            result.setProperty(rt, "packetsDredRecovered", static_cast<double>(stats.packetsDredRecovered));
+            result.setProperty(rt, "packetsLate", static_cast<double>(stats.packetsLate));
+            result.setProperty(rt, "samplesDecoded", static_cast<double>(stats.samplesDecoded));
+            result.setProperty(rt, "samplesRecovered", static_cast<double>(stats.samplesRecovered));
+            result.setProperty(rt, "samplesConcealed", static_cast<double>(stats.samplesConcealed));
+            result.setProperty(rt, "processingTimeMs", stats.processingTimeMs);
+            return result;
+        };
+    });
+}
 
-            opus_int16 tempBuffer[960];
-            int samplesDecoded = opus_decode(
-                opusDecoder,
-                inputBytes + offset,
-                packetBytes,
-                tempBuffer,
-                960, // Max frame size per channel for opus
-                0
-            );
-
-            if (samplesDecoded < 0) {
-                continue;
+// Decodes many independent streams (e.g. a page of voice messages) at once.
+// Each stream gets a fresh decoder and the streams are spread over the
+// worker pool, so the batch takes roughly total work / core count.
+jsi::Value NativeOpusTurboModule::decodeOpusBatch(jsi::Runtime &rt, jsi::Array streams, jsi::Object options) {
+    auto parsed = std::make_shared<std::vector<rnopus::BatchStream>>();
+    try {
+        rnopus::BatchStream defaults;
+        jsi::Value sampleRate = options.getProperty(rt, "sampleRate");
+        defaults.sampleRate = sampleRate.isNumber() ? static_cast<opus_int32>(sampleRate.getNumber()) : DEFAULT_SAMPLE_RATE;
+        jsi::Value channels = options.getProperty(rt, "channels");
+        defaults.channels = channels.isNumber() ? static_cast<int>(channels.getNumber()) : DEFAULT_CHANNELS;
+        defaults.outputRate = parseOutputRate(rt, options, defaults.quality);
+
+        size_t count = streams.size(rt);
+        parsed->reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            try {
+                parsed->push_back(parseBatchStream(rt, streams.getValueAtIndex(rt, i).asObject(rt), defaults));
+            } catch (const std::exception& e) {
+                throw std::invalid_argument("Invalid stream " + std::to_string(i) + ": " + e.what());
             }
+        }
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
 
-            outputBuffer.insert(
-                outputBuffer.end(),
-                tempBuffer,
-                // samplesDecoded is per channel, multiply by number of channels
-                tempBuffer + samplesDecoded * DEFAULT_CHANNELS
-            );
+    return makePromise(rt, [this, parsed](std::shared_ptr<PromiseHandle> promise) {
+        auto start = std::chrono::steady_clock::now();
+        rnopus::decodeBatch(*workerPool, std::move(*parsed), [this, start, promise = std::move(promise)](std::vector<rnopus::BatchStreamResult> results) mutable {
+            double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            settlePromise(jsInvoker_, std::move(promise), batchResult(std::move(results), elapsedMs));
+        });
+    });
+}
 
-            totalSamplesDecoded += samplesDecoded;
-            packetsDecoded++;
+// Demuxes and decodes an Ogg Opus file entirely on a worker thread; packets
+// go from the memory-mapped file straight into a dedicated decoder.
+jsi::Value NativeOpusTurboModule::decodeOggOpusFile(jsi::Runtime &rt, std::string filepath, jsi::Object options) {
+    opus_int32 sampleRate = 48000;
+    rnopus::SampleFormat format = rnopus::SampleFormat::Int16;
+    try {
+        jsi::Value sampleRateValue = options.getProperty(rt, "sampleRate");
+        if (sampleRateValue.isNumber()) {
+            sampleRate = static_cast<opus_int32>(sampleRateValue.getNumber());
         }
+        format = parseSampleFormat(rt, options);
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+
+    return makePromise(rt, [this, filepath, sampleRate, format](std::shared_ptr<PromiseHandle> promise) {
+        workerPool->submit([this, filepath, sampleRate, format, promise = std::move(promise)]() mutable {
+            settlePromise(jsInvoker_, std::move(promise), decodeOggFile(filepath, sampleRate, format));
+        });
+    });
+}
 
-        size_t outputSizeBytes = outputBuffer.size() * sizeof(opus_int16);
-        std::vector<uint8_t> outputBytesVec(
-            reinterpret_cast<uint8_t*>(outputBuffer.data()),
-            reinterpret_cast<uint8_t*>(outputBuffer.data()) + outputSizeBytes
-        );
-        // Call the base64 encode method directly as we are inside the class scope
-        std::string outputBase64 = base64_encode(outputBytesVec);
+// Runs on the worker pool
+NativeOpusTurboModule::ResultBuilder NativeOpusTurboModule::decodeOggFile(const std::string& filepath, opus_int32 sampleRate, rnopus::SampleFormat format) {
+    try {
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        rnopus::MappedFile file(filepath);
+        rnopus::OggOpusStream stream = rnopus::parseOggOpus(file.data(), file.size());
+        rnopus::DecodeResult decoded = rnopus::decodeOggOpus(stream, sampleRate, format);
 
         auto endTime = std::chrono::high_resolution_clock::now();
-        double processingTime = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+        decoded.processingTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
 
-        result.setProperty(rt, "success", true);
-        result.setProperty(rt, "decodedDataBase64", jsi::String::createFromUtf8(rt, outputBase64));
-        result.setProperty(rt, "samplesDecoded", totalSamplesDecoded);
-        result.setProperty(rt, "packetsDecoded", packetsDecoded);
-        result.setProperty(rt, "processingTimeMs", processingTime);
-        // ---- End of logic moved from processRawOpusBytes ----
+        int channels = stream.head.channels;
+        int preSkip = stream.head.preSkip;
+        int corruptPages = stream.corruptPages;
+        double durationMs = 1000.0 * decoded.samplesDecoded / sampleRate;
+        auto tags = std::make_shared<rnopus::OpusTags>(std::move(stream.tags));
+        ResultBuilder pcm = pcmResult(std::move(decoded));
 
-        return result; // Return success result
+        return [pcm, sampleRate, channels, preSkip, corruptPages, durationMs, tags](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Value value = pcm(rt);
+            jsi::Object result = value.getObject(rt);
+            result.setProperty(rt, "sampleRate", static_cast<double>(sampleRate));
+            result.setProperty(rt, "channels", channels);
+            result.setProperty(rt, "preSkip", preSkip);
+            result.setProperty(rt, "durationMs", durationMs);
+            result.setProperty(rt, "corruptPages", corruptPages);
+            result.setProperty(rt, "vendor", jsi::String::createFromUtf8(rt, tags->vendor));
+            jsi::Array comments(rt, tags->comments.size());
+            for (size_t i = 0; i < tags->comments.size(); i++) {
+                comments.setValueAtIndex(rt, i, jsi::String::createFromUtf8(rt, tags->comments[i]));
+            }
+            result.setProperty(rt, "comments", comments);
+            return value;
+        };
+    } catch (const std::exception& e) {
+        return errorResult(e.what());
+    }
+}
 
+// Packets file in, WAV file out. Nothing but the summary crosses into JS.
+jsi::Value NativeOpusTurboModule::decodeFileToWav(jsi::Runtime &rt, std::string inputPath, std::string outputPath, jsi::Object options) {
+    auto framing = std::make_shared<rnopus::FramingOptions>();
+    opus_int32 sampleRate = DEFAULT_SAMPLE_RATE;
+    int channels = DEFAULT_CHANNELS;
+    try {
+        *framing = parseFramingOptions(rt, options);
+        jsi::Value sampleRateValue = options.getProperty(rt, "sampleRate");
+        if (sampleRateValue.isNumber()) {
+            sampleRate = static_cast<opus_int32>(sampleRateValue.getNumber());
+        }
+        jsi::Value channelsValue = options.getProperty(rt, "channels");
+        if (channelsValue.isNumber()) {
+            channels = static_cast<int>(channelsValue.getNumber());
+        }
     } catch (const std::exception& e) {
-        result.setProperty(rt, "success", false);
-        result.setProperty(rt, "error", jsi::String::createFromUtf8(rt, e.what()));
-        return result;
+        return resolvedPromise(rt, errorResult(e.what()));
     }
+
+    return makePromise(rt, [this, inputPath, outputPath, framing, sampleRate, channels](std::shared_ptr<PromiseHandle> promise) {
+        workerPool->submit([this, inputPath, outputPath, framing, sampleRate, channels, promise = std::move(promise)]() mutable {
+            ResultBuilder builder;
+            try {
+                rnopus::TranscodeSummary summary = rnopus::transcodeToWav(inputPath, outputPath, *framing, sampleRate, channels);
+                builder = [summary, outputPath](jsi::Runtime &rt) -> jsi::Value {
+                    jsi::Object result = jsi::Object(rt);
+                    result.setProperty(rt, "success", true);
+                    result.setProperty(rt, "filepath", jsi::String::createFromUtf8(rt, outputPath));
+                    result.setProperty(rt, "samplesDecoded", static_cast<double>(summary.samplesDecoded));
+                    result.setProperty(rt, "packetsDecoded", static_cast<double>(summary.packetsDecoded));
+                    result.setProperty(rt, "packetsFailed", static_cast<double>(summary.packetsFailed));
+                    result.setProperty(rt, "dataBytes", static_cast<double>(summary.dataBytes));
+                    result.setProperty(rt, "durationMs", summary.durationMs);
+                    result.setProperty(rt, "processingTimeMs", summary.processingTimeMs);
+                    return result;
+                };
+            } catch (const std::exception& e) {
+                builder = errorResult(e.what());
+            }
+            settlePromise(jsInvoker_, std::move(promise), std::move(builder));
+        });
+    });
 }
 
-// New method to reset decoder state
-jsi::Value NativeOpusTurboModule::resetDecoderState(jsi::Runtime &rt) {
-    jsi::Object result = jsi::Object(rt);
-    if (!opusDecoder) {
-        result.setProperty(rt, "success", false);
-        result.setProperty(rt, "error", jsi::String::createFromUtf8(rt, "Decoder not initialized"));
-        return result;
+// Pads every packet to `paddedSize` bytes so fixed-size readers such as
+// decodeMultipleOpusPackets can take VBR content.
+jsi::Value NativeOpusTurboModule::padOpusPacketFile(jsi::Runtime &rt, std::string inputPath, std::string outputPath, jsi::Object options) {
+    rnopus::FramingOptions framing;
+    int paddedSize = 0;
+    try {
+        framing = parseFramingOptions(rt, options);
+        paddedSize = static_cast<int>(options.getProperty(rt, "paddedSize").asNumber());
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
     }
 
-    int error = opus_decoder_ctl(opusDecoder, OPUS_RESET_STATE);
-    if (error == OPUS_OK) {
-        result.setProperty(rt, "success", true);
-    } else {
-        result.setProperty(rt, "success", false);
-        result.setProperty(rt, "error", jsi::String::createFromUtf8(rt, opus_strerror(error)));
+    return makePromise(rt, [this, inputPath, outputPath, framing = std::move(framing), paddedSize](std::shared_ptr<PromiseHandle> promise) {
+        workerPool->submit([this, inputPath, outputPath, framing, paddedSize, promise = std::move(promise)]() mutable {
+            ResultBuilder builder;
+            try {
+                builder = paddingResult(rnopus::padPacketFile(inputPath, outputPath, framing, paddedSize), outputPath);
+            } catch (const std::exception& e) {
+                builder = errorResult(e.what());
+            }
+            settlePromise(jsInvoker_, std::move(promise), std::move(builder));
+        });
+    });
+}
+
+// Strips the padding again for storage, writing `outputFraming` ("u16" by
+// default, or "varint").
+jsi::Value NativeOpusTurboModule::unpadOpusPacketFile(jsi::Runtime &rt, std::string inputPath, std::string outputPath, jsi::Object options) {
+    int paddedSize = 0;
+    rnopus::Framing outputFraming = rnopus::Framing::U16;
+    try {
+        paddedSize = static_cast<int>(options.getProperty(rt, "paddedSize").asNumber());
+        outputFraming = parseConvertedFraming(rt, options, rnopus::Framing::U16);
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
     }
-    return result;
+
+    return makePromise(rt, [this, inputPath, outputPath, paddedSize, outputFraming](std::shared_ptr<PromiseHandle> promise) {
+        workerPool->submit([this, inputPath, outputPath, paddedSize, outputFraming, promise = std::move(promise)]() mutable {
+            ResultBuilder builder;
+            try {
+                builder = paddingResult(rnopus::unpadPacketFile(inputPath, outputPath, paddedSize, outputFraming), outputPath);
+            } catch (const std::exception& e) {
+                builder = errorResult(e.what());
+            }
+            settlePromise(jsInvoker_, std::move(promise), std::move(builder));
+        });
+    });
 }
 
 jsi::Value NativeOpusTurboModule::saveDecodedDataAsWav(jsi::Runtime &rt, std::string decodedDataBase64, std::string filepath, double sampleRate, double channels) {
-    jsi::Object result = jsi::Object(rt);
-    
+    auto input = std::make_shared<std::string>(std::move(decodedDataBase64));
+
+    return makePromise(rt, [this, input, filepath, sampleRate, channels](std::shared_ptr<PromiseHandle> promise) {
+        workerPool->submit([this, input, filepath, sampleRate, channels, promise = std::move(promise)]() mutable {
+            settlePromise(jsInvoker_, std::move(promise), writeWavFile(*input, filepath, sampleRate, channels));
+        });
+    });
+}
+
+// Runs on the worker pool
+NativeOpusTurboModule::ResultBuilder NativeOpusTurboModule::writeWavFile(const std::string& decodedDataBase64, const std::string& filepath, double sampleRate, double channels) {
     try {
-        // Decode base64 to PCM data
+        // Decode base64 to PCM data (16-bit samples)
         std::vector<uint8_t> decodedBytes = base64_decode(decodedDataBase64);
-        
-        // PCM data is 16-bit samples
-        // size_t numSamples = decodedBytes.size() / 2;
-        
-        // Open file for writing
-        FILE* file = fopen(filepath.c_str(), "wb");
-        if (!file) {
-            result.setProperty(rt, "success", false);
-            result.setProperty(rt, "error", jsi::String::createFromUtf8(rt, "Failed to open output file"));
+
+        rnopus::WavWriter writer(filepath, static_cast<uint32_t>(sampleRate), static_cast<uint16_t>(channels));
+        writer.append(decodedBytes.data(), decodedBytes.size());
+        writer.finalize();
+
+        return [filepath](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "filepath", jsi::String::createFromUtf8(rt, filepath));
             return result;
+        };
+    } catch (const std::exception& e) {
+        return errorResult(e.what());
+    }
+}
+
+// Streaming WAV output: the file grows chunk by chunk on the writer's queue,
+// so memory stays constant however long the recording gets.
+jsi::Value NativeOpusTurboModule::openWavWriter(jsi::Runtime &rt, std::string filepath, jsi::Object config) {
+    uint32_t sampleRate = 0;
+    uint16_t channels = 0;
+    try {
+        sampleRate = static_cast<uint32_t>(config.getProperty(rt, "sampleRate").asNumber());
+        channels = static_cast<uint16_t>(config.getProperty(rt, "channels").asNumber());
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+
+    // Reserve the handle now; the file itself is created on the queue.
+    int handle = nextHandle++;
+    auto entry = makeEntry(std::shared_ptr<rnopus::WavWriter>());
+    wavWriters[handle] = entry;
+
+    return makePromise(rt, [this, entry, handle, filepath, sampleRate, channels](std::shared_ptr<PromiseHandle> promise) {
+        entry->queue->post([this, entry, handle, filepath, sampleRate, channels, promise = std::move(promise)]() mutable {
+            ResultBuilder builder;
+            try {
+                entry->session = std::make_shared<rnopus::WavWriter>(filepath, sampleRate, channels);
+                builder = handleResult(handle);
+            } catch (const std::exception& e) {
+                // Drop the handle again (on the JS thread, where the map
+                // lives) unless the module is gone with the map
+                ResultBuilder error = errorResult(e.what());
+                std::weak_ptr<bool> module = alive;
+                builder = [this, module, handle, error](jsi::Runtime &rt) -> jsi::Value {
+                    if (module.lock()) {
+                        wavWriters.erase(handle);
+                    }
+                    return error(rt);
+                };
+            }
+            settlePromise(jsInvoker_, std::move(promise), std::move(builder));
+        });
+    });
+}
+
+jsi::Value NativeOpusTurboModule::appendWavData(jsi::Runtime &rt, double handle, jsi::Object pcm) {
+    std::shared_ptr<WavWriterEntry> entry = findEntry(wavWriters, handle);
+    if (!entry) {
+        return resolvedPromise(rt, errorResult("Unknown WAV writer handle"));
+    }
+
+    // Snapshot the chunk; JS is free to reuse its buffer once we return.
+    auto chunk = std::make_shared<std::vector<uint8_t>>();
+    try {
+        const uint8_t* bytes = nullptr;
+        size_t size = 0;
+        getPacketBytes(rt, pcm, bytes, size);
+        chunk->assign(bytes, bytes + size);
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+
+    return runOnSession<rnopus::WavWriter>(rt, entry, "Unknown WAV writer handle", [chunk](rnopus::WavWriter& writer) {
+        writer.append(chunk->data(), chunk->size());
+        return successResult();
+    });
+}
+
+// Patches the header, closes the file and releases the handle.
+jsi::Value NativeOpusTurboModule::finalizeWavWriter(jsi::Runtime &rt, double handle) {
+    std::shared_ptr<WavWriterEntry> entry = findEntry(wavWriters, handle);
+    wavWriters.erase(static_cast<int>(handle));
+
+    return runOnSession<rnopus::WavWriter>(rt, entry, "Unknown WAV writer handle", [](rnopus::WavWriter& writer) -> ResultBuilder {
+        writer.finalize();
+        std::string filepath = writer.path();
+        double dataBytes = static_cast<double>(writer.dataBytes());
+        double durationMs = 1000.0 * writer.frames() / writer.sampleRate();
+        return [filepath, dataBytes, durationMs](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "filepath", jsi::String::createFromUtf8(rt, filepath));
+            result.setProperty(rt, "dataBytes", dataBytes);
+            result.setProperty(rt, "durationMs", durationMs);
+            return result;
+        };
+    });
+}
+
+// Jitter buffers: packets go in as they arrive from the network, PCM comes
+// out in fixed-size pulls on the audio clock. Both run on the buffer's queue.
+jsi::Value NativeOpusTurboModule::createJitterBuffer(jsi::Runtime &rt, jsi::Object config) {
+    ResultBuilder builder;
+    try {
+        auto sampleRate = static_cast<opus_int32>(config.getProperty(rt, "sampleRate").asNumber());
+        int channels = static_cast<int>(config.getProperty(rt, "channels").asNumber());
+        rnopus::JitterBufferConfig bufferConfig;
+        jsi::Value minDelayMs = config.getProperty(rt, "minDelayMs");
+        if (minDelayMs.isNumber()) {
+            bufferConfig.minDelayMs = static_cast<int>(minDelayMs.getNumber());
         }
-        
-        // WAV Header constants
-        const char* RIFF = "RIFF";
-        const char* WAVE = "WAVE";
-        const char* FMT = "fmt ";
-        const char* DATA = "data";
-        
-        // WAV file header calculation
-        int sampleRateInt = static_cast<int>(sampleRate);
-        int channelsInt = static_cast<int>(channels);
-        int bitsPerSample = 16;  // PCM 16-bit
-        int byteRate = sampleRateInt * channelsInt * bitsPerSample / 8;
-        int blockAlign = channelsInt * bitsPerSample / 8;
-        int dataSize = decodedBytes.size();
-        int fileSize = 36 + dataSize;  // 36 is the size of the WAV header minus 8
-        
-        // Write WAV header
-        // RIFF chunk
-        fwrite(RIFF, 1, 4, file);
-        fwrite(&fileSize, 4, 1, file);
-        fwrite(WAVE, 1, 4, file);
-        
-        // fmt chunk
-        fwrite(FMT, 1, 4, file);
-        int fmtSize = 16;  // PCM format size
-        fwrite(&fmtSize, 4, 1, file);
-        short audioFormat = 1;  // PCM = 1
-        fwrite(&audioFormat, 2, 1, file);
-        fwrite(&channelsInt, 2, 1, file);
-        fwrite(&sampleRateInt, 4, 1, file);
-        fwrite(&byteRate, 4, 1, file);
-        fwrite(&blockAlign, 2, 1, file);
-        fwrite(&bitsPerSample, 2, 1, file);
-        
-        // data chunk
-        fwrite(DATA, 1, 4, file);
-        fwrite(&dataSize, 4, 1, file);
-        
-        // Write the actual PCM data
-        fwrite(decodedBytes.data(), 1, decodedBytes.size(), file);
-        
-        fclose(file);
-        
+        jsi::Value maxDelayMs = config.getProperty(rt, "maxDelayMs");
+        if (maxDelayMs.isNumber()) {
+            bufferConfig.maxDelayMs = static_cast<int>(maxDelayMs.getNumber());
+        }
+        jsi::Value dred = config.getProperty(rt, "dred");
+        bufferConfig.dred = dred.isBool() && dred.getBool();
+        auto entry = makeEntry(std::make_shared<rnopus::JitterBuffer>(sampleRate, channels, bufferConfig));
+        int handle = nextHandle++;
+        jitterBuffers[handle] = std::move(entry);
+        builder = handleResult(handle);
+    } catch (const std::exception& e) {
+        builder = errorResult(e.what());
+    }
+    return resolvedPromise(rt, std::move(builder));
+}
+
+// Every packet in one call shares the arrival time taken here, on the JS
+// thread, so queueing delay on the worker does not count as jitter.
+jsi::Value NativeOpusTurboModule::pushJitterPackets(jsi::Runtime &rt, double handle, jsi::Object packets, jsi::Object options) {
+    std::shared_ptr<JitterBufferEntry> entry = findEntry(jitterBuffers, handle);
+    if (!entry) {
+        return resolvedPromise(rt, errorResult("Unknown jitter buffer handle"));
+    }
+
+    double arrivalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    auto input = std::make_shared<std::vector<uint8_t>>();
+    auto framing = std::make_shared<rnopus::FramingOptions>();
+    auto sequence = std::make_shared<std::vector<uint32_t>>();
+    auto timestamps = std::make_shared<std::vector<int64_t>>();
+    try {
+        const uint8_t* inputBytes = nullptr;
+        size_t inputSize = 0;
+        getPacketBytes(rt, packets, inputBytes, inputSize);
+        input->assign(inputBytes, inputBytes + inputSize);
+        *framing = parseFramingOptions(rt, options);
+        *sequence = parseDecodeOptions(rt, options).sequenceNumbers;
+
+        jsi::Value timestampValue = options.getProperty(rt, "timestamps");
+        if (timestampValue.isObject() && timestampValue.getObject(rt).isArray(rt)) {
+            jsi::Array values = timestampValue.getObject(rt).getArray(rt);
+            size_t count = values.size(rt);
+            timestamps->reserve(count);
+            for (size_t i = 0; i < count; i++) {
+                timestamps->push_back(static_cast<int64_t>(values.getValueAtIndex(rt, i).asNumber()));
+            }
+        }
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+
+    return runOnSession<rnopus::JitterBuffer>(rt, entry, "Unknown jitter buffer handle",
+                                              [input, framing, sequence, timestamps, arrivalMs](rnopus::JitterBuffer& buffer) {
+        rnopus::PacketList list = rnopus::splitPackets(input->data(), input->size(), *framing);
+        if (sequence->size() != list.packets.size()) {
+            return errorResult("Expected one sequence number per packet");
+        }
+        if (!timestamps->empty() && timestamps->size() != list.packets.size()) {
+            return errorResult("Expected one timestamp per packet");
+        }
+        for (size_t i = 0; i < list.packets.size(); i++) {
+            const rnopus::PacketView& packet = list.packets[i];
+            int64_t timestamp = timestamps->empty() ? -1 : (*timestamps)[i];
+            buffer.push((*sequence)[i], timestamp, packet.data, packet.size, arrivalMs);
+        }
+        return successResult();
+    });
+}
+
+jsi::Value NativeOpusTurboModule::pullJitterAudio(jsi::Runtime &rt, double handle, jsi::Object options) {
+    double durationMs = 0;
+    rnopus::SampleFormat format = rnopus::SampleFormat::Int16;
+    try {
+        durationMs = options.getProperty(rt, "durationMs").asNumber();
+        format = parseSampleFormat(rt, options);
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+
+    return runOnSession<rnopus::JitterBuffer>(rt, findEntry(jitterBuffers, handle), "Unknown jitter buffer handle",
+                                              [durationMs, format](rnopus::JitterBuffer& buffer) -> ResultBuilder {
+        int frames = static_cast<int>(durationMs * buffer.sampleRate() / 1000);
+        if (frames <= 0 || durationMs > 1000) {
+            return errorResult("durationMs must be between 0 and 1000");
+        }
+
+        auto pcm = std::make_shared<std::vector<opus_int16>>();
+        auto pcmFloat = std::make_shared<std::vector<float>>();
+        size_t count = static_cast<size_t>(frames) * buffer.channels();
+        bool playing = false;
+        if (format == rnopus::SampleFormat::Float32) {
+            pcmFloat->resize(count);
+            playing = buffer.pull(pcmFloat->data(), frames);
+        } else {
+            pcm->resize(count);
+            playing = buffer.pull(pcm->data(), frames);
+        }
+        rnopus::JitterBufferStats stats = buffer.stats();
+
+        return [format, pcm, pcmFloat, playing, stats](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "pcm", format == rnopus::SampleFormat::Float32
+                ? pcmArray(rt, std::move(*pcmFloat))
+                : pcmArray(rt, std::move(*pcm)));
+            result.setProperty(rt, "buffering", !playing);
+            result.setProperty(rt, "stats", jitterStatsObject(rt, stats));
+            return result;
+        };
+    });
+}
+
+jsi::Value NativeOpusTurboModule::getJitterStats(jsi::Runtime &rt, double handle) {
+    return runOnSession<rnopus::JitterBuffer>(rt, findEntry(jitterBuffers, handle), "Unknown jitter buffer handle",
+                                              [](rnopus::JitterBuffer& buffer) -> ResultBuilder {
+        rnopus::JitterBufferStats stats = buffer.stats();
+        return [stats](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jitterStatsObject(rt, stats);
+            result.setProperty(rt, "success", true);
+            return result;
+        };
+    });
+}
+
+jsi::Value NativeOpusTurboModule::resetJitterBuffer(jsi::Runtime &rt, double handle) {
+    return runOnSession<rnopus::JitterBuffer>(rt, findEntry(jitterBuffers, handle), "Unknown jitter buffer handle",
+                                              [](rnopus::JitterBuffer& buffer) {
+        buffer.reset();
+        return successResult();
+    });
+}
+
+jsi::Value NativeOpusTurboModule::destroyJitterBuffer(jsi::Runtime &rt, double handle) {
+    std::shared_ptr<JitterBufferEntry> entry = findEntry(jitterBuffers, handle);
+    jitterBuffers.erase(static_cast<int>(handle));
+    return runOnSession<rnopus::JitterBuffer>(rt, entry, "Unknown jitter buffer handle", [](rnopus::JitterBuffer&) {
+        return successResult();
+    });
+}
+
+// Encoder sessions: PCM in, packets out, on the session's queue.
+jsi::Value NativeOpusTurboModule::createEncoder(jsi::Runtime &rt, jsi::Object config) {
+    ResultBuilder builder;
+    try {
+        auto entry = makeEntry(std::make_shared<rnopus::EncoderSession>(parseEncoderConfig(rt, config)));
+        int handle = nextHandle++;
+        int frameSize = entry->session->frameSize();
+        int lookahead = entry->session->lookahead();
+        encoders[handle] = std::move(entry);
+        builder = [handle, frameSize, lookahead](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "handle", handle);
+            result.setProperty(rt, "frameSize", frameSize);
+            result.setProperty(rt, "lookahead", lookahead);
+            return result;
+        };
+    } catch (const std::exception& e) {
+        builder = errorResult(e.what());
+    }
+    return resolvedPromise(rt, std::move(builder));
+}
+
+// A Float32Array goes through opus_encode_float; anything else is read as
+// 16-bit samples.
+jsi::Value NativeOpusTurboModule::encodeWithEncoder(jsi::Runtime &rt, double handle, jsi::Object pcm, jsi::Object options) {
+    std::shared_ptr<EncoderEntry> entry = findEntry(encoders, handle);
+    if (!entry) {
+        return resolvedPromise(rt, errorResult("Unknown encoder handle"));
+    }
+
+    auto samples = std::make_shared<std::vector<uint8_t>>();
+    bool isFloat = false;
+    rnopus::Framing framing = rnopus::Framing::U16;
+    try {
+        isFloat = pcm.instanceOf(rt, rt.global().getPropertyAsFunction(rt, "Float32Array"));
+        const uint8_t* bytes = nullptr;
+        size_t size = 0;
+        getPacketBytes(rt, pcm, bytes, size);
+        samples->assign(bytes, bytes + size);
+        framing = parseOutputFraming(rt, options);
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+
+    return runOnSession<rnopus::EncoderSession>(rt, entry, "Unknown encoder handle", [samples, isFloat, framing](rnopus::EncoderSession& session) {
+        size_t channels = static_cast<size_t>(session.channels());
+        if (isFloat) {
+            const float* data = reinterpret_cast<const float*>(samples->data());
+            size_t frames = samples->size() / sizeof(float) / channels;
+            return encodeResult(session.encode(data, frames, framing));
+        }
+        const opus_int16* data = reinterpret_cast<const opus_int16*>(samples->data());
+        size_t frames = samples->size() / sizeof(opus_int16) / channels;
+        return encodeResult(session.encode(data, frames, framing));
+    });
+}
+
+jsi::Value NativeOpusTurboModule::resetEncoder(jsi::Runtime &rt, double handle) {
+    return runOnSession<rnopus::EncoderSession>(rt, findEntry(encoders, handle), "Unknown encoder handle", [](rnopus::EncoderSession& session) {
+        int error = session.reset();
+        return error == OPUS_OK ? successResult() : errorResult(opus_strerror(error));
+    });
+}
+
+jsi::Value NativeOpusTurboModule::destroyEncoder(jsi::Runtime &rt, double handle) {
+    std::shared_ptr<EncoderEntry> entry = findEntry(encoders, handle);
+    encoders.erase(static_cast<int>(handle));
+    return runOnSession<rnopus::EncoderSession>(rt, entry, "Unknown encoder handle", [](rnopus::EncoderSession&) {
+        return successResult();
+    });
+}
+
+jsi::Value NativeOpusTurboModule::getEncoderStats(jsi::Runtime &rt, double handle) {
+    return runOnSession<rnopus::EncoderSession>(rt, findEntry(encoders, handle), "Unknown encoder handle", [](rnopus::EncoderSession& session) -> ResultBuilder {
+        rnopus::EncoderStats stats = session.stats();
+        opus_int32 sampleRate = session.sampleRate();
+        int channels = session.channels();
+        return [stats, sampleRate, channels](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "sampleRate", static_cast<double>(sampleRate));
+            result.setProperty(rt, "channels", channels);
+            result.setProperty(rt, "encodeCalls", static_cast<double>(stats.encodeCalls));
+            result.setProperty(rt, "packetsEncoded", static_cast<double>(stats.packetsEncoded));
+            result.setProperty(rt, "bytesEncoded", static_cast<double>(stats.bytesEncoded));
+            result.setProperty(rt, "samplesEncoded", static_cast<double>(stats.samplesEncoded));
+            result.setProperty(rt, "processingTimeMs", stats.processingTimeMs);
+            return result;
+        };
+    });
+}
+
+// Streaming encoders for live audio: PCM is pushed in whatever chunks the
+// recorder delivers, packets are pulled as soon as they are ready.
+jsi::Value NativeOpusTurboModule::createStreamEncoder(jsi::Runtime &rt, jsi::Object config) {
+    ResultBuilder builder;
+    try {
+        rnopus::StreamEncoderConfig streamConfig;
+        streamConfig.encoder = parseEncoderConfig(rt, config);
+        jsi::Value minBitrate = config.getProperty(rt, "minBitrate");
+        if (minBitrate.isNumber()) {
+            streamConfig.minBitrate = static_cast<int>(minBitrate.getNumber());
+        }
+        jsi::Value maxBitrate = config.getProperty(rt, "maxBitrate");
+        if (maxBitrate.isNumber()) {
+            streamConfig.maxBitrate = static_cast<int>(maxBitrate.getNumber());
+        }
+        jsi::Value maxQueueMs = config.getProperty(rt, "maxQueueMs");
+        if (maxQueueMs.isNumber()) {
+            streamConfig.maxQueueMs = static_cast<int>(maxQueueMs.getNumber());
+        }
+
+        auto entry = makeEntry(std::make_shared<rnopus::StreamEncoder>(streamConfig));
+        int handle = nextHandle++;
+        int frameSize = entry->session->frameSize();
+        int lookahead = entry->session->lookahead();
+        streamEncoders[handle] = std::move(entry);
+        builder = [handle, frameSize, lookahead](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "handle", handle);
+            result.setProperty(rt, "frameSize", frameSize);
+            result.setProperty(rt, "lookahead", lookahead);
+            return result;
+        };
+    } catch (const std::exception& e) {
+        builder = errorResult(e.what());
+    }
+    return resolvedPromise(rt, std::move(builder));
+}
+
+jsi::Value NativeOpusTurboModule::pushStreamPcm(jsi::Runtime &rt, double handle, jsi::Object pcm) {
+    std::shared_ptr<StreamEncoderEntry> entry = findEntry(streamEncoders, handle);
+    if (!entry) {
+        return resolvedPromise(rt, errorResult("Unknown stream encoder handle"));
+    }
+
+    auto samples = std::make_shared<std::vector<uint8_t>>();
+    bool isFloat = false;
+    try {
+        isFloat = pcm.instanceOf(rt, rt.global().getPropertyAsFunction(rt, "Float32Array"));
+        const uint8_t* bytes = nullptr;
+        size_t size = 0;
+        getPacketBytes(rt, pcm, bytes, size);
+        samples->assign(bytes, bytes + size);
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+
+    return runOnSession<rnopus::StreamEncoder>(rt, entry, "Unknown stream encoder handle", [samples, isFloat](rnopus::StreamEncoder& encoder) -> ResultBuilder {
+        size_t channels = static_cast<size_t>(encoder.channels());
+        if (isFloat) {
+            encoder.push(reinterpret_cast<const float*>(samples->data()), samples->size() / sizeof(float) / channels);
+        } else {
+            encoder.push(reinterpret_cast<const opus_int16*>(samples->data()), samples->size() / sizeof(opus_int16) / channels);
+        }
+        double packetsQueued = static_cast<double>(encoder.stats().packetsQueued);
+        return [packetsQueued](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "packetsQueued", packetsQueued);
+            return result;
+        };
+    });
+}
+
+jsi::Value NativeOpusTurboModule::pullStreamPackets(jsi::Runtime &rt, double handle, jsi::Object options) {
+    rnopus::Framing framing = rnopus::Framing::U16;
+    try {
+        framing = parseOutputFraming(rt, options);
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+    return runOnSession<rnopus::StreamEncoder>(rt, findEntry(streamEncoders, handle), "Unknown stream encoder handle", [framing](rnopus::StreamEncoder& encoder) {
+        rnopus::EncodeResult encoded;
+        encoder.pull(encoded, framing);
+        return encodeResult(std::move(encoded));
+    });
+}
+
+// Encodes the buffered partial frame (padded with silence) and pulls
+jsi::Value NativeOpusTurboModule::flushStreamEncoder(jsi::Runtime &rt, double handle, jsi::Object options) {
+    rnopus::Framing framing = rnopus::Framing::U16;
+    try {
+        framing = parseOutputFraming(rt, options);
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+    return runOnSession<rnopus::StreamEncoder>(rt, findEntry(streamEncoders, handle), "Unknown stream encoder handle", [framing](rnopus::StreamEncoder& encoder) {
+        encoder.flush();
+        rnopus::EncodeResult encoded;
+        encoder.pull(encoded, framing);
+        return encodeResult(std::move(encoded));
+    });
+}
+
+jsi::Value NativeOpusTurboModule::updateStreamNetwork(jsi::Runtime &rt, double handle, jsi::Object feedback) {
+    double lossPercent = 0;
+    double rttMs = 0;
+    try {
+        lossPercent = feedback.getProperty(rt, "lossPercent").asNumber();
+        jsi::Value rtt = feedback.getProperty(rt, "rttMs");
+        if (rtt.isNumber()) {
+            rttMs = rtt.getNumber();
+        }
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+    return runOnSession<rnopus::StreamEncoder>(rt, findEntry(streamEncoders, handle), "Unknown stream encoder handle", [lossPercent, rttMs](rnopus::StreamEncoder& encoder) -> ResultBuilder {
+        encoder.updateNetwork(lossPercent, rttMs);
+        rnopus::StreamEncoderStats stats = encoder.stats();
+        return [stats](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "bitrate", stats.bitrate);
+            result.setProperty(rt, "packetLossPercent", stats.packetLossPercent);
+            result.setProperty(rt, "fec", stats.fec);
+            return result;
+        };
+    });
+}
+
+jsi::Value NativeOpusTurboModule::getStreamEncoderStats(jsi::Runtime &rt, double handle) {
+    return runOnSession<rnopus::StreamEncoder>(rt, findEntry(streamEncoders, handle), "Unknown stream encoder handle", [](rnopus::StreamEncoder& encoder) -> ResultBuilder {
+        rnopus::StreamEncoderStats stats = encoder.stats();
+        return [stats](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "packetsEncoded", static_cast<double>(stats.packetsEncoded));
+            result.setProperty(rt, "packetsDropped", static_cast<double>(stats.packetsDropped));
+            result.setProperty(rt, "bytesEncoded", static_cast<double>(stats.bytesEncoded));
+            result.setProperty(rt, "samplesPushed", static_cast<double>(stats.samplesPushed));
+            result.setProperty(rt, "framesBuffered", static_cast<double>(stats.framesBuffered));
+            result.setProperty(rt, "packetsQueued", static_cast<double>(stats.packetsQueued));
+            result.setProperty(rt, "bitrate", stats.bitrate);
+            result.setProperty(rt, "packetLossPercent", stats.packetLossPercent);
+            result.setProperty(rt, "fec", stats.fec);
+            return result;
+        };
+    });
+}
+
+jsi::Value NativeOpusTurboModule::destroyStreamEncoder(jsi::Runtime &rt, double handle) {
+    std::shared_ptr<StreamEncoderEntry> entry = findEntry(streamEncoders, handle);
+    streamEncoders.erase(static_cast<int>(handle));
+    return runOnSession<rnopus::StreamEncoder>(rt, entry, "Unknown stream encoder handle", [](rnopus::StreamEncoder&) {
+        return successResult();
+    });
+}
+
+// PCM rings live outside any queue: their counters are atomics, so stats are
+// read straight from the JS thread.
+jsi::Value NativeOpusTurboModule::createPcmRing(jsi::Runtime &rt, jsi::Object config) {
+    ResultBuilder builder;
+    try {
+        int channels = static_cast<int>(config.getProperty(rt, "channels").asNumber());
+        double capacityFrames = 0;
+        jsi::Value frames = config.getProperty(rt, "capacityFrames");
+        if (frames.isNumber()) {
+            capacityFrames = frames.getNumber();
+        } else {
+            jsi::Value sampleRate = config.getProperty(rt, "sampleRate");
+            jsi::Value capacityMs = config.getProperty(rt, "capacityMs");
+            double rate = sampleRate.isNumber() ? sampleRate.getNumber() : 48000;
+            capacityFrames = rate * (capacityMs.isNumber() ? capacityMs.getNumber() : 200) / 1000;
+        }
+        if (!(capacityFrames >= 1)) {
+            throw std::invalid_argument("Ring capacity must be at least one frame");
+        }
+        auto ring = std::make_shared<rnopus::PcmRingBuffer>(static_cast<size_t>(capacityFrames), channels);
+        int handle = nextHandle++;
+        rnopus::registerPcmRing(handle, ring);
+        pcmRings[handle] = ring;
+        size_t capacity = ring->capacityFrames();
+        builder = [handle, capacity](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "handle", handle);
+            result.setProperty(rt, "capacityFrames", static_cast<double>(capacity));
+            return result;
+        };
+    } catch (const std::exception& e) {
+        builder = errorResult(e.what());
+    }
+    return resolvedPromise(rt, std::move(builder));
+}
+
+jsi::Value NativeOpusTurboModule::getPcmRingStats(jsi::Runtime &rt, double handle) {
+    auto it = pcmRings.find(static_cast<int>(handle));
+    if (it == pcmRings.end()) {
+        return resolvedPromise(rt, errorResult("Unknown PCM ring handle"));
+    }
+    rnopus::PcmRingStats stats = it->second->stats();
+    return resolvedPromise(rt, [stats](jsi::Runtime &rt) -> jsi::Value {
+        jsi::Object result = jsi::Object(rt);
         result.setProperty(rt, "success", true);
-        result.setProperty(rt, "filepath", jsi::String::createFromUtf8(rt, filepath));
-        
+        result.setProperty(rt, "capacityFrames", static_cast<double>(stats.capacityFrames));
+        result.setProperty(rt, "fillFrames", static_cast<double>(stats.fillFrames));
+        result.setProperty(rt, "framesWritten", static_cast<double>(stats.framesWritten));
+        result.setProperty(rt, "framesRead", static_cast<double>(stats.framesRead));
+        result.setProperty(rt, "framesDropped", static_cast<double>(stats.framesDropped));
+        result.setProperty(rt, "underruns", static_cast<double>(stats.underruns));
+        result.setProperty(rt, "underrunFrames", static_cast<double>(stats.underrunFrames));
+        return result;
+    });
+}
+
+// Native consumers and queued decodes keep their own reference, so the ring
+// outlives the handle until they let go.
+jsi::Value NativeOpusTurboModule::destroyPcmRing(jsi::Runtime &rt, double handle) {
+    if (pcmRings.erase(static_cast<int>(handle)) == 0) {
+        return resolvedPromise(rt, errorResult("Unknown PCM ring handle"));
+    }
+    pcmRingProducers.erase(static_cast<int>(handle));
+    rnopus::unregisterPcmRing(static_cast<int>(handle));
+    return resolvedPromise(rt, successResult());
+}
+
+// Stream decoders: bytes in any chunking, PCM for every packet completed so far.
+jsi::Value NativeOpusTurboModule::createStreamDecoder(jsi::Runtime &rt, jsi::Object config) {
+    ResultBuilder builder;
+    try {
+        auto sampleRate = static_cast<opus_int32>(config.getProperty(rt, "sampleRate").asNumber());
+        int channels = static_cast<int>(config.getProperty(rt, "channels").asNumber());
+        rnopus::FramingOptions framing = parseFramingOptions(rt, config);
+        auto entry = makeEntry(std::make_shared<rnopus::StreamDecoder>(sampleRate, channels, framing));
+        int handle = nextHandle++;
+        streamDecoders[handle] = std::move(entry);
+        builder = handleResult(handle);
     } catch (const std::exception& e) {
-        result.setProperty(rt, "success", false);
-        result.setProperty(rt, "error", jsi::String::createFromUtf8(rt, e.what()));
+        builder = errorResult(e.what());
     }
-    
-    return result;
+    return resolvedPromise(rt, std::move(builder));
+}
+
+jsi::Value NativeOpusTurboModule::feedStreamDecoder(jsi::Runtime &rt, double handle, jsi::Object bytes, jsi::Object options) {
+    std::shared_ptr<StreamDecoderEntry> entry = findEntry(streamDecoders, handle);
+    if (!entry) {
+        return resolvedPromise(rt, errorResult("Unknown stream decoder handle"));
+    }
+    auto input = std::make_shared<std::vector<uint8_t>>();
+    auto decodeOptions = std::make_shared<rnopus::DecodeOptions>();
+    try {
+        const uint8_t* inputBytes = nullptr;
+        size_t inputSize = 0;
+        getPacketBytes(rt, bytes, inputBytes, inputSize);
+        input->assign(inputBytes, inputBytes + inputSize);
+        *decodeOptions = parseDecodeOptions(rt, options);
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+
+    return runOnSession<rnopus::StreamDecoder>(rt, entry, "Unknown stream decoder handle", [input, decodeOptions](rnopus::StreamDecoder& decoder) -> ResultBuilder {
+        ResultBuilder pcm = pcmResult(decoder.feed(input->data(), input->size(), *decodeOptions));
+        size_t pendingBytes = decoder.pendingBytes();
+        return [pcm = std::move(pcm), pendingBytes](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = pcm(rt).getObject(rt);
+            result.setProperty(rt, "pendingBytes", static_cast<double>(pendingBytes));
+            return result;
+        };
+    });
+}
+
+jsi::Value NativeOpusTurboModule::resetStreamDecoder(jsi::Runtime &rt, double handle) {
+    return runOnSession<rnopus::StreamDecoder>(rt, findEntry(streamDecoders, handle), "Unknown stream decoder handle", [](rnopus::StreamDecoder& decoder) {
+        decoder.reset();
+        return successResult();
+    });
+}
+
+jsi::Value NativeOpusTurboModule::destroyStreamDecoder(jsi::Runtime &rt, double handle) {
+    std::shared_ptr<StreamDecoderEntry> entry = findEntry(streamDecoders, handle);
+    streamDecoders.erase(static_cast<int>(handle));
+    return runOnSession<rnopus::StreamDecoder>(rt, entry, "Unknown stream decoder handle", [](rnopus::StreamDecoder&) {
+        return successResult();
+    });
+}
+
+// Multistream sessions: surround and other multichannel layouts.
+jsi::Value NativeOpusTurboModule::createMultistreamDecoder(jsi::Runtime &rt, jsi::Object config) {
+    ResultBuilder builder;
+    try {
+        jsi::Value sampleRateValue = config.getProperty(rt, "sampleRate");
+        auto sampleRate = sampleRateValue.isNumber() ? static_cast<opus_int32>(sampleRateValue.getNumber()) : 48000;
+        auto session = std::make_shared<rnopus::MultistreamDecoderSession>(sampleRate, parseChannelLayout(rt, config));
+        int channels = session->channels();
+        int streamCount = session->streamCount();
+        int coupledCount = session->coupledCount();
+        int handle = nextHandle++;
+        multistreamDecoders[handle] = makeEntry(std::move(session));
+        builder = [handle, channels, streamCount, coupledCount](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "handle", handle);
+            result.setProperty(rt, "channels", channels);
+            result.setProperty(rt, "streamCount", streamCount);
+            result.setProperty(rt, "coupledCount", coupledCount);
+            return result;
+        };
+    } catch (const std::exception& e) {
+        builder = errorResult(e.what());
+    }
+    return resolvedPromise(rt, std::move(builder));
+}
+
+jsi::Value NativeOpusTurboModule::decodeWithMultistreamDecoder(jsi::Runtime &rt, double handle, jsi::Object packets, jsi::Object options) {
+    std::shared_ptr<MultistreamDecoderEntry> entry = findEntry(multistreamDecoders, handle);
+    if (!entry) {
+        return resolvedPromise(rt, errorResult("Unknown multistream decoder handle"));
+    }
+    auto input = std::make_shared<std::vector<uint8_t>>();
+    auto framing = std::make_shared<rnopus::FramingOptions>();
+    auto decodeOptions = std::make_shared<rnopus::DecodeOptions>();
+    bool planar = false;
+    try {
+        const uint8_t* inputBytes = nullptr;
+        size_t inputSize = 0;
+        getPacketBytes(rt, packets, inputBytes, inputSize);
+        input->assign(inputBytes, inputBytes + inputSize);
+        *framing = parseFramingOptions(rt, options);
+        *decodeOptions = parseDecodeOptions(rt, options);
+        jsi::Value planarValue = options.getProperty(rt, "planar");
+        planar = planarValue.isBool() && planarValue.getBool();
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+
+    return runOnSession<rnopus::MultistreamDecoderSession>(rt, entry, "Unknown multistream decoder handle",
+                                                           [input, framing, decodeOptions, planar](rnopus::MultistreamDecoderSession& session) -> ResultBuilder {
+        ResultBuilder pcm = pcmResult(session.decode(input->data(), input->size(), *framing, *decodeOptions, planar));
+        int channels = session.channels();
+        return [pcm = std::move(pcm), channels, planar](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = pcm(rt).getObject(rt);
+            result.setProperty(rt, "channels", channels);
+            result.setProperty(rt, "planar", planar);
+            return result;
+        };
+    });
+}
+
+jsi::Value NativeOpusTurboModule::resetMultistreamDecoder(jsi::Runtime &rt, double handle) {
+    return runOnSession<rnopus::MultistreamDecoderSession>(rt, findEntry(multistreamDecoders, handle), "Unknown multistream decoder handle",
+                                                           [](rnopus::MultistreamDecoderSession& session) {
+        int error = session.reset();
+        return error == OPUS_OK ? successResult() : errorResult(opus_strerror(error));
+    });
+}
+
+jsi::Value NativeOpusTurboModule::destroyMultistreamDecoder(jsi::Runtime &rt, double handle) {
+    std::shared_ptr<MultistreamDecoderEntry> entry = findEntry(multistreamDecoders, handle);
+    multistreamDecoders.erase(static_cast<int>(handle));
+    return runOnSession<rnopus::MultistreamDecoderSession>(rt, entry, "Unknown multistream decoder handle",
+                                                           [](rnopus::MultistreamDecoderSession&) {
+        return successResult();
+    });
+}
+
+// Projection sessions: ambisonics (mapping family 3), optionally rendered
+// to binaural stereo.
+jsi::Value NativeOpusTurboModule::createProjectionDecoder(jsi::Runtime &rt, jsi::Object config) {
+    ResultBuilder builder;
+    try {
+        jsi::Value sampleRateValue = config.getProperty(rt, "sampleRate");
+        auto sampleRate = sampleRateValue.isNumber() ? static_cast<opus_int32>(sampleRateValue.getNumber()) : 48000;
+        auto session = std::make_shared<rnopus::ProjectionDecoderSession>(sampleRate, parseProjectionLayout(rt, config));
+        jsi::Value binaural = config.getProperty(rt, "binaural");
+        if (binaural.isBool() && binaural.getBool()) {
+            session->enableBinaural(parseBinauralFilters(rt, config));
+        }
+        int channels = session->outputChannels();
+        int handle = nextHandle++;
+        projectionDecoders[handle] = makeEntry(std::move(session));
+        builder = [handle, channels](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = jsi::Object(rt);
+            result.setProperty(rt, "success", true);
+            result.setProperty(rt, "handle", handle);
+            result.setProperty(rt, "channels", channels);
+            return result;
+        };
+    } catch (const std::exception& e) {
+        builder = errorResult(e.what());
+    }
+    return resolvedPromise(rt, std::move(builder));
+}
+
+jsi::Value NativeOpusTurboModule::decodeWithProjectionDecoder(jsi::Runtime &rt, double handle, jsi::Object packets, jsi::Object options) {
+    std::shared_ptr<ProjectionDecoderEntry> entry = findEntry(projectionDecoders, handle);
+    if (!entry) {
+        return resolvedPromise(rt, errorResult("Unknown projection decoder handle"));
+    }
+    auto input = std::make_shared<std::vector<uint8_t>>();
+    auto framing = std::make_shared<rnopus::FramingOptions>();
+    auto decodeOptions = std::make_shared<rnopus::DecodeOptions>();
+    try {
+        const uint8_t* inputBytes = nullptr;
+        size_t inputSize = 0;
+        getPacketBytes(rt, packets, inputBytes, inputSize);
+        input->assign(inputBytes, inputBytes + inputSize);
+        *framing = parseFramingOptions(rt, options);
+        *decodeOptions = parseDecodeOptions(rt, options);
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+
+    return runOnSession<rnopus::ProjectionDecoderSession>(rt, entry, "Unknown projection decoder handle",
+                                                          [input, framing, decodeOptions](rnopus::ProjectionDecoderSession& session) -> ResultBuilder {
+        ResultBuilder pcm = pcmResult(session.decode(input->data(), input->size(), *framing, *decodeOptions));
+        int channels = session.outputChannels();
+        return [pcm = std::move(pcm), channels](jsi::Runtime &rt) -> jsi::Value {
+            jsi::Object result = pcm(rt).getObject(rt);
+            result.setProperty(rt, "channels", channels);
+            return result;
+        };
+    });
+}
+
+jsi::Value NativeOpusTurboModule::resetProjectionDecoder(jsi::Runtime &rt, double handle) {
+    return runOnSession<rnopus::ProjectionDecoderSession>(rt, findEntry(projectionDecoders, handle), "Unknown projection decoder handle",
+                                                          [](rnopus::ProjectionDecoderSession& session) {
+        int error = session.reset();
+        return error == OPUS_OK ? successResult() : errorResult(opus_strerror(error));
+    });
+}
+
+jsi::Value NativeOpusTurboModule::destroyProjectionDecoder(jsi::Runtime &rt, double handle) {
+    std::shared_ptr<ProjectionDecoderEntry> entry = findEntry(projectionDecoders, handle);
+    projectionDecoders.erase(static_cast<int>(handle));
+    return runOnSession<rnopus::ProjectionDecoderSession>(rt, entry, "Unknown projection decoder handle",
+                                                          [](rnopus::ProjectionDecoderSession&) {
+        return successResult();
+    });
+}
+
+// Repacketizing is stateless, so it runs straight on the pool with no queue.
+jsi::Value NativeOpusTurboModule::queueRepacketize(jsi::Runtime &rt, const jsi::Object& packets, const jsi::Object& options, RepacketizeWork work) {
+    auto input = std::make_shared<std::vector<uint8_t>>();
+    rnopus::FramingOptions framing;
+    rnopus::Framing outputFraming = rnopus::Framing::U16;
+    try {
+        const uint8_t* inputBytes = nullptr;
+        size_t inputSize = 0;
+        getPacketBytes(rt, packets, inputBytes, inputSize);
+        input->assign(inputBytes, inputBytes + inputSize);
+        framing = parseFramingOptions(rt, options);
+        outputFraming = parseConvertedFraming(rt, options, framing.framing);
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+
+    return makePromise(rt, [this, input, framing = std::move(framing), outputFraming, work = std::move(work)](std::shared_ptr<PromiseHandle> promise) {
+        workerPool->submit([this, input, framing, outputFraming, work, promise = std::move(promise)]() mutable {
+            ResultBuilder builder;
+            try {
+                rnopus::PacketList list = rnopus::splitPackets(input->data(), input->size(), framing);
+                rnopus::Repacketizer repacketizer;
+                builder = repacketizeResult(work(repacketizer, list.packets, outputFraming));
+            } catch (const std::exception& e) {
+                builder = errorResult(e.what());
+            }
+            settlePromise(jsInvoker_, std::move(promise), std::move(builder));
+        });
+    });
+}
+
+// Merges each run of `packetsPerGroup` packets (default: as many as fit in
+// 120 ms) into one.
+jsi::Value NativeOpusTurboModule::mergeOpusPackets(jsi::Runtime &rt, jsi::Object packets, jsi::Object options) {
+    int packetsPerGroup = 0;
+    try {
+        jsi::Value groupValue = options.getProperty(rt, "packetsPerGroup");
+        if (groupValue.isNumber()) {
+            packetsPerGroup = static_cast<int>(groupValue.getNumber());
+        }
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+    return queueRepacketize(rt, packets, options, [packetsPerGroup](rnopus::Repacketizer& repacketizer, const std::vector<rnopus::PacketView>& input, rnopus::Framing framing) {
+        return repacketizer.merge(input, packetsPerGroup, framing);
+    });
+}
+
+jsi::Value NativeOpusTurboModule::splitOpusPackets(jsi::Runtime &rt, jsi::Object packets, jsi::Object options) {
+    return queueRepacketize(rt, packets, options, [](rnopus::Repacketizer& repacketizer, const std::vector<rnopus::PacketView>& input, rnopus::Framing framing) {
+        return repacketizer.split(input, framing);
+    });
+}
+
+// Keeps `frameCount` frames (default: all) from `firstFrame` on, counted
+// across the whole packet stream.
+jsi::Value NativeOpusTurboModule::extractOpusFrames(jsi::Runtime &rt, jsi::Object packets, jsi::Object options) {
+    int64_t firstFrame = 0;
+    int64_t frameCount = -1;
+    try {
+        firstFrame = static_cast<int64_t>(options.getProperty(rt, "firstFrame").asNumber());
+        jsi::Value countValue = options.getProperty(rt, "frameCount");
+        if (countValue.isNumber()) {
+            frameCount = static_cast<int64_t>(countValue.getNumber());
+        }
+    } catch (const std::exception& e) {
+        return resolvedPromise(rt, errorResult(e.what()));
+    }
+    return queueRepacketize(rt, packets, options, [firstFrame, frameCount](rnopus::Repacketizer& repacketizer, const std::vector<rnopus::PacketView>& input, rnopus::Framing framing) {
+        return repacketizer.extractFrames(input, firstFrame, frameCount, framing);
+    });
 }
 
 } // namespace facebook::react
@@ -2,6 +2,9 @@
 
 #include <jsi/jsi.h>
 #include <ReactCommon/CallInvoker.h>
+#include <functional>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
@@ -22,23 +25,176 @@
 #error "Could not find opus.h"
 #endif
 
+#include "DecoderSession.h"
+#include "EncoderSession.h"
+#include "MultistreamDecoderSession.h"
+#include "ProjectionDecoderSession.h"
+#include "Repacketizer.h"
+#include "StreamDecoder.h"
+#include "StreamEncoder.h"
+#include "JitterBuffer.h"
+#include "PcmRingBuffer.h"
+#include "ThreadPool.h"
+#include "WavWriter.h"
+
 namespace facebook::react {
 class NativeOpusTurboModule: public NativeOpusTurboModuleCxxSpec<NativeOpusTurboModule> {
 public:
     static constexpr const char* kModuleName = "OpusTurbo";
+
+    // Produces a method's resolved value. Built on a worker thread, invoked
+    // on the JS thread.
+    using ResultBuilder = std::function<jsi::Value(jsi::Runtime&)>;
     
     NativeOpusTurboModule(std::shared_ptr<CallInvoker> jsInvoker);
     ~NativeOpusTurboModule();
     
     jsi::Value decodeMultipleOpusPackets(jsi::Runtime &rt, std::string packetsBase64, double packetSize);
+    jsi::Value decodeOpusPacketsBuffer(jsi::Runtime &rt, jsi::Object packets, jsi::Object options);
     jsi::Value resetDecoderState(jsi::Runtime &rt);
+    jsi::Value configureDefaultDecoder(jsi::Runtime &rt, jsi::Object config);
     jsi::Value saveDecodedDataAsWav(jsi::Runtime &rt, std::string decodedDataBase64, std::string filepath, double sampleRate, double channels);
 
+    jsi::Value createDecoder(jsi::Runtime &rt, jsi::Object config);
+    jsi::Value decodeWithDecoder(jsi::Runtime &rt, double handle, jsi::Object packets, jsi::Object options);
+    jsi::Value resetDecoder(jsi::Runtime &rt, double handle);
+    jsi::Value destroyDecoder(jsi::Runtime &rt, double handle);
+    jsi::Value getDecoderStats(jsi::Runtime &rt, double handle);
+    jsi::Value decodeOpusBatch(jsi::Runtime &rt, jsi::Array streams, jsi::Object options);
+
+    jsi::Value decodeOggOpusFile(jsi::Runtime &rt, std::string filepath, jsi::Object options);
+
+    jsi::Value mergeOpusPackets(jsi::Runtime &rt, jsi::Object packets, jsi::Object options);
+    jsi::Value splitOpusPackets(jsi::Runtime &rt, jsi::Object packets, jsi::Object options);
+    jsi::Value extractOpusFrames(jsi::Runtime &rt, jsi::Object packets, jsi::Object options);
+
+    jsi::Value decodeFileToWav(jsi::Runtime &rt, std::string inputPath, std::string outputPath, jsi::Object options);
+    jsi::Value padOpusPacketFile(jsi::Runtime &rt, std::string inputPath, std::string outputPath, jsi::Object options);
+    jsi::Value unpadOpusPacketFile(jsi::Runtime &rt, std::string inputPath, std::string outputPath, jsi::Object options);
+
+    jsi::Value openWavWriter(jsi::Runtime &rt, std::string filepath, jsi::Object config);
+    jsi::Value appendWavData(jsi::Runtime &rt, double handle, jsi::Object pcm);
+    jsi::Value finalizeWavWriter(jsi::Runtime &rt, double handle);
+
+    jsi::Value createJitterBuffer(jsi::Runtime &rt, jsi::Object config);
+    jsi::Value pushJitterPackets(jsi::Runtime &rt, double handle, jsi::Object packets, jsi::Object options);
+    jsi::Value pullJitterAudio(jsi::Runtime &rt, double handle, jsi::Object options);
+    jsi::Value getJitterStats(jsi::Runtime &rt, double handle);
+    jsi::Value resetJitterBuffer(jsi::Runtime &rt, double handle);
+    jsi::Value destroyJitterBuffer(jsi::Runtime &rt, double handle);
+
+    jsi::Value createEncoder(jsi::Runtime &rt, jsi::Object config);
+    jsi::Value encodeWithEncoder(jsi::Runtime &rt, double handle, jsi::Object pcm, jsi::Object options);
+    jsi::Value resetEncoder(jsi::Runtime &rt, double handle);
+    jsi::Value destroyEncoder(jsi::Runtime &rt, double handle);
+    jsi::Value getEncoderStats(jsi::Runtime &rt, double handle);
+
+    jsi::Value createStreamEncoder(jsi::Runtime &rt, jsi::Object config);
+    jsi::Value pushStreamPcm(jsi::Runtime &rt, double handle, jsi::Object pcm);
+    jsi::Value pullStreamPackets(jsi::Runtime &rt, double handle, jsi::Object options);
+    jsi::Value flushStreamEncoder(jsi::Runtime &rt, double handle, jsi::Object options);
+    jsi::Value updateStreamNetwork(jsi::Runtime &rt, double handle, jsi::Object feedback);
+    jsi::Value getStreamEncoderStats(jsi::Runtime &rt, double handle);
+    jsi::Value destroyStreamEncoder(jsi::Runtime &rt, double handle);
+
+    jsi::Value createPcmRing(jsi::Runtime &rt, jsi::Object config);
+    jsi::Value getPcmRingStats(jsi::Runtime &rt, double handle);
+    jsi::Value destroyPcmRing(jsi::Runtime &rt, double handle);
+
+    jsi::Value createStreamDecoder(jsi::Runtime &rt, jsi::Object config);
+    jsi::Value feedStreamDecoder(jsi::Runtime &rt, double handle, jsi::Object bytes, jsi::Object options);
+    jsi::Value resetStreamDecoder(jsi::Runtime &rt, double handle);
+    jsi::Value destroyStreamDecoder(jsi::Runtime &rt, double handle);
+
+    jsi::Value createMultistreamDecoder(jsi::Runtime &rt, jsi::Object config);
+    jsi::Value decodeWithMultistreamDecoder(jsi::Runtime &rt, double handle, jsi::Object packets, jsi::Object options);
+    jsi::Value resetMultistreamDecoder(jsi::Runtime &rt, double handle);
+    jsi::Value destroyMultistreamDecoder(jsi::Runtime &rt, double handle);
+
+    jsi::Value createProjectionDecoder(jsi::Runtime &rt, jsi::Object config);
+    jsi::Value decodeWithProjectionDecoder(jsi::Runtime &rt, double handle, jsi::Object packets, jsi::Object options);
+    jsi::Value resetProjectionDecoder(jsi::Runtime &rt, double handle);
+    jsi::Value destroyProjectionDecoder(jsi::Runtime &rt, double handle);
+
 private:
-    static std::string base64_encode(const std::vector<uint8_t>& input);
+    // A stateful native object plus the queue that serializes work on it
+    template <typename Session>
+    struct SessionEntry {
+        std::shared_ptr<Session> session;
+        std::shared_ptr<rnopus::SerialQueue> queue;
+    };
+
+    template <typename Session>
+    using SessionMap = std::unordered_map<int, std::shared_ptr<SessionEntry<Session>>>;
+
+    using DecoderEntry = SessionEntry<rnopus::DecoderSession>;
+    using WavWriterEntry = SessionEntry<rnopus::WavWriter>;
+    using JitterBufferEntry = SessionEntry<rnopus::JitterBuffer>;
+    using EncoderEntry = SessionEntry<rnopus::EncoderSession>;
+    using StreamEncoderEntry = SessionEntry<rnopus::StreamEncoder>;
+    using StreamDecoderEntry = SessionEntry<rnopus::StreamDecoder>;
+    using MultistreamDecoderEntry = SessionEntry<rnopus::MultistreamDecoderSession>;
+    using ProjectionDecoderEntry = SessionEntry<rnopus::ProjectionDecoderSession>;
+
+    template <typename Session>
+    std::shared_ptr<SessionEntry<Session>> makeEntry(std::shared_ptr<Session> session);
+    template <typename Session>
+    static std::shared_ptr<SessionEntry<Session>> findEntry(const SessionMap<Session>& sessions, double handle);
+    // Runs `work` on the entry's queue and resolves with the builder it
+    // returns. A null entry resolves with `missingError`.
+    template <typename Session>
+    jsi::Value runOnSession(jsi::Runtime &rt, std::shared_ptr<SessionEntry<Session>> entry, const char* missingError,
+                            std::function<ResultBuilder(Session&)> work);
+    jsi::Value resolvedPromise(jsi::Runtime &rt, ResultBuilder builder);
+
+    jsi::Value queueBufferDecode(jsi::Runtime &rt, std::shared_ptr<DecoderEntry> entry, const jsi::Object& packets, const jsi::Object& options);
+    ResultBuilder decodeBase64Packets(rnopus::DecoderSession& session, const std::string& packetsBase64, int packetSize);
+    using RepacketizeWork = std::function<rnopus::RepacketizeResult(rnopus::Repacketizer&, const std::vector<rnopus::PacketView>&, rnopus::Framing)>;
+    jsi::Value queueRepacketize(jsi::Runtime &rt, const jsi::Object& packets, const jsi::Object& options, RepacketizeWork work);
+    ResultBuilder decodeOggFile(const std::string& filepath, opus_int32 sampleRate, rnopus::SampleFormat format);
+    ResultBuilder writeWavFile(const std::string& decodedDataBase64, const std::string& filepath, double sampleRate, double channels);
+
+    static std::string base64_encode(const uint8_t* data, size_t size);
     static std::vector<uint8_t> base64_decode(const std::string& input);
         
-    OpusDecoder* opusDecoder = nullptr;
+    // Decoding runs off the JS thread. Work on each decoder goes through its
+    // own queue so calls keep their order and never overlap, while separate
+    // decoders run in parallel.
+    std::shared_ptr<rnopus::ThreadPool> workerPool;
+
+    // Module-wide decoder behind the legacy methods; null if creation failed.
+    // Starts at 16 kHz mono; configureDefaultDecoder swaps it.
+    std::shared_ptr<DecoderEntry> defaultDecoder;
+
+    // Sessions from createDecoder, keyed by handle. Only touched on the JS thread.
+    SessionMap<rnopus::DecoderSession> decoders;
+    // Streaming WAV files from openWavWriter
+    SessionMap<rnopus::WavWriter> wavWriters;
+    // Playout buffers from createJitterBuffer
+    SessionMap<rnopus::JitterBuffer> jitterBuffers;
+    // Sessions from createEncoder
+    SessionMap<rnopus::EncoderSession> encoders;
+    // Live encoders from createStreamEncoder
+    SessionMap<rnopus::StreamEncoder> streamEncoders;
+    // Rings from createPcmRing. They need no queue: the decoder writing into
+    // one is the producer and native audio code is the consumer.
+    std::unordered_map<int, std::shared_ptr<rnopus::PcmRingBuffer>> pcmRings;
+    // The decoder bound to each ring by its first ring decode. Rings are
+    // single-producer, so other decoders are refused until it is gone.
+    std::unordered_map<int, std::weak_ptr<DecoderEntry>> pcmRingProducers;
+    // Chunked packet streams from createStreamDecoder
+    SessionMap<rnopus::StreamDecoder> streamDecoders;
+    // Surround and other multichannel sessions from createMultistreamDecoder
+    SessionMap<rnopus::MultistreamDecoderSession> multistreamDecoders;
+    // Ambisonic sessions from createProjectionDecoder
+    SessionMap<rnopus::ProjectionDecoderSession> projectionDecoders;
+    // Handles are unique across every kind of session
+    int nextHandle = 1;
+    // Expires with the module. JS-thread callbacks that touch the session
+    // maps hold a weak reference, since they can run after the module is
+    // destroyed.
+    std::shared_ptr<bool> alive = std::make_shared<bool>(true);
+
     static constexpr opus_int32 DEFAULT_SAMPLE_RATE = 16000;
     static constexpr int DEFAULT_CHANNELS = 1;
 };
@@ -0,0 +1,369 @@
+#include "OggOpusReader.h"
+
+#include "MultistreamDecoderSession.h"
+#include "ProjectionDecoderSession.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace rnopus {
+
+namespace {
+
+constexpr size_t kPageHeaderSize = 27;
+constexpr uint8_t kContinuedPacket = 0x01;
+constexpr uint8_t kEndOfStream = 0x04;
+
+// Slice-by-4 tables: kCrcTables[k][i] is the CRC of byte i followed by k zero bytes.
+using CrcTables = std::array<std::array<uint32_t, 256>, 4>;
+
+CrcTables makeCrcTables() {
+    CrcTables tables{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i << 24;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80000000u) ? (crc << 1) ^ 0x04C11DB7u : crc << 1;
+        }
+        tables[0][i] = crc;
+    }
+    for (size_t k = 1; k < tables.size(); k++) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t previous = tables[k - 1][i];
+            tables[k][i] = (previous << 8) ^ tables[0][previous >> 24];
+        }
+    }
+    return tables;
+}
+
+const CrcTables& crcTables() {
+    static const CrcTables tables = makeCrcTables();
+    return tables;
+}
+
+uint16_t readLE16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t readLE32(const uint8_t* p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+int64_t readLE64(const uint8_t* p) {
+    return static_cast<int64_t>(uint64_t(readLE32(p)) | (uint64_t(readLE32(p + 4)) << 32));
+}
+
+OpusTags parseOpusTags(const uint8_t* data, size_t size) {
+    if (size < 16 || std::memcmp(data, "OpusTags", 8) != 0) {
+        throw std::runtime_error("Missing OpusTags header");
+    }
+    OpusTags tags;
+    size_t offset = 8;
+    uint32_t vendorLength = readLE32(data + offset);
+    offset += 4;
+    if (vendorLength > size - offset) {
+        throw std::runtime_error("Truncated OpusTags vendor string");
+    }
+    tags.vendor.assign(reinterpret_cast<const char*>(data + offset), vendorLength);
+    offset += vendorLength;
+
+    if (size - offset < 4) {
+        return tags;
+    }
+    uint32_t count = readLE32(data + offset);
+    offset += 4;
+    for (uint32_t i = 0; i < count && size - offset >= 4; i++) {
+        uint32_t length = readLE32(data + offset);
+        offset += 4;
+        if (length > size - offset) {
+            break;
+        }
+        tags.comments.emplace_back(reinterpret_cast<const char*>(data + offset), length);
+        offset += length;
+    }
+    return tags;
+}
+
+// Verifies the page CRC, computed with the checksum field taken as zero.
+bool pageCrcMatches(const uint8_t* page, size_t pageSize) {
+    static const uint8_t zeros[4] = {0, 0, 0, 0};
+    uint32_t crc = oggCrc32(page, 22);
+    crc = oggCrc32(zeros, 4, crc);
+    crc = oggCrc32(page + 26, pageSize - 26, crc);
+    return crc == readLE32(page + 22);
+}
+
+const uint8_t* findCapture(const uint8_t* from, const uint8_t* end) {
+    while (end - from >= 4) {
+        const void* hit = std::memchr(from, 'O', end - from - 3);
+        if (!hit) {
+            return end;
+        }
+        const uint8_t* candidate = static_cast<const uint8_t*>(hit);
+        if (std::memcmp(candidate, "OggS", 4) == 0) {
+            return candidate;
+        }
+        from = candidate + 1;
+    }
+    return end;
+}
+
+// Keeps `keep` samples starting at `skip`. The skipped samples stay in
+// place and are left out through DecodeResult::pcmOffset, so the PCM is
+// never moved.
+template <typename Sample>
+void trimSamples(std::vector<Sample>& pcm, int64_t skip, int64_t keep) {
+    pcm.resize(static_cast<size_t>(skip + keep));
+}
+
+} // namespace
+
+OpusHead parseOpusHead(const uint8_t* data, size_t size) {
+    if (size < 19 || std::memcmp(data, "OpusHead", 8) != 0) {
+        throw std::runtime_error("Missing OpusHead header");
+    }
+    OpusHead head;
+    head.version = data[8];
+    if ((head.version >> 4) != 0) {
+        throw std::runtime_error("Unsupported OpusHead version");
+    }
+    head.channels = data[9];
+    head.preSkip = readLE16(data + 10);
+    head.inputSampleRate = readLE32(data + 12);
+    head.outputGain = static_cast<int16_t>(readLE16(data + 16));
+    head.mappingFamily = data[18];
+    if (head.channels == 0) {
+        throw std::runtime_error("OpusHead declares zero channels");
+    }
+
+    if (head.mappingFamily == 0) {
+        if (head.channels > 2) {
+            throw std::runtime_error("Mapping family 0 allows at most two channels");
+        }
+        head.streamCount = 1;
+        head.coupledCount = head.channels == 2 ? 1 : 0;
+    } else if (head.mappingFamily == 3) {
+        // RFC 8486: a channels x (streams + coupled) demixing matrix of
+        // little-endian int16, column-major, instead of a mapping table
+        if (size < 21) {
+            throw std::runtime_error("Truncated OpusHead channel mapping");
+        }
+        head.streamCount = data[19];
+        head.coupledCount = data[20];
+        size_t entries = size_t(head.channels) * (head.streamCount + head.coupledCount);
+        if (size < 21 + 2 * entries) {
+            throw std::runtime_error("Truncated OpusHead demixing matrix");
+        }
+        head.demixingMatrix.resize(entries);
+        for (size_t i = 0; i < entries; i++) {
+            head.demixingMatrix[i] = static_cast<int16_t>(readLE16(data + 21 + 2 * i));
+        }
+    } else {
+        if (size < 21u + head.channels) {
+            throw std::runtime_error("Truncated OpusHead channel mapping");
+        }
+        head.streamCount = data[19];
+        head.coupledCount = data[20];
+        head.mapping.assign(data + 21, data + 21 + head.channels);
+    }
+    return head;
+}
+
+uint32_t oggCrc32(const uint8_t* data, size_t size, uint32_t crc) {
+    const CrcTables& t = crcTables();
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        crc ^= (uint32_t(data[i]) << 24) | (uint32_t(data[i + 1]) << 16) | (uint32_t(data[i + 2]) << 8) | data[i + 3];
+        crc = t[3][crc >> 24] ^ t[2][(crc >> 16) & 0xFF] ^ t[1][(crc >> 8) & 0xFF] ^ t[0][crc & 0xFF];
+    }
+    for (; i < size; i++) {
+        crc = (crc << 8) ^ t[0][(crc >> 24) ^ data[i]];
+    }
+    return crc;
+}
+
+OggOpusStream parseOggOpus(const uint8_t* data, size_t size) {
+    OggOpusStream stream;
+    bool haveStream = false;
+    int headerPackets = 0;   // OpusHead and OpusTags seen so far
+    std::vector<uint8_t> partial;
+    bool partialActive = false;
+    uint32_t nextSequence = 0;  // Expected page_sequence_number of the stream
+
+    // `joinedPacket` means the packet was assembled in `partial`.
+    auto emitPacket = [&](const uint8_t* packet, size_t packetSize, bool joinedPacket) {
+        if (headerPackets < 2) {
+            if (headerPackets == 0) {
+                stream.head = parseOpusHead(packet, packetSize);
+            } else {
+                stream.tags = parseOpusTags(packet, packetSize);
+            }
+            headerPackets++;
+            partial.clear();
+        } else if (joinedPacket) {
+            stream.joined.push_back(std::move(partial));
+            partial = {};
+            stream.packets.push_back({stream.joined.back().data(), stream.joined.back().size()});
+        } else {
+            stream.packets.push_back({packet, packetSize});
+        }
+    };
+
+    const uint8_t* end = data + size;
+    const uint8_t* page = findCapture(data, end);
+    while (page < end) {
+        size_t available = end - page;
+        if (available < kPageHeaderSize || page[4] != 0) {
+            stream.corruptPages++;
+            page = findCapture(page + 1, end);
+            continue;
+        }
+        const uint8_t headerType = page[5];
+        const int64_t granule = readLE64(page + 6);
+        const uint32_t serial = readLE32(page + 14);
+        const size_t segmentCount = page[26];
+        size_t headerSize = kPageHeaderSize + segmentCount;
+        if (available < headerSize) {
+            stream.corruptPages++;
+            break;
+        }
+        const uint8_t* lacing = page + kPageHeaderSize;
+        size_t bodySize = 0;
+        for (size_t i = 0; i < segmentCount; i++) {
+            bodySize += lacing[i];
+        }
+        size_t pageSize = headerSize + bodySize;
+        if (available < pageSize || !pageCrcMatches(page, pageSize)) {
+            // Resynchronize on the next capture pattern
+            stream.corruptPages++;
+            partialActive = false;
+            partial.clear();
+            page = findCapture(page + 1, end);
+            continue;
+        }
+
+        const uint32_t sequence = readLE32(page + 18);
+        if (!haveStream) {
+            // Lock onto the first stream whose first packet is an OpusHead
+            const uint8_t* body = page + headerSize;
+            if (bodySize >= 8 && std::memcmp(body, "OpusHead", 8) == 0) {
+                haveStream = true;
+                stream.serial = serial;
+                nextSequence = sequence;
+            } else {
+                page += pageSize;
+                continue;
+            }
+        }
+        if (serial != stream.serial) {
+            page += pageSize;
+            continue;
+        }
+        if (sequence != nextSequence) {
+            // Pages are missing, so a pending packet would be joined with
+            // the continuation of a different one: drop it.
+            partialActive = false;
+            partial.clear();
+        }
+        nextSequence = sequence + 1;
+
+        const uint8_t* body = page + headerSize;
+        const bool continuing = (headerType & kContinuedPacket) != 0;
+        // A continued page whose first part we never saw: drop that packet.
+        bool skipping = continuing && !partialActive;
+        if (!continuing && partialActive) {
+            // The continuation of the pending packet was lost.
+            partialActive = false;
+            partial.clear();
+        }
+
+        size_t offset = 0;
+        size_t packetStart = 0;
+        for (size_t s = 0; s < segmentCount; s++) {
+            offset += lacing[s];
+            if (lacing[s] == 255) {
+                continue;
+            }
+            // A lacing value below 255 ends the packet
+            if (skipping) {
+                skipping = false;
+            } else if (partialActive) {
+                partial.insert(partial.end(), body + packetStart, body + offset);
+                partialActive = false;
+                emitPacket(partial.data(), partial.size(), true);
+            } else {
+                emitPacket(body + packetStart, offset - packetStart, false);
+            }
+            packetStart = offset;
+        }
+        if (segmentCount > 0 && lacing[segmentCount - 1] == 255 && !skipping) {
+            // The last packet continues on the next page
+            partial.insert(partial.end(), body + packetStart, body + offset);
+            partialActive = true;
+        }
+
+        if (granule != -1) {
+            stream.finalGranule = granule;
+        }
+        page += pageSize;
+        if (headerType & kEndOfStream) {
+            break;
+        }
+    }
+
+    if (!haveStream) {
+        throw std::runtime_error("No Opus stream found");
+    }
+    if (headerPackets < 2) {
+        throw std::runtime_error("Missing OpusTags header");
+    }
+    return stream;
+}
+
+DecodeResult decodeOggOpus(const OggOpusStream& stream, opus_int32 sampleRate, SampleFormat format) {
+    DecodeResult decoded;
+    if (stream.head.mappingFamily == 0) {
+        DecoderSession session(sampleRate, stream.head.channels);
+        if (stream.head.outputGain != 0) {
+            session.setGain(stream.head.outputGain);
+        }
+        decoded = session.decode(stream.packets, format);
+    } else if (stream.head.mappingFamily == 3) {
+        ProjectionDecoderSession session(sampleRate, stream.head);
+        DecodeOptions options;
+        options.format = format;
+        decoded = session.decode(stream.packets, options);
+    } else {
+        MultistreamDecoderSession session(sampleRate, stream.head);
+        DecodeOptions options;
+        options.format = format;
+        decoded = session.decode(stream.packets, options, false);
+    }
+
+    // Granule positions and pre-skip are in 48 kHz samples.
+    const int channels = stream.head.channels;
+    int64_t preSkip = int64_t(stream.head.preSkip) * sampleRate / 48000;
+    int64_t available = decoded.samplesDecoded;
+    int64_t keep = available - preSkip;
+    if (stream.finalGranule >= 0) {
+        int64_t total = (stream.finalGranule - stream.head.preSkip) * sampleRate / 48000;
+        if (total >= 0 && total < keep) {
+            keep = total;
+        }
+    }
+    keep = std::max<int64_t>(keep, 0);
+    preSkip = std::min(preSkip, available);
+
+    if (format == SampleFormat::Float32) {
+        trimSamples(decoded.pcmFloat, preSkip * channels, keep * channels);
+    } else {
+        trimSamples(decoded.pcm, preSkip * channels, keep * channels);
+    }
+    decoded.pcmOffset = static_cast<size_t>(preSkip * channels);
+    decoded.samplesDecoded = static_cast<int>(keep);
+    decoded.outputSamples = decoded.samplesDecoded;
+    return decoded;
+}
+
+} // namespace rnopus
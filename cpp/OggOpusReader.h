@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DecoderSession.h"
+#include "PacketFraming.h"
+
+namespace rnopus {
+
+// Identification header (RFC 7845 section 5.1).
+struct OpusHead {
+    int version = 0;
+    int channels = 0;
+    int preSkip = 0;               // In 48 kHz samples
+    uint32_t inputSampleRate = 0;  // Informational only
+    int outputGain = 0;            // Q7.8 dB
+    int mappingFamily = 0;
+    int streamCount = 1;
+    int coupledCount = 0;
+    std::vector<uint8_t> mapping;  // Channel mapping table (family 1, 2, 255)
+    // Family 3: channels x (streamCount + coupledCount) gains in Q15,
+    // column-major, that turn the decoded streams into ambisonic channels
+    std::vector<int16_t> demixingMatrix;
+};
+
+// Comment header (RFC 7845 section 5.2).
+struct OpusTags {
+    std::string vendor;
+    std::vector<std::string> comments;
+};
+
+// The first Opus logical stream of an Ogg file, demuxed into packets.
+struct OggOpusStream {
+    uint32_t serial = 0;
+    OpusHead head;
+    OpusTags tags;
+    // Audio packets in order. They point into the input buffer, except for
+    // packets that span pages, which are joined into `joined`.
+    std::vector<PacketView> packets;
+    std::vector<std::vector<uint8_t>> joined;
+    int64_t finalGranule = -1;  // Granule position of the last page, if any
+    int corruptPages = 0;       // Pages skipped for a bad CRC or layout
+};
+
+// CRC-32 as used by Ogg (polynomial 0x04C11DB7, MSB first, no reflection).
+uint32_t oggCrc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+// Parses an OpusHead packet, as found in Ogg or in WebM/Matroska
+// CodecPrivate. Throws std::runtime_error if it is malformed.
+OpusHead parseOpusHead(const uint8_t* data, size_t size);
+
+// Demuxes the first Opus stream in an Ogg container. Pages failing the CRC
+// check are skipped and counted. A packet cut short by a corrupt or missing
+// page (a gap in the page sequence numbers) is dropped. Missing or malformed
+// headers throw std::runtime_error.
+OggOpusStream parseOggOpus(const uint8_t* data, size_t size);
+
+// Decodes a demuxed stream at `sampleRate`, applying the header gain and
+// trimming pre-skip and end padding as described by the granule positions.
+// The pre-skip samples are left at the front of the PCM and excluded
+// through pcmOffset.
+// Mapping families other than 0 go through the multistream decoder; the PCM
+// is interleaved in the header's channel order.
+DecodeResult decodeOggOpus(const OggOpusStream& stream, opus_int32 sampleRate,
+                           SampleFormat format = SampleFormat::Int16);
+
+} // namespace rnopus
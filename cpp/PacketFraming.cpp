@@ -0,0 +1,318 @@
+#include "PacketFraming.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#if __has_include("opus/opus.h")
+#include "opus/opus.h"
+#elif __has_include("opus.h")
+#include "opus.h"
+#else
+#error "Could not find opus.h"
+#endif
+
+namespace rnopus {
+
+namespace {
+
+[[noreturn]] void malformed(const char* what, size_t offset) {
+    throw std::invalid_argument(std::string(what) + " at byte " + std::to_string(offset));
+}
+
+// RFC 6716 section 3.2.1 frame length: one byte below 252, two bytes otherwise.
+bool readFrameLength(const uint8_t* data, size_t size, size_t& offset, size_t& length) {
+    if (offset >= size) {
+        return false;
+    }
+    if (data[offset] < 252) {
+        length = data[offset++];
+        return true;
+    }
+    if (offset + 1 >= size) {
+        return false;
+    }
+    length = data[offset] + 4 * size_t(data[offset + 1]);
+    offset += 2;
+    return true;
+}
+
+// Reads one self-delimited packet at `offset` and appends its undelimited
+// form to `storage`: the extra length field the self-delimiting layout adds
+// for the last frame is dropped, everything else is copied as is. Returns
+// false, leaving `storage` alone, if the packet runs past the end.
+bool rebuildSelfDelimited(const uint8_t* data, size_t size, size_t& offset, std::vector<uint8_t>& storage) {
+    const size_t start = offset;
+    const uint8_t toc = data[offset++];
+    size_t headerEnd = 0;      // End of the bytes copied verbatim (TOC + undelimited header)
+    size_t payloadBytes = 0;   // Frame data + padding following the header
+    size_t length = 0;
+
+    switch (toc & 0x3) {
+        case 0: // One frame
+            headerEnd = offset;
+            if (!readFrameLength(data, size, offset, length)) return false;
+            payloadBytes = length;
+            break;
+        case 1: // Two frames, equal size
+            headerEnd = offset;
+            if (!readFrameLength(data, size, offset, length)) return false;
+            payloadBytes = 2 * length;
+            break;
+        case 2: { // Two frames, first length explicit
+            size_t first = 0;
+            if (!readFrameLength(data, size, offset, first)) return false;
+            headerEnd = offset;
+            if (!readFrameLength(data, size, offset, length)) return false;
+            payloadBytes = first + length;
+            break;
+        }
+        default: { // Arbitrary number of frames
+            if (offset >= size) return false;
+            const uint8_t countByte = data[offset++];
+            const size_t count = countByte & 0x3F;
+            const bool vbr = countByte & 0x80;
+            const bool padded = countByte & 0x40;
+            if (count == 0) malformed("Invalid frame count", start);
+
+            size_t padding = 0;
+            if (padded) {
+                for (;;) {
+                    if (offset >= size) return false;
+                    uint8_t chunk = data[offset++];
+                    padding += chunk == 255 ? 254 : chunk;
+                    if (chunk != 255) break;
+                }
+            }
+
+            size_t frames = 0;
+            if (vbr) {
+                for (size_t i = 0; i + 1 < count; i++) {
+                    if (!readFrameLength(data, size, offset, length)) return false;
+                    frames += length;
+                }
+                headerEnd = offset;
+                if (!readFrameLength(data, size, offset, length)) return false;
+                frames += length;
+            } else {
+                headerEnd = offset;
+                if (!readFrameLength(data, size, offset, length)) return false;
+                frames = count * length;
+            }
+            payloadBytes = frames + padding;
+            break;
+        }
+    }
+
+    if (payloadBytes > size - offset) {
+        return false;
+    }
+    storage.insert(storage.end(), data + start, data + headerEnd);
+    storage.insert(storage.end(), data + offset, data + offset + payloadBytes);
+    offset += payloadBytes;
+    return true;
+}
+
+// Rejects rebuilt packets libopus cannot parse.
+void validatePacket(const std::vector<uint8_t>& packet, size_t inputOffset) {
+    unsigned char toc = 0;
+    const unsigned char* frames[48];
+    opus_int16 frameSizes[48];
+    int payloadOffset = 0;
+    if (opus_packet_parse(packet.data(), static_cast<opus_int32>(packet.size()),
+                          &toc, frames, frameSizes, &payloadOffset) < 0) {
+        malformed("Invalid self-delimited packet", inputOffset);
+    }
+}
+
+// Drains `reader`. Self-delimited packets are copied out of the reader's
+// scratch buffer into the list's storage.
+PacketList collectPackets(PacketReader& reader, size_t size, const FramingOptions& options) {
+    PacketList list;
+    PacketView packet;
+
+    if (options.framing != Framing::SelfDelimited) {
+        if (options.framing == Framing::Fixed) {
+            list.packets.reserve(size / options.packetSize + 1);
+        } else if (options.framing == Framing::Lengths) {
+            list.packets.reserve(options.lengths.size());
+        }
+        while (reader.next(packet)) {
+            list.packets.push_back(packet);
+        }
+        return list;
+    }
+
+    // A rebuilt packet is never larger than its delimited form, so reserving
+    // the input size keeps the views below stable while storage grows.
+    list.storage.reserve(size);
+    std::vector<std::pair<size_t, size_t>> spans;
+    while (reader.next(packet)) {
+        spans.emplace_back(list.storage.size(), packet.size);
+        list.storage.insert(list.storage.end(), packet.data, packet.data + packet.size);
+    }
+    list.packets.reserve(spans.size());
+    for (const auto& span : spans) {
+        list.packets.push_back({list.storage.data() + span.first, span.second});
+    }
+    return list;
+}
+
+} // namespace
+
+Framing parseFraming(const std::string& name) {
+    if (name == "fixed") return Framing::Fixed;
+    if (name == "u16") return Framing::U16;
+    if (name == "varint") return Framing::Varint;
+    if (name == "lengths") return Framing::Lengths;
+    if (name == "self-delimited") return Framing::SelfDelimited;
+    throw std::invalid_argument("Unknown framing: " + name);
+}
+
+void appendPacket(std::vector<uint8_t>& out, const uint8_t* packet, size_t size, Framing framing) {
+    switch (framing) {
+        case Framing::U16:
+            if (size > 0xFFFF) {
+                throw std::invalid_argument("Packet too long for u16 framing");
+            }
+            out.push_back(static_cast<uint8_t>(size >> 8));
+            out.push_back(static_cast<uint8_t>(size));
+            break;
+        case Framing::Varint: {
+            size_t length = size;
+            while (length >= 0x80) {
+                out.push_back(static_cast<uint8_t>(length | 0x80));
+                length >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(length));
+            break;
+        }
+        case Framing::SelfDelimited:
+            throw std::invalid_argument("Self-delimited framing is only supported for input");
+        case Framing::Fixed:
+        case Framing::Lengths:
+            break;
+    }
+    out.insert(out.end(), packet, packet + size);
+}
+
+PacketReader::PacketReader(const uint8_t* data, size_t size, const FramingOptions& options, bool partialTail)
+    : data_(data), size_(size), options_(options), partialTail_(partialTail) {
+    if (options_.framing == Framing::Fixed && options_.packetSize <= 0) {
+        throw std::invalid_argument("packetSize must be positive");
+    }
+    if (partialTail_ && options_.framing == Framing::Lengths) {
+        throw std::invalid_argument("lengths framing cannot carry a partial packet");
+    }
+}
+
+bool PacketReader::truncated(const char* what, size_t start, size_t errorOffset) {
+    if (!partialTail_) {
+        malformed(what, errorOffset);
+    }
+    offset_ = start;
+    return false;
+}
+
+bool PacketReader::next(PacketView& packet) {
+    if (options_.framing == Framing::Lengths) {
+        if (index_ == options_.lengths.size()) {
+            if (offset_ != size_) {
+                malformed("Packet lengths do not cover the input", offset_);
+            }
+            return false;
+        }
+        size_t length = options_.lengths[index_++];
+        if (length > size_ - offset_) {
+            malformed("Packet lengths exceed the input", offset_);
+        }
+        packet = {data_ + offset_, length};
+        offset_ += length;
+        return true;
+    }
+
+    if (offset_ >= size_) {
+        return false;
+    }
+
+    switch (options_.framing) {
+        case Framing::Fixed: {
+            size_t packetBytes = std::min((size_t)options_.packetSize, size_ - offset_);
+            if (packetBytes < (size_t)options_.packetSize && partialTail_) {
+                return false;
+            }
+            if (packetBytes < (size_t)options_.packetSize && offset_ > 0) {
+                skipped_ = packetBytes;
+                offset_ = size_;
+                return false;
+            }
+            packet = {data_ + offset_, packetBytes};
+            offset_ += packetBytes;
+            return true;
+        }
+        case Framing::U16: {
+            size_t start = offset_;
+            if (size_ - offset_ < 2) {
+                return truncated("Truncated length prefix", start, start);
+            }
+            size_t length = (size_t(data_[offset_]) << 8) | data_[offset_ + 1];
+            offset_ += 2;
+            if (length > size_ - offset_) {
+                return truncated("Truncated packet", start, offset_);
+            }
+            packet = {data_ + offset_, length};
+            offset_ += length;
+            return true;
+        }
+        case Framing::Varint: {
+            size_t start = offset_;
+            uint64_t length = 0;
+            for (int shift = 0;; shift += 7) {
+                if (offset_ >= size_) {
+                    return truncated("Truncated length prefix", start, start);
+                }
+                if (shift > 28) {
+                    malformed("Length prefix too long", start);
+                }
+                uint8_t byte = data_[offset_++];
+                length |= uint64_t(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) {
+                    break;
+                }
+            }
+            if (length > size_ - offset_) {
+                return truncated("Truncated packet", start, offset_);
+            }
+            packet = {data_ + offset_, static_cast<size_t>(length)};
+            offset_ += static_cast<size_t>(length);
+            return true;
+        }
+        case Framing::SelfDelimited: {
+            size_t start = offset_;
+            scratch_.clear();
+            if (!rebuildSelfDelimited(data_, size_, offset_, scratch_)) {
+                return truncated("Truncated self-delimited packet", start, start);
+            }
+            validatePacket(scratch_, start);
+            packet = {scratch_.data(), scratch_.size()};
+            return true;
+        }
+        case Framing::Lengths:
+            break;
+    }
+    return false;
+}
+
+PacketList splitPackets(const uint8_t* data, size_t size, const FramingOptions& options) {
+    PacketReader reader(data, size, options);
+    return collectPackets(reader, size, options);
+}
+
+PacketList splitCompletePackets(const uint8_t* data, size_t size, const FramingOptions& options, size_t& consumed) {
+    PacketReader reader(data, size, options, true);
+    PacketList list = collectPackets(reader, size, options);
+    consumed = reader.offset();
+    return list;
+}
+
+} // namespace rnopus
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rnopus {
+
+// How consecutive Opus packets are delimited in a byte buffer.
+enum class Framing {
+    Fixed,         // Every packet is `packetSize` bytes (CBR only)
+    U16,           // Each packet is preceded by its length as a big-endian uint16
+    Varint,        // Each packet is preceded by its length as an unsigned LEB128
+    Lengths,       // Packets are back to back; their lengths are given separately
+    SelfDelimited, // RFC 6716 Appendix B self-delimiting packets
+};
+
+struct FramingOptions {
+    Framing framing = Framing::Fixed;
+    int packetSize = 0;             // Framing::Fixed
+    std::vector<uint32_t> lengths;  // Framing::Lengths
+};
+
+// A packet inside the input buffer or inside PacketList::storage.
+struct PacketView {
+    const uint8_t* data;
+    size_t size;
+};
+
+struct PacketList {
+    std::vector<PacketView> packets;
+    // Self-delimited packets are rewritten to the regular (undelimited)
+    // layout that opus_decode expects; the rewritten bytes live here.
+    std::vector<uint8_t> storage;
+};
+
+// Maps "fixed", "u16", "varint", "lengths" and "self-delimited" to a
+// Framing. Throws std::invalid_argument for anything else.
+Framing parseFraming(const std::string& name);
+
+// Splits `data` into packets. Fixed framing keeps the legacy behaviour of
+// dropping a short trailing packet; every other framing throws
+// std::invalid_argument on truncated or malformed input.
+PacketList splitPackets(const uint8_t* data, size_t size, const FramingOptions& options);
+
+// Like splitPackets for a buffer that may end partway through a packet, as
+// network chunks do: stops before the incomplete packet and sets `consumed`
+// to the bytes the complete ones span. Fixed framing keeps a short trailing
+// packet too. Throws std::invalid_argument for Lengths framing and for
+// malformed input.
+PacketList splitCompletePackets(const uint8_t* data, size_t size, const FramingOptions& options, size_t& consumed);
+
+// Appends one packet to `out` with the prefix `framing` calls for. Fixed
+// and Lengths framing append the bare packet. Throws std::invalid_argument
+// for SelfDelimited, which needs the packet rewritten, and for packets
+// longer than a U16 prefix can describe.
+void appendPacket(std::vector<uint8_t>& out, const uint8_t* packet, size_t size, Framing framing);
+
+// Walks a framed buffer one packet at a time, for inputs too large to index
+// up front. Same rules and errors as splitPackets.
+class PacketReader {
+public:
+    // `data` and `options` must outlive the reader. Throws
+    // std::invalid_argument if the options cannot describe any input. With
+    // `partialTail`, a packet cut off by the end of the buffer ends the walk
+    // instead of throwing, and offset() stays at its start.
+    PacketReader(const uint8_t* data, size_t size, const FramingOptions& options, bool partialTail = false);
+
+    // Stores the next packet and returns true, or returns false at the end.
+    // The view is valid until the next call: self-delimited packets are
+    // rebuilt into a buffer the reader reuses.
+    bool next(PacketView& packet);
+
+    // Input bytes consumed so far
+    size_t offset() const { return offset_; }
+
+    // Bytes of a short last packet that Fixed framing skipped at the end
+    size_t skippedBytes() const { return skipped_; }
+
+private:
+    // Rewinds to `start` and ends the walk in partialTail mode; otherwise
+    // throws, reporting `errorOffset`
+    bool truncated(const char* what, size_t start, size_t errorOffset);
+
+    const uint8_t* data_;
+    size_t size_;
+    const FramingOptions& options_;
+    bool partialTail_;
+    size_t offset_ = 0;
+    size_t skipped_ = 0;
+    size_t index_ = 0;  // Framing::Lengths
+    std::vector<uint8_t> scratch_;
+};
+
+} // namespace rnopus
@@ -0,0 +1,117 @@
+#include "PcmRingBuffer.h"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace rnopus {
+
+namespace {
+
+std::mutex registryMutex;
+std::unordered_map<int, std::shared_ptr<PcmRingBuffer>> registry;
+
+// Validates the size and rounds it up to a power of two
+size_t ringCapacity(size_t capacityFrames, int channels) {
+    if (capacityFrames == 0 || channels <= 0) {
+        throw std::invalid_argument("Ring capacity and channel count must be positive");
+    }
+    if (capacityFrames > (size_t(1) << 30)) {
+        throw std::invalid_argument("Ring capacity too large");
+    }
+    size_t power = 1;
+    while (power < capacityFrames) {
+        power <<= 1;
+    }
+    return power;
+}
+
+} // namespace
+
+PcmRingBuffer::PcmRingBuffer(size_t capacityFrames, int channels)
+    : capacity_(ringCapacity(capacityFrames, channels)), mask_(capacity_ - 1), channels_(channels) {
+    samples_.resize(capacity_ * channels_);
+}
+
+void PcmRingBuffer::copyIn(uint64_t position, const float* pcm, size_t frames) {
+    size_t start = static_cast<size_t>(position) & mask_;
+    size_t first = std::min(frames, capacity_ - start);
+    std::copy_n(pcm, first * channels_, samples_.data() + start * channels_);
+    std::copy_n(pcm + first * channels_, (frames - first) * channels_, samples_.data());
+}
+
+void PcmRingBuffer::copyOut(uint64_t position, float* pcm, size_t frames) const {
+    size_t start = static_cast<size_t>(position) & mask_;
+    size_t first = std::min(frames, capacity_ - start);
+    std::copy_n(samples_.data() + start * channels_, first * channels_, pcm);
+    std::copy_n(samples_.data(), (frames - first) * channels_, pcm + first * channels_);
+}
+
+size_t PcmRingBuffer::write(const float* pcm, size_t frames) {
+    uint64_t writePosition = writePosition_.load(std::memory_order_relaxed);
+    uint64_t readPosition = readPosition_.load(std::memory_order_acquire);
+    size_t space = capacity_ - static_cast<size_t>(writePosition - readPosition);
+    size_t count = std::min(frames, space);
+
+    copyIn(writePosition, pcm, count);
+    writePosition_.store(writePosition + count, std::memory_order_release);
+    if (count < frames) {
+        framesDropped_.fetch_add(frames - count, std::memory_order_relaxed);
+    }
+    return count;
+}
+
+size_t PcmRingBuffer::read(float* pcm, size_t frames) {
+    uint64_t readPosition = readPosition_.load(std::memory_order_relaxed);
+    uint64_t writePosition = writePosition_.load(std::memory_order_acquire);
+    size_t count = std::min(frames, static_cast<size_t>(writePosition - readPosition));
+
+    copyOut(readPosition, pcm, count);
+    readPosition_.store(readPosition + count, std::memory_order_release);
+    if (count < frames) {
+        std::fill(pcm + count * channels_, pcm + frames * channels_, 0.0f);
+        // Before the first write the consumer is just early, not starved
+        if (writePosition > 0) {
+            underruns_.fetch_add(1, std::memory_order_relaxed);
+            underrunFrames_.fetch_add(frames - count, std::memory_order_relaxed);
+        }
+    }
+    return count;
+}
+
+size_t PcmRingBuffer::fillFrames() const {
+    uint64_t readPosition = readPosition_.load(std::memory_order_acquire);
+    uint64_t writePosition = writePosition_.load(std::memory_order_acquire);
+    return static_cast<size_t>(writePosition - std::min(readPosition, writePosition));
+}
+
+PcmRingStats PcmRingBuffer::stats() const {
+    PcmRingStats stats;
+    stats.capacityFrames = capacity_;
+    stats.framesRead = readPosition_.load(std::memory_order_acquire);
+    stats.framesWritten = writePosition_.load(std::memory_order_acquire);
+    stats.fillFrames = static_cast<size_t>(stats.framesWritten - std::min(stats.framesRead, stats.framesWritten));
+    stats.framesDropped = framesDropped_.load(std::memory_order_relaxed);
+    stats.underruns = underruns_.load(std::memory_order_relaxed);
+    stats.underrunFrames = underrunFrames_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void registerPcmRing(int handle, std::shared_ptr<PcmRingBuffer> ring) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry[handle] = std::move(ring);
+}
+
+void unregisterPcmRing(int handle) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry.erase(handle);
+}
+
+std::shared_ptr<PcmRingBuffer> findPcmRing(int handle) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = registry.find(handle);
+    return it == registry.end() ? nullptr : it->second;
+}
+
+} // namespace rnopus
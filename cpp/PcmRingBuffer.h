@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rnopus {
+
+struct PcmRingStats {
+    size_t capacityFrames = 0;
+    size_t fillFrames = 0;       // Written and not yet read
+    uint64_t framesWritten = 0;
+    uint64_t framesRead = 0;     // Real audio only, not underrun silence
+    uint64_t framesDropped = 0;  // Rejected by write() because the ring was full
+    uint64_t underruns = 0;      // Reads that came up short
+    uint64_t underrunFrames = 0; // Silence handed out by those reads
+};
+
+// Single-producer / single-consumer ring of interleaved float PCM, for
+// handing decoded audio to a native consumer such as an audio callback.
+// Both sides are wait-free: no locks, no allocation, no retry loops. Exactly
+// one thread may write and one thread may read at a time; nothing here
+// checks that, so the owner of the ring must. The module binds each ring to
+// the first decoder that writes into it and refuses any other.
+class PcmRingBuffer {
+public:
+    // Capacity is rounded up to a power of two frames.
+    PcmRingBuffer(size_t capacityFrames, int channels);
+
+    PcmRingBuffer(const PcmRingBuffer&) = delete;
+    PcmRingBuffer& operator=(const PcmRingBuffer&) = delete;
+
+    // Producer: copies up to `frames` frames and returns how many fit. The
+    // rest are dropped and counted; audio already queued is never
+    // overwritten under the reader.
+    size_t write(const float* pcm, size_t frames);
+
+    // Consumer: fills `pcm` with exactly `frames` frames and returns how
+    // many were audio. A short read is padded with silence and counted as
+    // an underrun once anything has been written.
+    size_t read(float* pcm, size_t frames);
+
+    // Frames ready to read. Exact on the consumer thread, a lower bound
+    // elsewhere.
+    size_t fillFrames() const;
+
+    PcmRingStats stats() const;
+
+    size_t capacityFrames() const { return capacity_; }
+    int channels() const { return channels_; }
+
+private:
+    // Copies between the ring and a linear buffer across the wrap point
+    void copyIn(uint64_t position, const float* pcm, size_t frames);
+    void copyOut(uint64_t position, float* pcm, size_t frames) const;
+
+    std::vector<float> samples_;
+    size_t capacity_;
+    size_t mask_;
+    int channels_;
+
+    // Monotonic frame counters; each has a single writer. Kept on separate
+    // cache lines so the two threads do not contend.
+    alignas(64) std::atomic<uint64_t> writePosition_{0};
+    std::atomic<uint64_t> framesDropped_{0};
+    alignas(64) std::atomic<uint64_t> readPosition_{0};
+    std::atomic<uint64_t> underruns_{0};
+    std::atomic<uint64_t> underrunFrames_{0};
+};
+
+// Process-wide lookup so native audio code can reach a ring created from JS
+// by its handle. Look the ring up once when the consumer starts and keep the
+// shared_ptr; these functions lock.
+void registerPcmRing(int handle, std::shared_ptr<PcmRingBuffer> ring);
+void unregisterPcmRing(int handle);
+std::shared_ptr<PcmRingBuffer> findPcmRing(int handle);
+
+} // namespace rnopus
@@ -0,0 +1,188 @@
+#include "ProjectionDecoderSession.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+namespace rnopus {
+
+namespace {
+
+int decodeFrame(OpusProjectionDecoder* decoder, const uint8_t* data, size_t size, opus_int16* pcm, int frames) {
+    return opus_projection_decode(decoder, data, static_cast<opus_int32>(size), pcm, frames, 0);
+}
+
+int decodeFrame(OpusProjectionDecoder* decoder, const uint8_t* data, size_t size, float* pcm, int frames) {
+    return opus_projection_decode_float(decoder, data, static_cast<opus_int32>(size), pcm, frames, 0);
+}
+
+} // namespace
+
+ProjectionDecoderSession::ProjectionDecoderSession(opus_int32 sampleRate, const OpusHead& head)
+    : sampleRate_(sampleRate), channels_(head.channels), lastPacketFrames_(sampleRate / 50) {
+    const size_t entries = size_t(head.channels) * (head.streamCount + head.coupledCount);
+    if (head.demixingMatrix.size() != entries) {
+        throw std::runtime_error("Demixing matrix needs channels x (streams + coupled streams) entries");
+    }
+
+    // libopus takes the matrix in its OpusHead byte layout
+    std::vector<unsigned char> matrix(2 * entries);
+    for (size_t i = 0; i < entries; i++) {
+        auto gain = static_cast<uint16_t>(head.demixingMatrix[i]);
+        matrix[2 * i] = static_cast<unsigned char>(gain & 0xFF);
+        matrix[2 * i + 1] = static_cast<unsigned char>(gain >> 8);
+    }
+
+    int error = 0;
+    decoder_ = opus_projection_decoder_create(sampleRate, head.channels, head.streamCount, head.coupledCount,
+                                              matrix.data(), static_cast<opus_int32>(matrix.size()), &error);
+    if (error != OPUS_OK || !decoder_) {
+        throw std::runtime_error(std::string("Failed to create Opus projection decoder: ") + opus_strerror(error));
+    }
+    if (head.outputGain != 0) {
+        opus_projection_decoder_ctl(decoder_, OPUS_SET_GAIN(head.outputGain));
+    }
+}
+
+ProjectionDecoderSession::~ProjectionDecoderSession() {
+    if (decoder_) {
+        opus_projection_decoder_destroy(decoder_);
+    }
+}
+
+void ProjectionDecoderSession::enableBinaural(BinauralFilters filters) {
+    if (filters.taps.empty()) {
+        filters = defaultBinauralFilters(channels_, sampleRate_);
+    }
+    if (filters.channels > channels_) {
+        throw std::invalid_argument("Binaural filters cover more channels than the stream has");
+    }
+    renderer_ = std::make_unique<BinauralRenderer>(std::move(filters));
+}
+
+DecodeResult ProjectionDecoderSession::decode(const uint8_t* input, size_t inputSize, const FramingOptions& framing,
+                                              const DecodeOptions& options) {
+    PacketList list = splitPackets(input, inputSize, framing);
+    return decode(list.packets, options);
+}
+
+DecodeResult ProjectionDecoderSession::decode(const std::vector<PacketView>& packets, const DecodeOptions& options) {
+    if (!options.sequenceNumbers.empty() || options.dred) {
+        throw std::invalid_argument("sequenceNumbers and dred are not supported for projection decoding");
+    }
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    DecodeResult decoded;
+    decoded.format = options.format;
+    if (options.format == SampleFormat::Float32) {
+        decodeAll(packets, options.concealLoss, decoded.pcmFloat, decoded);
+    } else {
+        decodeAll(packets, options.concealLoss, decoded.pcm, decoded);
+    }
+
+    decoded.outputSamples = decoded.samplesDecoded;
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    decoded.processingTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+    stats_.decodeCalls++;
+    stats_.packetsDecoded += decoded.packetsDecoded;
+    stats_.packetsConcealed += decoded.packetsConcealed;
+    stats_.samplesDecoded += decoded.samplesDecoded;
+    stats_.samplesConcealed += decoded.samplesConcealed;
+    stats_.processingTimeMs += decoded.processingTimeMs;
+    return decoded;
+}
+
+template <typename Sample>
+int ProjectionDecoderSession::decodeInto(const PacketView* packet, Sample* out, int frames) {
+    const uint8_t* data = packet ? packet->data : nullptr;
+    const size_t size = packet ? packet->size : 0;
+    if (!renderer_) {
+        return decodeFrame(decoder_, data, size, out, frames);
+    }
+
+    scratch_.resize(size_t(frames) * channels_);
+    int samples = decodeFrame(decoder_, data, size, scratch_.data(), frames);
+    if (samples <= 0) {
+        return samples;
+    }
+    if constexpr (std::is_same<Sample, float>::value) {
+        renderer_->process(scratch_.data(), channels_, samples, out);
+    } else {
+        rendered_.resize(size_t(samples) * 2);
+        renderer_->process(scratch_.data(), channels_, samples, rendered_.data());
+        for (size_t i = 0; i < rendered_.size(); i++) {
+            out[i] = floatToInt16(rendered_[i]);
+        }
+    }
+    return samples;
+}
+
+template <typename Sample>
+void ProjectionDecoderSession::decodeAll(const std::vector<PacketView>& packets, bool concealLoss,
+                                         std::vector<Sample>& pcm, DecodeResult& decoded) {
+    const int outChannels = outputChannels();
+    std::vector<int> frames(packets.size(), 0);
+    size_t totalFrames = 0;
+    for (size_t i = 0; i < packets.size(); i++) {
+        const PacketView& packet = packets[i];
+        int packetFrames = packet.size == 0
+            ? OPUS_INVALID_PACKET
+            : opus_packet_get_nb_samples(packet.data, static_cast<opus_int32>(packet.size), sampleRate_);
+        if (packetFrames > 0) {
+            lastPacketFrames_ = packetFrames;
+        } else if (concealLoss) {
+            packetFrames = lastPacketFrames_;
+        } else {
+            packetFrames = 0;
+        }
+        frames[i] = packetFrames;
+        totalFrames += packetFrames;
+    }
+
+    pcm.resize(totalFrames * outChannels);
+    size_t offset = 0; // In frames
+
+    for (size_t i = 0; i < packets.size(); i++) {
+        if (frames[i] == 0) {
+            continue;
+        }
+        const PacketView& packet = packets[i];
+        Sample* out = pcm.data() + offset * outChannels;
+
+        int samples = packet.size == 0 ? OPUS_INVALID_PACKET : decodeInto(&packet, out, frames[i]);
+        if (samples >= 0) {
+            decoded.packetsDecoded++;
+        } else {
+            if (packet.size != 0) {
+                stats_.packetsFailed++;
+            }
+            if (!concealLoss) {
+                continue;
+            }
+            samples = decodeInto<Sample>(nullptr, out, frames[i]);
+            if (samples < 0) {
+                std::fill(out, out + frames[i] * outChannels, Sample(0));
+                samples = frames[i];
+            }
+            decoded.packetsConcealed++;
+            decoded.samplesConcealed += samples;
+            decoded.gaps.push_back(static_cast<int64_t>(i));
+        }
+        offset += samples;
+        decoded.samplesDecoded += samples;
+    }
+    pcm.resize(offset * outChannels);
+}
+
+int ProjectionDecoderSession::reset() {
+    lastPacketFrames_ = sampleRate_ / 50;
+    if (renderer_) {
+        renderer_->reset();
+    }
+    return opus_projection_decoder_ctl(decoder_, OPUS_RESET_STATE);
+}
+
+} // namespace rnopus
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "BinauralRenderer.h"
+#include "DecoderSession.h"
+#include "OggOpusReader.h"
+
+#if __has_include("opus/opus_projection.h")
+#include "opus/opus_projection.h"
+#elif __has_include("opus_projection.h")
+#include "opus_projection.h"
+#else
+#error "Could not find opus_projection.h"
+#endif
+
+namespace rnopus {
+
+// An OpusProjectionDecoder for ambisonic streams (channel mapping family 3):
+// the decoded streams are demixed into ACN/SN3D ambisonic channels by the
+// matrix from the OpusHead. Optionally renders them to binaural stereo.
+// Not thread safe; callers serialize access per session.
+class ProjectionDecoderSession {
+public:
+    // Takes channels, streamCount, coupledCount and demixingMatrix from
+    // `head` and applies its output gain. Throws std::runtime_error if
+    // libopus rejects the layout or the matrix size is wrong.
+    ProjectionDecoderSession(opus_int32 sampleRate, const OpusHead& head);
+    ~ProjectionDecoderSession();
+
+    ProjectionDecoderSession(const ProjectionDecoderSession&) = delete;
+    ProjectionDecoderSession& operator=(const ProjectionDecoderSession&) = delete;
+
+    // Renders every later decode to binaural stereo with `filters`
+    // (defaultBinauralFilters when they hold no taps). Throws
+    // std::invalid_argument for filters that do not fit the stream.
+    void enableBinaural(BinauralFilters filters);
+
+    // Decodes every packet in order into interleaved ambisonic PCM, or
+    // binaural stereo once enabled. With concealLoss, zero-length and
+    // undecodable packets are concealed (PLC); otherwise they are skipped.
+    // sequenceNumbers and dred are not supported here.
+    DecodeResult decode(const std::vector<PacketView>& packets, const DecodeOptions& options);
+    DecodeResult decode(const uint8_t* input, size_t inputSize, const FramingOptions& framing,
+                        const DecodeOptions& options);
+
+    // Drops the decoder and renderer history. Returns an Opus error code.
+    int reset();
+
+    opus_int32 sampleRate() const { return sampleRate_; }
+    // Channels in the decoded stream
+    int channels() const { return channels_; }
+    // Channels in decode() output: 2 when rendering binaurally
+    int outputChannels() const { return renderer_ ? 2 : channels_; }
+    const DecoderStats& stats() const { return stats_; }
+
+private:
+    template <typename Sample>
+    void decodeAll(const std::vector<PacketView>& packets, bool concealLoss, std::vector<Sample>& pcm,
+                   DecodeResult& decoded);
+    // Decodes one packet (or conceals when `packet` is null) into `out` in
+    // the output layout. Returns samples per channel or an Opus error code.
+    template <typename Sample>
+    int decodeInto(const PacketView* packet, Sample* out, int frames);
+
+    OpusProjectionDecoder* decoder_ = nullptr;
+    opus_int32 sampleRate_;
+    int channels_;
+    int lastPacketFrames_;
+    std::unique_ptr<BinauralRenderer> renderer_;
+    std::vector<float> scratch_;  // One packet of ambisonic PCM before rendering
+    std::vector<float> rendered_; // Its binaural render, for int16 output
+    DecoderStats stats_;
+};
+
+} // namespace rnopus
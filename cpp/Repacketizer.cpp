@@ -0,0 +1,198 @@
+#include "Repacketizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+namespace rnopus {
+
+namespace {
+
+// A code 3 header (TOC, count, up to 255 padding bytes) plus two length
+// bytes per frame
+constexpr size_t kMaxHeaderBytes = 2 + 255 + 2 * 48;
+
+double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+[[noreturn]] void invalidPacket(size_t index, int error) {
+    throw std::runtime_error("Invalid packet " + std::to_string(index) + ": " + opus_strerror(error));
+}
+
+} // namespace
+
+Repacketizer::Repacketizer() : repacketizer_(opus_repacketizer_create()) {
+    if (!repacketizer_) {
+        throw std::runtime_error("Failed to create Opus repacketizer");
+    }
+}
+
+Repacketizer::~Repacketizer() {
+    opus_repacketizer_destroy(repacketizer_);
+}
+
+void Repacketizer::emit(const uint8_t* data, size_t size, RepacketizeResult& result) {
+    appendPacket(result.data, data, size, framing_);
+    result.lengths.push_back(static_cast<uint32_t>(size));
+}
+
+void Repacketizer::flush(RepacketizeResult& result) {
+    int frames = opus_repacketizer_get_nb_frames(repacketizer_);
+    if (frames > 0) {
+        packet_.resize(pendingBytes_ + kMaxHeaderBytes);
+        int size = opus_repacketizer_out(repacketizer_, packet_.data(), static_cast<opus_int32>(packet_.size()));
+        if (size < 0) {
+            throw std::runtime_error(std::string("Failed to repacketize: ") + opus_strerror(size));
+        }
+        emit(packet_.data(), size, result);
+        result.framesOut += frames;
+    }
+    opus_repacketizer_init(repacketizer_);
+    pendingBytes_ = 0;
+    slices_.clear();
+}
+
+void Repacketizer::append(const uint8_t* data, size_t size, size_t index, RepacketizeResult& result) {
+    if (size == 0) {
+        flush(result);
+        emit(data, 0, result);
+        return;
+    }
+    auto length = static_cast<opus_int32>(size);
+    int error = opus_repacketizer_cat(repacketizer_, data, length);
+    if (error != OPUS_OK && opus_repacketizer_get_nb_frames(repacketizer_) > 0) {
+        // Different configuration or over 120 ms: start a new packet
+        flush(result);
+        error = opus_repacketizer_cat(repacketizer_, data, length);
+    }
+    if (error != OPUS_OK) {
+        invalidPacket(index, error);
+    }
+    pendingBytes_ += size;
+}
+
+RepacketizeResult Repacketizer::merge(const std::vector<PacketView>& packets, int packetsPerGroup, Framing framing) {
+    if (packetsPerGroup < 0) {
+        throw std::invalid_argument("packetsPerGroup must not be negative");
+    }
+    auto startTime = std::chrono::high_resolution_clock::now();
+    RepacketizeResult result;
+    framing_ = framing;
+    opus_repacketizer_init(repacketizer_);
+    pendingBytes_ = 0;
+
+    for (size_t i = 0; i < packets.size(); i++) {
+        if (packetsPerGroup > 0 && i % packetsPerGroup == 0) {
+            flush(result);
+        }
+        append(packets[i].data, packets[i].size, i, result);
+    }
+    flush(result);
+
+    result.processingTimeMs = elapsedMs(startTime);
+    return result;
+}
+
+RepacketizeResult Repacketizer::split(const std::vector<PacketView>& packets, Framing framing) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    RepacketizeResult result;
+    framing_ = framing;
+
+    for (size_t i = 0; i < packets.size(); i++) {
+        const PacketView& packet = packets[i];
+        if (packet.size == 0) {
+            emit(packet.data, 0, result);
+            continue;
+        }
+        opus_repacketizer_init(repacketizer_);
+        int error = opus_repacketizer_cat(repacketizer_, packet.data, static_cast<opus_int32>(packet.size));
+        if (error != OPUS_OK) {
+            invalidPacket(i, error);
+        }
+        int frames = opus_repacketizer_get_nb_frames(repacketizer_);
+        packet_.resize(packet.size + kMaxHeaderBytes);
+        for (int frame = 0; frame < frames; frame++) {
+            int size = opus_repacketizer_out_range(repacketizer_, frame, frame + 1, packet_.data(),
+                                                   static_cast<opus_int32>(packet_.size()));
+            if (size < 0) {
+                throw std::runtime_error(std::string("Failed to repacketize: ") + opus_strerror(size));
+            }
+            emit(packet_.data(), size, result);
+        }
+        result.framesOut += frames;
+    }
+    opus_repacketizer_init(repacketizer_);
+
+    result.processingTimeMs = elapsedMs(startTime);
+    return result;
+}
+
+RepacketizeResult Repacketizer::extractFrames(const std::vector<PacketView>& packets, int64_t firstFrame,
+                                              int64_t frameCount, Framing framing) {
+    if (firstFrame < 0) {
+        throw std::invalid_argument("firstFrame must not be negative");
+    }
+    auto startTime = std::chrono::high_resolution_clock::now();
+    RepacketizeResult result;
+    framing_ = framing;
+    opus_repacketizer_init(repacketizer_);
+    pendingBytes_ = 0;
+    slices_.clear();
+
+    const int64_t endFrame = frameCount < 0 ? INT64_MAX : firstFrame + frameCount;
+    int64_t position = 0; // Stream frame index of the packet's first frame
+    for (size_t i = 0; i < packets.size() && position < endFrame; i++) {
+        const PacketView& packet = packets[i];
+        if (packet.size == 0) {
+            // A lost packet holds no frames to count; keep it in place
+            if (position >= firstFrame) {
+                append(packet.data, 0, i, result);
+            }
+            continue;
+        }
+        int frames = opus_packet_get_nb_frames(packet.data, static_cast<opus_int32>(packet.size));
+        if (frames < 0) {
+            invalidPacket(i, frames);
+        }
+        int64_t begin = std::max<int64_t>(firstFrame - position, 0);
+        int64_t end = std::min<int64_t>(endFrame - position, frames);
+        position += frames;
+        if (begin >= end) {
+            continue;
+        }
+        if (begin == 0 && end == frames) {
+            append(packet.data, packet.size, i, result);
+            continue;
+        }
+
+        // Cut the wanted frames out first; the slice then merges like any
+        // other packet.
+        OpusRepacketizer* cutter = opus_repacketizer_create();
+        if (!cutter) {
+            throw std::runtime_error("Failed to create Opus repacketizer");
+        }
+        std::vector<uint8_t> slice(packet.size + kMaxHeaderBytes);
+        int size = opus_repacketizer_cat(cutter, packet.data, static_cast<opus_int32>(packet.size));
+        if (size == OPUS_OK) {
+            size = opus_repacketizer_out_range(cutter, static_cast<int>(begin), static_cast<int>(end), slice.data(),
+                                               static_cast<opus_int32>(slice.size()));
+        }
+        opus_repacketizer_destroy(cutter);
+        if (size < 0) {
+            invalidPacket(i, size);
+        }
+        slice.resize(size);
+        append(slice.data(), slice.size(), i, result);
+        // The repacketizer points into the slice until the next flush
+        slices_.push_back(std::move(slice));
+    }
+    flush(result);
+
+    result.processingTimeMs = elapsedMs(startTime);
+    return result;
+}
+
+} // namespace rnopus
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "PacketFraming.h"
+
+#if __has_include("opus/opus.h")
+#include "opus/opus.h"
+#elif __has_include("opus.h")
+#include "opus.h"
+#else
+#error "Could not find opus.h"
+#endif
+
+namespace rnopus {
+
+struct RepacketizeResult {
+    // The output packets, framed as requested
+    std::vector<uint8_t> data;
+    // Bare size of each output packet, whatever the framing
+    std::vector<uint32_t> lengths;
+    int framesOut = 0; // Opus frames across all output packets
+    double processingTimeMs = 0;
+};
+
+// Regroups the frames of existing Opus packets without re-encoding, through
+// an OpusRepacketizer. Frames only merge with neighbours of the same mode,
+// bandwidth, frame size and channel count, and an output packet never
+// exceeds 120 ms; a merge that would break either starts a new packet.
+// Zero-length packets (lost or DTX) pass through as they are. Invalid
+// packets throw std::runtime_error. Not thread safe; use one per thread.
+class Repacketizer {
+public:
+    Repacketizer();
+    ~Repacketizer();
+
+    Repacketizer(const Repacketizer&) = delete;
+    Repacketizer& operator=(const Repacketizer&) = delete;
+
+    // Merges each run of `packetsPerGroup` packets into one packet (0 merges
+    // as many as fit).
+    RepacketizeResult merge(const std::vector<PacketView>& packets, int packetsPerGroup, Framing framing);
+
+    // Splits every packet into single-frame packets.
+    RepacketizeResult split(const std::vector<PacketView>& packets, Framing framing);
+
+    // Keeps frames [firstFrame, firstFrame + frameCount) of the stream,
+    // counted across all packets, merged into as few packets as fit.
+    // frameCount < 0 keeps everything from firstFrame on.
+    RepacketizeResult extractFrames(const std::vector<PacketView>& packets, int64_t firstFrame, int64_t frameCount,
+                                    Framing framing);
+
+private:
+    // Adds one packet to the pending output, flushing first when it cannot
+    // join it. `data` must stay valid until the next flush.
+    void append(const uint8_t* data, size_t size, size_t index, RepacketizeResult& result);
+    // Emits the pending frames, if any, as one packet.
+    void flush(RepacketizeResult& result);
+    void emit(const uint8_t* data, size_t size, RepacketizeResult& result);
+
+    OpusRepacketizer* repacketizer_ = nullptr;
+    size_t pendingBytes_ = 0;
+    Framing framing_ = Framing::U16;
+    std::vector<uint8_t> packet_;                // Output scratch
+    std::vector<std::vector<uint8_t>> slices_;   // extractFrames() partial packets until flushed
+};
+
+} // namespace rnopus
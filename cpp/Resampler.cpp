@@ -0,0 +1,236 @@
+#include "Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define RNOPUS_RESAMPLER_SSE 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define RNOPUS_RESAMPLER_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace rnopus {
+
+namespace {
+
+constexpr uint32_t kMaxPhases = 1024;
+
+struct FilterDesign {
+    size_t taps;   // At the lower of the two rates
+    double cutoff; // Fraction of the lower Nyquist frequency
+    double beta;   // Kaiser window shape
+};
+
+// Transition bands of 25%, 15% and 10% of the lower Nyquist frequency,
+// centred just below it; beta follows Kaiser's formula for the attenuation
+// that length reaches.
+FilterDesign filterDesign(ResamplerQuality quality) {
+    switch (quality) {
+        case ResamplerQuality::Low:
+            return {24, 0.875, 4.66};
+        case ResamplerQuality::Medium:
+            return {64, 0.925, 7.52};
+        case ResamplerQuality::High:
+            return {128, 0.95, 10.04};
+    }
+    return {64, 0.925, 7.52};
+}
+
+// Zeroth-order modified Bessel function of the first kind
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    double half = x / 2.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (half / k) * (half / k);
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+float dotProduct(const float* a, const float* b, size_t count) {
+    size_t i = 0;
+    float sum = 0.0f;
+#if RNOPUS_RESAMPLER_SSE
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    sum = _mm_cvtss_f32(acc);
+#elif RNOPUS_RESAMPLER_NEON
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (; i + 8 <= count; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+#if defined(__aarch64__)
+    sum = vaddvq_f32(acc);
+#else
+    float32x2_t pair = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(pair, pair), 0);
+#endif
+#endif
+    for (; i < count; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+} // namespace
+
+ResamplerQuality parseResamplerQuality(const std::string& name) {
+    if (name == "low") return ResamplerQuality::Low;
+    if (name == "medium") return ResamplerQuality::Medium;
+    if (name == "high") return ResamplerQuality::High;
+    throw std::invalid_argument("Unknown resample quality: " + name);
+}
+
+Resampler::Resampler(int inputRate, int outputRate, int channels, ResamplerQuality quality)
+    : inputRate_(inputRate), outputRate_(outputRate), channels_(channels) {
+    if (inputRate <= 0 || outputRate <= 0 || channels <= 0) {
+        throw std::invalid_argument("Resampler rates and channel count must be positive");
+    }
+    uint32_t divisor = std::gcd(static_cast<uint32_t>(inputRate), static_cast<uint32_t>(outputRate));
+    upFactor_ = static_cast<uint32_t>(outputRate) / divisor;
+    downFactor_ = static_cast<uint32_t>(inputRate) / divisor;
+    if (upFactor_ > kMaxPhases) {
+        throw std::invalid_argument("Unsupported resampling ratio " + std::to_string(inputRate) + " to " +
+                                    std::to_string(outputRate));
+    }
+
+    // Downsampling narrows the passband to the output Nyquist frequency and
+    // stretches the filter by the same factor to keep the transition sharp.
+    FilterDesign design = filterDesign(quality);
+    double ratio = std::min(1.0, double(upFactor_) / downFactor_);
+    size_t taps = static_cast<size_t>(std::ceil(design.taps / ratio));
+    taps_ = (taps + 3) / 4 * 4;
+    const double cutoff = design.cutoff * ratio;
+    const double delay = (taps_ - 1) / 2.0;
+    const double halfWidth = taps_ / 2.0;
+    const double windowScale = 1.0 / besselI0(design.beta);
+
+    coefficients_.resize(upFactor_ * taps_);
+    for (uint32_t phase = 0; phase < upFactor_; phase++) {
+        float* h = coefficients_.data() + phase * taps_;
+        double sum = 0.0;
+        for (size_t k = 0; k < taps_; k++) {
+            // Distance from the output instant to input frame k, which is
+            // taps_ - 1 - k frames before the newest one
+            double t = double(phase) / upFactor_ + double(taps_ - 1 - k) - delay;
+            double x = t / halfWidth;
+            double window = std::fabs(x) >= 1.0 ? 0.0 : besselI0(design.beta * std::sqrt(1.0 - x * x)) * windowScale;
+            double arg = M_PI * cutoff * t;
+            double sinc = std::fabs(arg) < 1e-9 ? 1.0 : std::sin(arg) / arg;
+            double value = cutoff * sinc * window;
+            h[k] = static_cast<float>(value);
+            sum += value;
+        }
+        // Unity gain at DC for every phase
+        for (size_t k = 0; k < taps_; k++) {
+            h[k] = static_cast<float>(h[k] / sum);
+        }
+    }
+
+    input_.assign(channels_, std::vector<float>(taps_ - 1, 0.0f));
+}
+
+size_t Resampler::maxOutputFrames(size_t frames) const {
+    return static_cast<size_t>((uint64_t(frames) * upFactor_ + phase_) / downFactor_) + 1;
+}
+
+size_t Resampler::process(const float* in, size_t frames, float* out) {
+    const size_t history = taps_ - 1;
+    for (int channel = 0; channel < channels_; channel++) {
+        std::vector<float>& buffer = input_[channel];
+        buffer.resize(history + frames);
+        float* block = buffer.data() + history;
+        for (size_t i = 0; i < frames; i++) {
+            block[i] = in[i * channels_ + channel];
+        }
+    }
+
+    size_t produced = 0;
+    uint64_t position = position_;
+    uint32_t phase = phase_;
+    while (position < frames) {
+        const float* h = coefficients_.data() + size_t(phase) * taps_;
+        float* frame = out + produced * channels_;
+        for (int channel = 0; channel < channels_; channel++) {
+            frame[channel] = dotProduct(input_[channel].data() + position, h, taps_);
+        }
+        produced++;
+        phase += downFactor_;
+        position += phase / upFactor_;
+        phase %= upFactor_;
+    }
+    position_ = position - frames;
+    phase_ = phase;
+
+    // The newest frames become the next call's history
+    for (std::vector<float>& buffer : input_) {
+        std::memmove(buffer.data(), buffer.data() + frames, history * sizeof(float));
+        buffer.resize(history);
+    }
+    return produced;
+}
+
+size_t Resampler::process(const int16_t* in, size_t frames, int16_t* out) {
+    floatIn_.resize(frames * channels_);
+    for (size_t i = 0; i < floatIn_.size(); i++) {
+        floatIn_[i] = in[i];
+    }
+    floatOut_.resize(maxOutputFrames(frames) * channels_);
+    size_t produced = process(floatIn_.data(), frames, floatOut_.data());
+    for (size_t i = 0; i < produced * channels_; i++) {
+        float sample = std::round(floatOut_[i]);
+        out[i] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, sample)));
+    }
+    return produced;
+}
+
+size_t Resampler::flush(float* out) {
+    std::vector<float> silence((taps_ - 1) * channels_, 0.0f);
+    size_t produced = process(silence.data(), taps_ - 1, out);
+    reset();
+    return produced;
+}
+
+size_t Resampler::flush(int16_t* out) {
+    std::vector<int16_t> silence((taps_ - 1) * channels_, 0);
+    size_t produced = process(silence.data(), taps_ - 1, out);
+    reset();
+    return produced;
+}
+
+size_t Resampler::delay() const {
+    // The first output is centred (taps_ - 1) / 2 input frames before the
+    // first input frame
+    return static_cast<size_t>((uint64_t(taps_ - 1) * upFactor_ + downFactor_) / (2 * downFactor_));
+}
+
+void Resampler::reset() {
+    for (std::vector<float>& buffer : input_) {
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+    }
+    position_ = 0;
+    phase_ = 0;
+}
+
+} // namespace rnopus
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rnopus {
+
+// Filter length and stopband attenuation of the resampler, trading CPU for
+// quality: roughly 50 dB (24 taps), 75 dB (64 taps) and 100 dB (128 taps)
+// per output sample, more when downsampling.
+enum class ResamplerQuality {
+    Low,
+    Medium,
+    High,
+};
+
+// Maps "low", "medium" and "high" to a ResamplerQuality. Throws
+// std::invalid_argument for anything else.
+ResamplerQuality parseResamplerQuality(const std::string& name);
+
+// Polyphase windowed-sinc (Kaiser) sample rate converter for interleaved
+// PCM. The rate ratio is reduced to L/M and one filter phase is precomputed
+// for each of the L output positions between two input samples. Filter
+// history and phase carry across process() calls, so a stream can be fed in
+// chunks of any size. The output lags the input by about half the filter
+// length (delay()); flush() drains it at the end of a stream. Not thread
+// safe.
+class Resampler {
+public:
+    // Throws std::invalid_argument for non-positive rates or channels, or a
+    // ratio needing more than 1024 filter phases (e.g. 48000 to 44056).
+    Resampler(int inputRate, int outputRate, int channels, ResamplerQuality quality = ResamplerQuality::Medium);
+
+    // Upper bound on the frames process() writes for `frames` input frames.
+    size_t maxOutputFrames(size_t frames) const;
+
+    // Converts `frames` interleaved input frames and returns the frames
+    // written to `out`, which has room for maxOutputFrames(frames).
+    size_t process(const float* in, size_t frames, float* out);
+    size_t process(const int16_t* in, size_t frames, int16_t* out);
+
+    // Ends the stream: feeds taps - 1 frames of silence to push out the
+    // outputs still held in the filter, writes them to `out`, which has room
+    // for maxFlushFrames(), and returns how many there were. Then resets.
+    size_t flush(float* out);
+    size_t flush(int16_t* out);
+    size_t maxFlushFrames() const { return maxOutputFrames(taps_ - 1); }
+
+    // Output frames by which the output lags the input: a stream's first
+    // delay() outputs precede its first input frame.
+    size_t delay() const;
+
+    // Clears the filter history and phase.
+    void reset();
+
+    int inputRate() const { return inputRate_; }
+    int outputRate() const { return outputRate_; }
+    int channels() const { return channels_; }
+
+private:
+    int inputRate_;
+    int outputRate_;
+    int channels_;
+    uint32_t upFactor_;   // L
+    uint32_t downFactor_; // M
+    size_t taps_;         // Per phase, a multiple of 4
+    // Phase p holds taps_ coefficients in input order (oldest sample first)
+    std::vector<float> coefficients_;
+    // Per channel: taps_ - 1 frames of history, then the current block
+    std::vector<std::vector<float>> input_;
+    uint64_t position_ = 0; // Next output's newest input frame, relative to the block
+    uint32_t phase_ = 0;    // Next output's fractional position, in 1/L frames
+    std::vector<float> floatIn_;  // int16 path scratch
+    std::vector<float> floatOut_;
+};
+
+} // namespace rnopus
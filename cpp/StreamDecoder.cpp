@@ -0,0 +1,60 @@
+#include "StreamDecoder.h"
+
+#include <stdexcept>
+
+namespace rnopus {
+
+namespace {
+
+// Longest Opus packet (48 frames of 1275 bytes) plus a generous prefix. A
+// held tail beyond this can never complete, so the stream is corrupt.
+constexpr size_t kMaxPendingBytes = 48 * 1275 + 16;
+
+} // namespace
+
+StreamDecoder::StreamDecoder(opus_int32 sampleRate, int channels, const FramingOptions& framing)
+    : session_(sampleRate, channels), framing_(framing) {
+    if (framing_.framing == Framing::Lengths) {
+        throw std::invalid_argument("lengths framing cannot carry a partial packet");
+    }
+    if (framing_.framing == Framing::Fixed && framing_.packetSize <= 0) {
+        throw std::invalid_argument("packetSize must be positive");
+    }
+}
+
+DecodeResult StreamDecoder::feed(const uint8_t* data, size_t size, const DecodeOptions& options) {
+    if (!options.sequenceNumbers.empty()) {
+        throw std::invalid_argument("sequenceNumbers are not supported when streaming");
+    }
+
+    // Without a held tail the chunk is split in place; only what is left
+    // over is copied.
+    const uint8_t* input = data;
+    size_t inputSize = size;
+    if (!pending_.empty()) {
+        pending_.insert(pending_.end(), data, data + size);
+        input = pending_.data();
+        inputSize = pending_.size();
+    }
+
+    size_t consumed = 0;
+    PacketList list = splitCompletePackets(input, inputSize, framing_, consumed);
+    if (inputSize - consumed > kMaxPendingBytes) {
+        throw std::invalid_argument("Incomplete packet longer than any Opus packet");
+    }
+    DecodeResult decoded = session_.decode(list.packets, options);
+
+    if (input == data) {
+        pending_.assign(data + consumed, data + size);
+    } else {
+        pending_.erase(pending_.begin(), pending_.begin() + consumed);
+    }
+    return decoded;
+}
+
+void StreamDecoder::reset() {
+    pending_.clear();
+    session_.reset();
+}
+
+} // namespace rnopus
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DecoderSession.h"
+
+namespace rnopus {
+
+// Decodes a framed packet stream that arrives in arbitrary chunks, such as a
+// progressive download. Each feed() decodes every packet the bytes so far
+// complete and keeps an incomplete trailing packet for the next call, so
+// chunk boundaries never lose audio. Not thread safe; callers serialize
+// access.
+class StreamDecoder {
+public:
+    // Throws like DecoderSession, and std::invalid_argument for Lengths
+    // framing or a non-positive Fixed packetSize.
+    StreamDecoder(opus_int32 sampleRate, int channels, const FramingOptions& framing);
+
+    // Decodes the packets `data` completes and returns only their PCM.
+    // sequenceNumbers cannot be matched to packets the caller has not seen
+    // split, so they are rejected with std::invalid_argument, as is an
+    // incomplete packet longer than any Opus packet. Call reset() after it
+    // throws.
+    DecodeResult feed(const uint8_t* data, size_t size, const DecodeOptions& options = {});
+
+    // Drops the held bytes and the decoder history, for a seek or a new
+    // stream.
+    void reset();
+
+    // Bytes of an incomplete packet held for the next feed()
+    size_t pendingBytes() const { return pending_.size(); }
+
+    DecoderSession& session() { return session_; }
+
+private:
+    DecoderSession session_;
+    FramingOptions framing_;
+    std::vector<uint8_t> pending_;
+};
+
+} // namespace rnopus
@@ -0,0 +1,204 @@
+#include "StreamEncoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace rnopus {
+
+namespace {
+
+// Feedback thresholds for updateNetwork()
+constexpr double kBackoffLossPercent = 10;
+constexpr double kBackoffRttMs = 400;
+constexpr double kProbeLossPercent = 2;
+constexpr double kProbeRttMs = 250;
+constexpr double kFecLossPercent = 1;
+
+} // namespace
+
+StreamEncoder::StreamEncoder(const StreamEncoderConfig& config)
+    : encoder_(config.encoder), minBitrate_(config.minBitrate) {
+    const EncoderConfig& encoder = config.encoder;
+    if (config.maxBitrate > 0) {
+        maxBitrate_ = config.maxBitrate;
+    } else if (encoder.bitrate > 0) {
+        maxBitrate_ = encoder.bitrate;
+    } else {
+        maxBitrate_ = 64000 * encoder.channels;
+    }
+    if (minBitrate_ < 500 || maxBitrate_ < minBitrate_) {
+        throw std::invalid_argument("Expected 500 <= minBitrate <= maxBitrate");
+    }
+
+    const double frameMs = 1000.0 * encoder_.frameSize() / encoder_.sampleRate();
+    maxQueuedPackets_ = std::max<size_t>(1, static_cast<size_t>(config.maxQueueMs / frameMs));
+
+    frame_.resize(static_cast<size_t>(encoder_.frameSize()) * encoder_.channels());
+    size_t typicalPacket = static_cast<size_t>(maxBitrate_ * frameMs / 8000) + 16;
+    queue_.resize(maxQueuedPackets_ * typicalPacket + EncoderSession::kMaxPacketBytes);
+    lengths_.resize(maxQueuedPackets_);
+
+    stats_.bitrate = encoder_.bitrate();
+    stats_.packetLossPercent = encoder.packetLossPercent;
+    stats_.fec = encoder.fec;
+}
+
+void StreamEncoder::push(const float* pcm, size_t frames) {
+    const size_t frameSize = static_cast<size_t>(encoder_.frameSize());
+    const size_t channels = static_cast<size_t>(encoder_.channels());
+    stats_.samplesPushed += frames;
+
+    while (frames > 0) {
+        // Whole frames straight from the caller's buffer
+        if (filled_ == 0 && frames >= frameSize) {
+            encodeFrame(pcm);
+            pcm += frameSize * channels;
+            frames -= frameSize;
+            continue;
+        }
+        size_t count = std::min(frames, frameSize - filled_);
+        std::copy_n(pcm, count * channels, frame_.data() + filled_ * channels);
+        filled_ += count;
+        pcm += count * channels;
+        frames -= count;
+        if (filled_ == frameSize) {
+            encodeFrame(frame_.data());
+            filled_ = 0;
+        }
+    }
+}
+
+void StreamEncoder::push(const opus_int16* pcm, size_t frames) {
+    const size_t frameSize = static_cast<size_t>(encoder_.frameSize());
+    const size_t channels = static_cast<size_t>(encoder_.channels());
+    stats_.samplesPushed += frames;
+
+    while (frames > 0) {
+        size_t count = std::min(frames, frameSize - filled_);
+        float* out = frame_.data() + filled_ * channels;
+        for (size_t i = 0; i < count * channels; i++) {
+            out[i] = pcm[i] * (1.0f / 32768);
+        }
+        filled_ += count;
+        pcm += count * channels;
+        frames -= count;
+        if (filled_ == frameSize) {
+            encodeFrame(frame_.data());
+            filled_ = 0;
+        }
+    }
+}
+
+void StreamEncoder::encodeFrame(const float* pcm) {
+    if (queuedPackets_ >= maxQueuedPackets_) {
+        dropOldest();
+    }
+    reserveQueue();
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    int size = encoder_.encodeFrame(pcm, queue_.data() + queueEnd_, EncoderSession::kMaxPacketBytes);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    if (size < 0) {
+        throw std::runtime_error(std::string("Opus encode failed: ") + opus_strerror(size));
+    }
+
+    queueEnd_ += size;
+    lengths_[(lengthsHead_ + queuedPackets_) % maxQueuedPackets_] = static_cast<uint32_t>(size);
+    queuedPackets_++;
+    encodeTimeMs_ += std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    stats_.packetsEncoded++;
+    stats_.bytesEncoded += size;
+}
+
+// O(1): a stalled consumer makes this run on every frame
+void StreamEncoder::dropOldest() {
+    queueStart_ += lengths_[lengthsHead_];
+    lengthsHead_ = (lengthsHead_ + 1) % maxQueuedPackets_;
+    queuedPackets_--;
+    stats_.packetsDropped++;
+}
+
+void StreamEncoder::reserveQueue() {
+    const size_t maxPacket = static_cast<size_t>(EncoderSession::kMaxPacketBytes);
+    if (queue_.size() - queueEnd_ >= maxPacket) {
+        return;
+    }
+    const size_t live = queueEnd_ - queueStart_;
+    if (queueStart_ >= live && queue_.size() - live >= maxPacket) {
+        // Each byte moved here was preceded by at least as many dropped, so
+        // compaction stays amortized O(1) per packet
+        std::memmove(queue_.data(), queue_.data() + queueStart_, live);
+        queueStart_ = 0;
+        queueEnd_ = live;
+    } else {
+        // Only when VBR peaks outrun the estimate made at construction
+        queue_.resize(queue_.size() * 2);
+    }
+}
+
+void StreamEncoder::pull(EncodeResult& out, Framing framing) {
+    out.data.reserve(out.data.size() + (queueEnd_ - queueStart_) + queuedPackets_ * 2);
+    size_t offset = queueStart_;
+    for (size_t i = 0; i < queuedPackets_; i++) {
+        uint32_t size = lengths_[(lengthsHead_ + i) % maxQueuedPackets_];
+        appendPacket(out.data, queue_.data() + offset, size, framing);
+        out.lengths.push_back(size);
+        offset += size;
+    }
+    out.packetsEncoded += static_cast<int>(queuedPackets_);
+    out.samplesEncoded += static_cast<int>(queuedPackets_) * encoder_.frameSize();
+    out.processingTimeMs += encodeTimeMs_;
+
+    queueStart_ = 0;
+    queueEnd_ = 0;
+    lengthsHead_ = 0;
+    queuedPackets_ = 0;
+    encodeTimeMs_ = 0;
+}
+
+void StreamEncoder::flush() {
+    if (filled_ == 0) {
+        return;
+    }
+    const size_t channels = static_cast<size_t>(encoder_.channels());
+    std::fill(frame_.begin() + filled_ * channels, frame_.end(), 0.0f);
+    encodeFrame(frame_.data());
+    filled_ = 0;
+}
+
+void StreamEncoder::updateNetwork(double lossPercent, double rttMs) {
+    lossPercent = std::min(100.0, std::max(0.0, lossPercent));
+
+    int percent = static_cast<int>(std::lround(lossPercent));
+    if (encoder_.setPacketLossPercent(percent) == OPUS_OK) {
+        stats_.packetLossPercent = percent;
+    }
+    bool fec = lossPercent >= kFecLossPercent;
+    if (encoder_.setFec(fec) == OPUS_OK) {
+        stats_.fec = fec;
+    }
+
+    int bitrate = stats_.bitrate > 0 ? stats_.bitrate : maxBitrate_;
+    if (lossPercent > kBackoffLossPercent || rttMs > kBackoffRttMs) {
+        bitrate = static_cast<int>(bitrate * 0.85);
+    } else if (lossPercent < kProbeLossPercent && rttMs < kProbeRttMs) {
+        bitrate += std::max(1000, bitrate / 20);
+    }
+    bitrate = std::min(maxBitrate_, std::max(minBitrate_, bitrate));
+    if (encoder_.setBitrate(bitrate) == OPUS_OK) {
+        stats_.bitrate = bitrate;
+    }
+}
+
+StreamEncoderStats StreamEncoder::stats() const {
+    StreamEncoderStats stats = stats_;
+    stats.framesBuffered = filled_;
+    stats.packetsQueued = queuedPackets_;
+    return stats;
+}
+
+} // namespace rnopus
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "EncoderSession.h"
+
+namespace rnopus {
+
+struct StreamEncoderConfig {
+    EncoderConfig encoder;
+    // Range updateNetwork() keeps the bitrate in. A zero maxBitrate means
+    // the configured bitrate (or 64 kb/s per channel with OPUS_AUTO).
+    int minBitrate = 6000;
+    int maxBitrate = 0;
+    // Encoded audio kept for a consumer that falls behind; older packets are
+    // dropped first.
+    int maxQueueMs = 1000;
+};
+
+struct StreamEncoderStats {
+    uint64_t packetsEncoded = 0;
+    uint64_t packetsDropped = 0; // Queue overflow
+    uint64_t bytesEncoded = 0;
+    uint64_t samplesPushed = 0;  // Per channel
+    size_t framesBuffered = 0;   // Samples per channel waiting for a full frame
+    size_t packetsQueued = 0;
+    int bitrate = 0;
+    int packetLossPercent = 0;
+    bool fec = false;
+};
+
+// Push-PCM / pull-packets encoder for live audio. Accepts any chunk size,
+// encodes each frame as soon as it is complete and queues the packets until
+// pulled. Steady state does not allocate: the frame buffer and the packet
+// queue are sized up front and reused. Not thread safe; callers serialize
+// access.
+class StreamEncoder {
+public:
+    // Throws like EncoderSession, and std::invalid_argument for a bad range.
+    explicit StreamEncoder(const StreamEncoderConfig& config);
+
+    // Appends interleaved PCM, `frames` samples per channel. Throws
+    // std::runtime_error if libopus fails on a frame.
+    void push(const opus_int16* pcm, size_t frames);
+    void push(const float* pcm, size_t frames);
+
+    // Moves every queued packet into `out`, framed as requested.
+    void pull(EncodeResult& out, Framing framing);
+
+    // Pads the buffered partial frame with silence and encodes it.
+    void flush();
+
+    // Retunes the encoder from receiver feedback: expected loss and FEC
+    // follow the reported loss, and the bitrate backs off multiplicatively
+    // under loss or high round-trip time and recovers additively.
+    void updateNetwork(double lossPercent, double rttMs);
+
+    StreamEncoderStats stats() const;
+
+    int frameSize() const { return encoder_.frameSize(); }
+    int lookahead() const { return encoder_.lookahead(); }
+    int channels() const { return encoder_.channels(); }
+
+private:
+    void encodeFrame(const float* pcm);
+    void dropOldest();
+    // Makes room for one more packet at the end of queue_
+    void reserveQueue();
+
+    EncoderSession encoder_;
+    int minBitrate_;
+    int maxBitrate_;
+    size_t maxQueuedPackets_;
+
+    std::vector<float> frame_; // One frame, filled across pushes
+    size_t filled_ = 0;        // Samples per channel in frame_
+
+    // Queued packets back to back in [queueStart_, queueEnd_). Dropping the
+    // oldest only advances queueStart_; the bytes are compacted once the
+    // dropped prefix outweighs the live ones.
+    std::vector<uint8_t> queue_;
+    size_t queueStart_ = 0;
+    size_t queueEnd_ = 0;
+    // Ring of their sizes, the oldest at lengthsHead_
+    std::vector<uint32_t> lengths_;
+    size_t lengthsHead_ = 0;
+    size_t queuedPackets_ = 0;
+    double encodeTimeMs_ = 0; // Since the last pull
+
+    StreamEncoderStats stats_;
+};
+
+} // namespace rnopus
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rnopus {
+
+// Fixed set of worker threads pulling tasks from one FIFO queue.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount = defaultThreadCount());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Tasks submitted after shutdown() run inline on the calling thread.
+    void submit(std::function<void()> task);
+
+    // Runs every queued task to completion, then joins the workers.
+    void shutdown();
+
+    size_t size() const { return threads_.size(); }
+
+    // One worker per hardware thread.
+    static size_t defaultThreadCount();
+
+private:
+    void workerLoop();
+
+    std::mutex mutex_;
+    std::condition_variable available_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> threads_;
+    bool stopping_ = false;
+};
+
+// Runs tasks one at a time, in the order they were posted, on a shared pool.
+// Used to serialize work on state that is not thread safe (e.g. a decoder)
+// without dedicating a thread to it.
+class SerialQueue : public std::enable_shared_from_this<SerialQueue> {
+public:
+    explicit SerialQueue(std::shared_ptr<ThreadPool> pool);
+
+    void post(std::function<void()> task);
+
+private:
+    void drain();
+
+    std::shared_ptr<ThreadPool> pool_;
+    std::mutex mutex_;
+    std::deque<std::function<void()>> tasks_;
+    bool draining_ = false;
+};
+
+} // namespace rnopus
@@ -0,0 +1,202 @@
+#include "WavWriter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace rnopus {
+
+namespace {
+
+// Page-aligned so full-buffer writes go straight to the page cache.
+constexpr size_t kBufferAlignment = 4096;
+
+// RIFF sizes are 32-bit and count everything after the first 8 bytes,
+// including the pad byte after an odd-sized data chunk.
+constexpr uint64_t kMaxDataBytes = 0xFFFFFFFFull - (kWavHeaderSize - 8) - 1;
+
+void putLE16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void putLE32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+    out[2] = static_cast<uint8_t>(value >> 16);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+std::string errnoMessage(const char* what, const std::string& path) {
+    return std::string(what) + " " + path + ": " + std::strerror(errno);
+}
+
+} // namespace
+
+void buildWavHeader(uint8_t* header, uint32_t sampleRate, uint16_t channels, uint16_t bitsPerSample, uint32_t dataBytes) {
+    uint16_t blockAlign = static_cast<uint16_t>(channels * bitsPerSample / 8);
+    std::memcpy(header, "RIFF", 4);
+    putLE32(header + 4, static_cast<uint32_t>(kWavHeaderSize - 8) + dataBytes + (dataBytes & 1));
+    std::memcpy(header + 8, "WAVE", 4);
+    std::memcpy(header + 12, "fmt ", 4);
+    putLE32(header + 16, 16);  // fmt chunk size
+    putLE16(header + 20, 1);   // PCM
+    putLE16(header + 22, channels);
+    putLE32(header + 24, sampleRate);
+    putLE32(header + 28, sampleRate * blockAlign);
+    putLE16(header + 32, blockAlign);
+    putLE16(header + 34, bitsPerSample);
+    std::memcpy(header + 36, "data", 4);
+    putLE32(header + 40, dataBytes);
+}
+
+WavWriter::WavWriter(const std::string& path, uint32_t sampleRate, uint16_t channels, uint16_t bitsPerSample, size_t bufferSize)
+    : path_(path),
+      sampleRate_(sampleRate),
+      channels_(channels),
+      bitsPerSample_(bitsPerSample),
+      bufferSize_(bufferSize < kBufferAlignment ? kBufferAlignment : bufferSize / kBufferAlignment * kBufferAlignment) {
+    if (sampleRate == 0 || channels == 0 || bitsPerSample == 0 || bitsPerSample % 8 != 0) {
+        throw std::runtime_error("Invalid WAV format");
+    }
+
+    void* buffer = nullptr;
+    if (posix_memalign(&buffer, kBufferAlignment, bufferSize_) != 0) {
+        throw std::runtime_error("Failed to allocate WAV write buffer");
+    }
+    buffer_ = static_cast<uint8_t*>(buffer);
+
+    fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::string message = errnoMessage("Failed to open", path);
+        std::free(buffer_);
+        throw std::runtime_error(message);
+    }
+
+    // Placeholder sizes; finalize() fills them in.
+    buildWavHeader(buffer_, sampleRate_, channels_, bitsPerSample_, 0);
+    buffered_ = kWavHeaderSize;
+}
+
+WavWriter::~WavWriter() {
+    if (!finalized()) {
+        try {
+            finalize();
+        } catch (const std::exception&) {
+            if (fd_ >= 0) {
+                close(fd_);
+            }
+        }
+    }
+    std::free(buffer_);
+}
+
+void WavWriter::append(const uint8_t* data, size_t size) {
+    if (finalized()) {
+        throw std::runtime_error("WAV writer is already finalized");
+    }
+    if (dataBytes_ + size > kMaxDataBytes) {
+        throw std::runtime_error("WAV data would exceed 4 GiB");
+    }
+
+    size_t room = bufferSize_ - buffered_;
+    if (size < room) {
+        std::memcpy(buffer_ + buffered_, data, size);
+        buffered_ += size;
+        dataBytes_ += size;
+        return;
+    }
+
+    // Empty the buffer first, so a failed write never leaves part of this
+    // call queued; then write whole buffers straight from the input.
+    flush();
+    size_t direct = size / bufferSize_ * bufferSize_;
+    if (direct > 0) {
+        size_t written = 0;
+        try {
+            writeAll(data, direct, written);
+        } catch (const std::runtime_error&) {
+            dataBytes_ += written;
+            throw;
+        }
+        data += direct;
+        size -= direct;
+        dataBytes_ += direct;
+    }
+    std::memcpy(buffer_, data, size);
+    buffered_ = size;
+    dataBytes_ += size;
+}
+
+void WavWriter::finalize() {
+    if (finalized()) {
+        return;
+    }
+    std::string message;
+    try {
+        flush();
+        // RIFF chunks are word aligned; only byte-sized partial frames can
+        // leave the data chunk odd.
+        if (dataBytes_ & 1) {
+            const uint8_t pad = 0;
+            size_t written = 0;
+            writeAll(&pad, 1, written);
+        }
+    } catch (const std::runtime_error& e) {
+        message = e.what();
+        // Describe only the samples that reached the file
+        dataBytes_ -= std::min<uint64_t>(dataBytes_, buffered_);
+        buffered_ = 0;
+    }
+
+    uint8_t header[kWavHeaderSize];
+    buildWavHeader(header, sampleRate_, channels_, bitsPerSample_, static_cast<uint32_t>(dataBytes_));
+    // Only the RIFF size (offset 4) and data size (offset 40) change.
+    bool patched = pwrite(fd_, header + 4, 4, 4) == 4 && pwrite(fd_, header + 40, 4, 40) == 4;
+    if (!patched && message.empty()) {
+        message = errnoMessage("Failed to finalize", path_);
+    }
+
+    int fd = fd_;
+    fd_ = -1;
+    if (close(fd) != 0 && message.empty()) {
+        message = errnoMessage("Failed to close", path_);
+    }
+    if (!message.empty()) {
+        throw std::runtime_error(message);
+    }
+}
+
+// Keeps whatever did not reach the file at the front of the buffer, so a
+// retry neither repeats nor skips bytes.
+void WavWriter::flush() {
+    size_t written = 0;
+    try {
+        writeAll(buffer_, buffered_, written);
+    } catch (const std::runtime_error&) {
+        std::memmove(buffer_, buffer_ + written, buffered_ - written);
+        buffered_ -= written;
+        throw;
+    }
+    buffered_ = 0;
+}
+
+void WavWriter::writeAll(const uint8_t* data, size_t size, size_t& written) {
+    while (written < size) {
+        ssize_t result = write(fd_, data + written, size - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(errnoMessage("Failed to write", path_));
+        }
+        written += static_cast<size_t>(result);
+    }
+}
+
+} // namespace rnopus
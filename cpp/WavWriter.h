@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace rnopus {
+
+constexpr size_t kWavHeaderSize = 44;
+
+// Canonical 44-byte PCM WAV header, little-endian regardless of the host.
+void buildWavHeader(uint8_t* header, uint32_t sampleRate, uint16_t channels, uint16_t bitsPerSample, uint32_t dataBytes);
+
+// Streams PCM into a WAV file with constant memory. A placeholder header is
+// written on open; finalize() patches the RIFF and data sizes in place.
+// Not thread safe; callers serialize access per writer.
+class WavWriter {
+public:
+    static constexpr size_t kDefaultBufferSize = 256 * 1024;
+
+    // Throws std::runtime_error if the file cannot be created or the format
+    // is invalid.
+    WavWriter(const std::string& path, uint32_t sampleRate, uint16_t channels,
+              uint16_t bitsPerSample = 16, size_t bufferSize = kDefaultBufferSize);
+
+    // Finalizes the file if finalize() was never called; errors are ignored.
+    ~WavWriter();
+
+    WavWriter(const WavWriter&) = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+
+    // Appends interleaved samples. Partial frames are allowed across calls.
+    // Throws std::runtime_error on I/O errors or if the file would exceed
+    // the 4 GiB WAV limit; dataBytes() then counts only what was kept.
+    void append(const uint8_t* data, size_t size);
+    void append(const int16_t* samples, size_t count) {
+        append(reinterpret_cast<const uint8_t*>(samples), count * sizeof(int16_t));
+    }
+
+    // Flushes, pads an odd-sized data chunk, patches the header and closes
+    // the file. If the flush fails the header still describes the bytes
+    // already written. Further appends throw.
+    void finalize();
+
+    const std::string& path() const { return path_; }
+    uint32_t sampleRate() const { return sampleRate_; }
+    uint16_t channels() const { return channels_; }
+    uint64_t dataBytes() const { return dataBytes_; }
+    // Per channel
+    uint64_t frames() const { return dataBytes_ / (channels_ * (bitsPerSample_ / 8)); }
+    bool finalized() const { return fd_ < 0; }
+
+private:
+    void flush();
+    // Advances `written` as bytes reach the file, so it is accurate when
+    // this throws
+    void writeAll(const uint8_t* data, size_t size, size_t& written);
+
+    std::string path_;
+    uint32_t sampleRate_;
+    uint16_t channels_;
+    uint16_t bitsPerSample_;
+    int fd_ = -1;
+    uint8_t* buffer_ = nullptr;
+    size_t bufferSize_;
+    size_t buffered_ = 0;
+    uint64_t dataBytes_ = 0;
+};
+
+} // namespace rnopus
@@ -1,6 +1,488 @@
 import type { TurboModule } from 'react-native';
 import { TurboModuleRegistry } from 'react-native';
 
+// How packets are delimited in the input buffer:
+// - 'fixed' (default): every packet is `packetSize` bytes
+// - 'u16': each packet is prefixed with its length as a big-endian uint16
+// - 'varint': each packet is prefixed with its length as an unsigned LEB128
+// - 'lengths': packets are back to back, `lengths` gives their sizes
+// - 'self-delimited': RFC 6716 Appendix B self-delimiting packets
+// `outputFormat` is 'int16' (default) or 'float32'.
+// With `concealLoss`, zero-length packets, undecodable packets and gaps in
+// `sequenceNumbers` (16-bit, one per packet) are filled from in-band FEC or
+// packet loss concealment instead of being dropped. `dred` (implies
+// concealLoss) also recovers bursts from Deep Redundancy when libopus
+// supports it. With `ring` (a createPcmRing handle) the PCM is written into
+// that ring as float32 instead of being returned. A ring has one producer:
+// the first decoder to write into it owns it until that decoder is
+// destroyed, and decodes from any other decoder fail.
+export type DecodeOptions = {
+  framing?: string;
+  packetSize?: number;
+  lengths?: number[];
+  outputFormat?: string;
+  concealLoss?: boolean;
+  dred?: boolean;
+  sequenceNumbers?: number[];
+  ring?: number;
+};
+
+// `pcm` is an Int16Array, or a Float32Array for outputFormat 'float32',
+// backed by the native output buffer. Sample counts are per channel at the
+// decoding rate, except `outputSamples`: the length of `pcm` per channel,
+// which differs from `samplesDecoded` only with outputSampleRate.
+export type DecodeBufferResult = {
+  success: boolean;
+  pcm?: Object;
+  samplesDecoded?: number;
+  outputSamples?: number;
+  packetsDecoded?: number;
+  packetsConcealed?: number;
+  packetsRecovered?: number;
+  packetsDredRecovered?: number;
+  packetsLate?: number;
+  // Samples per channel rebuilt from FEC/DRED and filled by concealment
+  samplesRecovered?: number;
+  samplesConcealed?: number;
+  // Sequence numbers (or packet indices) of the lost packets
+  gaps?: number[];
+  // With `ring`: frames the ring took, and frames it had no room for
+  framesWritten?: number;
+  framesDropped?: number;
+  processingTimeMs?: number;
+  error?: string;
+};
+
+// sampleRate: 8000, 12000, 16000, 24000 or 48000; channels: 1 or 2
+// `outputSampleRate` resamples the decoded PCM to any rate (e.g. 44100)
+// with a polyphase filter whose state carries across calls.
+// `resampleQuality` is 'low', 'medium' (default) or 'high'.
+export type DecoderConfig = {
+  sampleRate: number;
+  channels: number;
+  outputSampleRate?: number;
+  resampleQuality?: string;
+};
+
+export type DecoderStats = {
+  success: boolean;
+  sampleRate?: number;
+  outputSampleRate?: number;
+  channels?: number;
+  decodeCalls?: number;
+  packetsDecoded?: number;
+  packetsFailed?: number;
+  packetsConcealed?: number;
+  packetsRecovered?: number;
+  packetsDredRecovered?: number;
+  packetsLate?: number;
+  samplesDecoded?: number;
+  samplesRecovered?: number;
+  samplesConcealed?: number;
+  processingTimeMs?: number;
+  error?: string;
+};
+
+// One stream of decodeOpusBatch: its packets plus the same framing and
+// decode options as DecodeOptions (except `ring`). `sampleRate`,
+// `channels`, `outputSampleRate` and `resampleQuality` override the batch
+// options for this stream. Resampled streams are drained and aligned, so
+// `outputSamples` is `samplesDecoded` at the output rate.
+export type BatchStream = {
+  packets: Object;
+  framing?: string;
+  packetSize?: number;
+  lengths?: number[];
+  outputFormat?: string;
+  concealLoss?: boolean;
+  dred?: boolean;
+  sequenceNumbers?: number[];
+  sampleRate?: number;
+  channels?: number;
+  outputSampleRate?: number;
+  resampleQuality?: string;
+};
+
+// Defaults for every stream: sampleRate 16000 and mono unless given
+export type BatchDecodeOptions = {
+  sampleRate?: number;
+  channels?: number;
+  outputSampleRate?: number;
+  resampleQuality?: string;
+};
+
+// `results` holds one DecodeBufferResult per stream, in input order; a
+// stream that fails has `success: false` without failing the batch.
+export type BatchDecodeResult = {
+  success: boolean;
+  results?: DecodeBufferResult[];
+  streamsFailed?: number;
+  processingTimeMs?: number;
+  error?: string;
+};
+
+export type OggDecodeOptions = {
+  // Output rate: 8000, 12000, 16000, 24000 or 48000 (default)
+  sampleRate?: number;
+  // 'int16' (default) or 'float32'
+  outputFormat?: string;
+};
+
+export type OggDecodeResult = {
+  success: boolean;
+  pcm?: Object;
+  sampleRate?: number;
+  channels?: number;
+  samplesDecoded?: number;
+  packetsDecoded?: number;
+  preSkip?: number;
+  durationMs?: number;
+  corruptPages?: number;
+  vendor?: string;
+  comments?: string[];
+  processingTimeMs?: number;
+  error?: string;
+};
+
+export type WavWriterConfig = {
+  sampleRate: number;
+  channels: number;
+};
+
+export type WavWriterResult = {
+  success: boolean;
+  filepath?: string;
+  dataBytes?: number;
+  durationMs?: number;
+  error?: string;
+};
+
+// Framing as in DecodeOptions; the output defaults to 16 kHz mono.
+export type FileToWavOptions = {
+  framing?: string;
+  packetSize?: number;
+  lengths?: number[];
+  sampleRate?: number;
+  channels?: number;
+};
+
+export type FileToWavResult = {
+  success: boolean;
+  filepath?: string;
+  samplesDecoded?: number;
+  packetsDecoded?: number;
+  packetsFailed?: number;
+  dataBytes?: number;
+  durationMs?: number;
+  processingTimeMs?: number;
+  error?: string;
+};
+
+// Input framing as in DecodeOptions. Every packet is padded to `paddedSize`
+// bytes, which must be at least the largest packet.
+export type PadPacketFileOptions = {
+  framing?: string;
+  packetSize?: number;
+  lengths?: number[];
+  paddedSize: number;
+};
+
+// `outputFraming` is 'u16' (default) or 'varint'.
+export type UnpadPacketFileOptions = {
+  paddedSize: number;
+  outputFraming?: string;
+};
+
+// `truncatedBytes` is a trailing partial packet of fixed-size input, which
+// is skipped rather than written.
+export type PaddingResult = {
+  success: boolean;
+  filepath?: string;
+  packets?: number;
+  inputBytes?: number;
+  outputBytes?: number;
+  truncatedBytes?: number;
+  processingTimeMs?: number;
+  error?: string;
+};
+
+// sampleRate and channels as in DecoderConfig. The playout delay adapts to
+// the measured jitter between minDelayMs (default 20) and maxDelayMs
+// (default 400). `dred` as in DecodeOptions.
+export type JitterBufferConfig = {
+  sampleRate: number;
+  channels: number;
+  minDelayMs?: number;
+  maxDelayMs?: number;
+  dred?: boolean;
+};
+
+// Framing as in DecodeOptions. `sequenceNumbers` (16-bit RTP, one per
+// packet) is required; `timestamps` are RTP timestamps on the 48 kHz Opus
+// clock and default to sequence number times packet duration.
+export type JitterPushOptions = {
+  framing?: string;
+  packetSize?: number;
+  lengths?: number[];
+  sequenceNumbers: number[];
+  timestamps?: number[];
+};
+
+export type JitterPullOptions = {
+  durationMs: number;
+  // 'int16' (default) or 'float32'
+  outputFormat?: string;
+};
+
+export type JitterBufferStats = {
+  packetsReceived: number;
+  packetsDecoded: number;
+  packetsLate: number;
+  packetsDuplicate: number;
+  packetsLost: number;
+  packetsRecovered: number;
+  packetsDredRecovered: number;
+  packetsConcealed: number;
+  // Discarded to bring the delay back down
+  packetsDropped: number;
+  underruns: number;
+  jitterMs: number;
+  targetDelayMs: number;
+  currentDelayMs: number;
+  // Share of the output filled by FEC or concealment
+  concealmentRatio: number;
+  bufferedPackets: number;
+};
+
+export type JitterStatsResult = Partial<JitterBufferStats> & {
+  success: boolean;
+  error?: string;
+};
+
+// `pcm` holds exactly durationMs of audio; silence while `buffering`.
+export type JitterPullResult = {
+  success: boolean;
+  pcm?: Object;
+  buffering?: boolean;
+  stats?: JitterBufferStats;
+  error?: string;
+};
+
+// application: 'voip', 'audio' (default) or 'restricted-lowdelay'.
+// bitrate in bits per second (libopus picks one if omitted); complexity
+// 0-10; frameDurationMs 2.5, 5, 10, 20 (default), 40, 60, 80, 100 or 120.
+export type EncoderConfig = {
+  sampleRate: number;
+  channels: number;
+  application?: string;
+  bitrate?: number;
+  vbr?: boolean;
+  constrainedVbr?: boolean;
+  complexity?: number;
+  fec?: boolean;
+  packetLossPercent?: number;
+  dtx?: boolean;
+  frameDurationMs?: number;
+};
+
+// framing: 'u16' (default), 'varint', or 'lengths' for bare packets back to
+// back.
+export type EncodeOptions = {
+  framing?: string;
+};
+
+// `packets` is a Uint8Array in the requested framing, ready for
+// decodeWithDecoder; `lengths` gives each packet's size without framing.
+export type EncodeResult = {
+  success: boolean;
+  packets?: Object;
+  lengths?: number[];
+  packetsEncoded?: number;
+  samplesEncoded?: number;
+  processingTimeMs?: number;
+  error?: string;
+};
+
+export type EncoderStats = {
+  success: boolean;
+  sampleRate?: number;
+  channels?: number;
+  encodeCalls?: number;
+  packetsEncoded?: number;
+  bytesEncoded?: number;
+  samplesEncoded?: number;
+  processingTimeMs?: number;
+  error?: string;
+};
+
+// EncoderConfig plus the range updateStreamNetwork keeps the bitrate in
+// (maxBitrate defaults to `bitrate`, or 64 kb/s per channel) and how much
+// encoded audio is kept for a consumer that falls behind (default 1000 ms).
+export type StreamEncoderConfig = EncoderConfig & {
+  minBitrate?: number;
+  maxBitrate?: number;
+  maxQueueMs?: number;
+};
+
+// Receiver feedback, e.g. from RTCP receiver reports
+export type NetworkFeedback = {
+  lossPercent: number;
+  rttMs?: number;
+};
+
+export type StreamEncoderStats = {
+  success: boolean;
+  packetsEncoded?: number;
+  // Oldest packets dropped because nobody pulled them
+  packetsDropped?: number;
+  bytesEncoded?: number;
+  samplesPushed?: number;
+  // Samples per channel waiting for a full frame
+  framesBuffered?: number;
+  packetsQueued?: number;
+  bitrate?: number;
+  packetLossPercent?: number;
+  fec?: boolean;
+  error?: string;
+};
+
+// Size the ring by `capacityMs` at `sampleRate` (default 48000), or directly
+// by `capacityFrames`; it is rounded up to a power of two frames.
+export type PcmRingConfig = {
+  channels: number;
+  sampleRate?: number;
+  capacityMs?: number;
+  capacityFrames?: number;
+};
+
+// Frame counts are per channel. `framesRead` counts audio only, not the
+// silence handed out on underruns.
+export type PcmRingStats = {
+  success: boolean;
+  capacityFrames?: number;
+  fillFrames?: number;
+  framesWritten?: number;
+  framesRead?: number;
+  framesDropped?: number;
+  underruns?: number;
+  underrunFrames?: number;
+  error?: string;
+};
+
+// Packet framing of the whole stream; 'lengths' is not supported because
+// chunks may split packets.
+export type StreamDecoderConfig = DecoderConfig & {
+  framing?: string;
+  packetSize?: number;
+};
+
+export type StreamDecodeOptions = {
+  outputFormat?: string;
+  concealLoss?: boolean;
+  dred?: boolean;
+};
+
+// PCM of the packets this chunk completed. `pendingBytes` is the start of an
+// incomplete packet held for the next chunk.
+export type StreamDecodeResult = DecodeBufferResult & {
+  pendingBytes?: number;
+};
+
+// Layout from the bytes of an OpusHead (e.g. Ogg, or WebM CodecPrivate), or
+// from `channels` and `mappingFamily`: 0 for mono/stereo, 1 for up to 8
+// channels in Vorbis order (5.1, 7.1, ...), 255 for an explicit layout.
+// Family 255, or a non-default layout, also needs streamCount,
+// coupledCount and one `mapping` entry per channel. `sampleRate` defaults
+// to 48000.
+export type MultistreamDecoderConfig = {
+  opusHead?: Object;
+  sampleRate?: number;
+  channels?: number;
+  mappingFamily?: number;
+  streamCount?: number;
+  coupledCount?: number;
+  mapping?: number[];
+};
+
+// `planar` returns one block of samplesDecoded samples per channel instead
+// of interleaved PCM.
+export type MultistreamDecodeOptions = {
+  framing?: string;
+  packetSize?: number;
+  lengths?: number[];
+  outputFormat?: string;
+  concealLoss?: boolean;
+  planar?: boolean;
+};
+
+export type MultistreamDecodeResult = DecodeBufferResult & {
+  channels?: number;
+  planar?: boolean;
+};
+
+// Ambisonic layout (channel mapping family 3) from the bytes of an OpusHead,
+// or from `channels`, `streamCount`, `coupledCount` and the
+// channels x (streamCount + coupledCount) Q15 `demixingMatrix`, column-major
+// as in the OpusHead. `binaural` renders to stereo for headphones with
+// built-in filters, or with `binauralFilters`: per ambisonic channel (ACN
+// order) a left then a right FIR of `binauralFilterLength` taps.
+export type ProjectionDecoderConfig = {
+  opusHead?: Object;
+  sampleRate?: number;
+  channels?: number;
+  streamCount?: number;
+  coupledCount?: number;
+  demixingMatrix?: number[];
+  binaural?: boolean;
+  binauralFilters?: Object;
+  binauralFilterLength?: number;
+};
+
+export type ProjectionDecodeOptions = {
+  framing?: string;
+  packetSize?: number;
+  lengths?: number[];
+  outputFormat?: string;
+  concealLoss?: boolean;
+};
+
+export type ProjectionDecodeResult = DecodeBufferResult & {
+  channels?: number;
+};
+
+// Input packets are framed as in DecodeOptions. `outputFraming` is 'u16',
+// 'varint' or 'lengths'; it defaults to the input framing for 'u16' and
+// 'varint', 'u16' otherwise.
+export type RepacketizeOptions = {
+  framing?: string;
+  packetSize?: number;
+  lengths?: number[];
+  outputFraming?: string;
+};
+
+// `packetsPerGroup` input packets go into each output packet (default: as
+// many as fit in 120 ms).
+export type MergePacketsOptions = RepacketizeOptions & {
+  packetsPerGroup?: number;
+};
+
+// Frames are counted across the whole input; `frameCount` defaults to the
+// rest of the stream.
+export type ExtractFramesOptions = RepacketizeOptions & {
+  firstFrame: number;
+  frameCount?: number;
+};
+
+export type RepacketizeResult = {
+  success: boolean;
+  packets?: Object;
+  lengths?: number[];
+  packetCount?: number;
+  frameCount?: number;
+  processingTimeMs?: number;
+  error?: string;
+};
+
 export interface Spec extends TurboModule {
 
   decodeMultipleOpusPackets(
@@ -15,8 +497,20 @@ export interface Spec extends TurboModule {
     error?: string;
   }>;
 
+  // `packets` is an ArrayBuffer or a typed array view (e.g. Uint8Array).
+  decodeOpusPacketsBuffer(
+    packets: Object,
+    options: DecodeOptions
+  ): Promise<DecodeBufferResult>;
+
   resetDecoderState(): Promise<{ success: boolean; error?: string }>;
 
+  // Rate and channels of the decoder behind the two methods above
+  // (16 kHz mono until configured).
+  configureDefaultDecoder(
+    config: DecoderConfig
+  ): Promise<{ success: boolean; error?: string }>;
+
   saveDecodedDataAsWav(
     decodedDataBase64: string,
     filepath: string,
@@ -27,6 +521,258 @@ export interface Spec extends TurboModule {
     filepath?: string;
     error?: string;
   }>;
+
+  // Independent decoder sessions, each with its own state and statistics.
+  createDecoder(
+    config: DecoderConfig
+  ): Promise<{ success: boolean; handle?: number; error?: string }>;
+
+  decodeWithDecoder(
+    handle: number,
+    packets: Object,
+    options: DecodeOptions
+  ): Promise<DecodeBufferResult>;
+
+  resetDecoder(handle: number): Promise<{ success: boolean; error?: string }>;
+
+  destroyDecoder(handle: number): Promise<{ success: boolean; error?: string }>;
+
+  getDecoderStats(handle: number): Promise<DecoderStats>;
+
+  // Decodes independent streams in parallel, each with its own decoder.
+  decodeOpusBatch(
+    streams: BatchStream[],
+    options: BatchDecodeOptions
+  ): Promise<BatchDecodeResult>;
+
+  // Demuxes and decodes an Ogg Opus (.opus) file natively.
+  decodeOggOpusFile(
+    filepath: string,
+    options: OggDecodeOptions
+  ): Promise<OggDecodeResult>;
+
+  // Regroups frames between packets without re-encoding (opus_repacketizer).
+  mergeOpusPackets(
+    packets: Object,
+    options: MergePacketsOptions
+  ): Promise<RepacketizeResult>;
+
+  splitOpusPackets(
+    packets: Object,
+    options: RepacketizeOptions
+  ): Promise<RepacketizeResult>;
+
+  extractOpusFrames(
+    packets: Object,
+    options: ExtractFramesOptions
+  ): Promise<RepacketizeResult>;
+
+  // Streams 16-bit PCM into a WAV file without holding it in memory.
+  openWavWriter(
+    filepath: string,
+    config: WavWriterConfig
+  ): Promise<{ success: boolean; handle?: number; error?: string }>;
+
+  // `pcm` is an Int16Array, an ArrayBuffer or another typed array view.
+  appendWavData(
+    handle: number,
+    pcm: Object
+  ): Promise<{ success: boolean; error?: string }>;
+
+  finalizeWavWriter(handle: number): Promise<WavWriterResult>;
+
+  // Decodes a packets file into a WAV file without passing PCM through JS.
+  decodeFileToWav(
+    inputPath: string,
+    outputPath: string,
+    options: FileToWavOptions
+  ): Promise<FileToWavResult>;
+
+  // Converts between VBR packet files and the fixed-size layout of
+  // decodeMultipleOpusPackets (opus_packet_pad / opus_packet_unpad).
+  padOpusPacketFile(
+    inputPath: string,
+    outputPath: string,
+    options: PadPacketFileOptions
+  ): Promise<PaddingResult>;
+
+  unpadOpusPacketFile(
+    inputPath: string,
+    outputPath: string,
+    options: UnpadPacketFileOptions
+  ): Promise<PaddingResult>;
+
+  // Adaptive playout buffer for packets received over a network.
+  createJitterBuffer(
+    config: JitterBufferConfig
+  ): Promise<{ success: boolean; handle?: number; error?: string }>;
+
+  pushJitterPackets(
+    handle: number,
+    packets: Object,
+    options: JitterPushOptions
+  ): Promise<{ success: boolean; error?: string }>;
+
+  pullJitterAudio(
+    handle: number,
+    options: JitterPullOptions
+  ): Promise<JitterPullResult>;
+
+  getJitterStats(handle: number): Promise<JitterStatsResult>;
+
+  resetJitterBuffer(
+    handle: number
+  ): Promise<{ success: boolean; error?: string }>;
+
+  destroyJitterBuffer(
+    handle: number
+  ): Promise<{ success: boolean; error?: string }>;
+
+  // Encoder sessions. `frameSize` is in samples per channel; `lookahead` is
+  // the pre-skip a decoder should drop from the start.
+  createEncoder(config: EncoderConfig): Promise<{
+    success: boolean;
+    handle?: number;
+    frameSize?: number;
+    lookahead?: number;
+    error?: string;
+  }>;
+
+  // `pcm` is an interleaved Int16Array or Float32Array. A partial last
+  // frame is padded with silence.
+  encodeWithEncoder(
+    handle: number,
+    pcm: Object,
+    options: EncodeOptions
+  ): Promise<EncodeResult>;
+
+  resetEncoder(handle: number): Promise<{ success: boolean; error?: string }>;
+
+  destroyEncoder(handle: number): Promise<{ success: boolean; error?: string }>;
+
+  getEncoderStats(handle: number): Promise<EncoderStats>;
+
+  // Live encoding: push PCM chunks of any size, pull packets as frames
+  // complete.
+  createStreamEncoder(config: StreamEncoderConfig): Promise<{
+    success: boolean;
+    handle?: number;
+    frameSize?: number;
+    lookahead?: number;
+    error?: string;
+  }>;
+
+  pushStreamPcm(
+    handle: number,
+    pcm: Object
+  ): Promise<{ success: boolean; packetsQueued?: number; error?: string }>;
+
+  pullStreamPackets(
+    handle: number,
+    options: EncodeOptions
+  ): Promise<EncodeResult>;
+
+  // Pads the buffered partial frame with silence, encodes it and pulls.
+  flushStreamEncoder(
+    handle: number,
+    options: EncodeOptions
+  ): Promise<EncodeResult>;
+
+  updateStreamNetwork(
+    handle: number,
+    feedback: NetworkFeedback
+  ): Promise<{
+    success: boolean;
+    bitrate?: number;
+    packetLossPercent?: number;
+    fec?: boolean;
+    error?: string;
+  }>;
+
+  getStreamEncoderStats(handle: number): Promise<StreamEncoderStats>;
+
+  destroyStreamEncoder(
+    handle: number
+  ): Promise<{ success: boolean; error?: string }>;
+
+  // Lock-free PCM ring for native audio code. Decode into it with the `ring`
+  // option; native code looks it up with rnopus::findPcmRing(handle).
+  createPcmRing(config: PcmRingConfig): Promise<{
+    success: boolean;
+    handle?: number;
+    capacityFrames?: number;
+    error?: string;
+  }>;
+
+  getPcmRingStats(handle: number): Promise<PcmRingStats>;
+
+  destroyPcmRing(handle: number): Promise<{ success: boolean; error?: string }>;
+
+  // Progressive decoding: feed bytes as they arrive, in any chunking.
+  createStreamDecoder(
+    config: StreamDecoderConfig
+  ): Promise<{ success: boolean; handle?: number; error?: string }>;
+
+  feedStreamDecoder(
+    handle: number,
+    bytes: Object,
+    options: StreamDecodeOptions
+  ): Promise<StreamDecodeResult>;
+
+  // Drops held bytes and decoder history, e.g. after a seek.
+  resetStreamDecoder(
+    handle: number
+  ): Promise<{ success: boolean; error?: string }>;
+
+  destroyStreamDecoder(
+    handle: number
+  ): Promise<{ success: boolean; error?: string }>;
+
+  // Multichannel and surround streams (opus_multistream).
+  createMultistreamDecoder(config: MultistreamDecoderConfig): Promise<{
+    success: boolean;
+    handle?: number;
+    channels?: number;
+    streamCount?: number;
+    coupledCount?: number;
+    error?: string;
+  }>;
+
+  decodeWithMultistreamDecoder(
+    handle: number,
+    packets: Object,
+    options: MultistreamDecodeOptions
+  ): Promise<MultistreamDecodeResult>;
+
+  resetMultistreamDecoder(
+    handle: number
+  ): Promise<{ success: boolean; error?: string }>;
+
+  destroyMultistreamDecoder(
+    handle: number
+  ): Promise<{ success: boolean; error?: string }>;
+
+  // Ambisonics (opus_projection), optionally rendered to binaural stereo.
+  createProjectionDecoder(config: ProjectionDecoderConfig): Promise<{
+    success: boolean;
+    handle?: number;
+    channels?: number;
+    error?: string;
+  }>;
+
+  decodeWithProjectionDecoder(
+    handle: number,
+    packets: Object,
+    options: ProjectionDecodeOptions
+  ): Promise<ProjectionDecodeResult>;
+
+  resetProjectionDecoder(
+    handle: number
+  ): Promise<{ success: boolean; error?: string }>;
+
+  destroyProjectionDecoder(
+    handle: number
+  ): Promise<{ success: boolean; error?: string }>;
 }
 
 export default TurboModuleRegistry.getEnforcing<Spec>('OpusTurbo');
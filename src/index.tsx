@@ -1,4 +1,112 @@
 import OpusTurboModule from './NativeOpusTurboModule';
+import type {
+  BatchDecodeOptions,
+  BatchDecodeResult,
+  BatchStream,
+  DecodeBufferResult,
+  DecodeOptions,
+  DecoderConfig,
+  DecoderStats,
+  EncodeOptions,
+  EncodeResult,
+  EncoderConfig,
+  EncoderStats,
+  ExtractFramesOptions,
+  FileToWavOptions,
+  FileToWavResult,
+  JitterBufferConfig,
+  JitterBufferStats,
+  JitterPullOptions,
+  JitterPullResult,
+  JitterPushOptions,
+  JitterStatsResult,
+  MergePacketsOptions,
+  MultistreamDecodeOptions,
+  MultistreamDecodeResult,
+  MultistreamDecoderConfig,
+  NetworkFeedback,
+  OggDecodeOptions,
+  OggDecodeResult,
+  PadPacketFileOptions,
+  PaddingResult,
+  PcmRingConfig,
+  PcmRingStats,
+  ProjectionDecodeOptions,
+  ProjectionDecodeResult,
+  ProjectionDecoderConfig,
+  RepacketizeOptions,
+  RepacketizeResult,
+  StreamDecodeOptions,
+  StreamDecodeResult,
+  StreamDecoderConfig,
+  StreamEncoderConfig,
+  StreamEncoderStats,
+  UnpadPacketFileOptions,
+  WavWriterConfig,
+  WavWriterResult,
+} from './NativeOpusTurboModule';
+
+export type {
+  BatchDecodeOptions,
+  BatchStream,
+  DecodeOptions,
+  DecoderConfig,
+  DecoderStats,
+  EncodeOptions,
+  EncoderConfig,
+  EncoderStats,
+  ExtractFramesOptions,
+  FileToWavOptions,
+  FileToWavResult,
+  JitterBufferConfig,
+  JitterBufferStats,
+  JitterPullOptions,
+  JitterPushOptions,
+  JitterStatsResult,
+  MergePacketsOptions,
+  MultistreamDecodeOptions,
+  MultistreamDecoderConfig,
+  NetworkFeedback,
+  OggDecodeOptions,
+  PadPacketFileOptions,
+  PaddingResult,
+  PcmRingConfig,
+  PcmRingStats,
+  ProjectionDecodeOptions,
+  ProjectionDecoderConfig,
+  RepacketizeOptions,
+  StreamDecodeOptions,
+  StreamDecoderConfig,
+  StreamEncoderConfig,
+  StreamEncoderStats,
+  UnpadPacketFileOptions,
+  WavWriterConfig,
+  WavWriterResult,
+};
+
+export type DecodedPcm = Omit<DecodeBufferResult, 'pcm'> & {
+  pcm?: Int16Array | Float32Array;
+};
+
+export type BatchDecodedPcm = Omit<BatchDecodeResult, 'results'> & {
+  results?: DecodedPcm[];
+};
+
+export type MultistreamDecodedPcm = Omit<MultistreamDecodeResult, 'pcm'> & {
+  pcm?: Int16Array | Float32Array;
+};
+
+export type ProjectionDecodedPcm = Omit<ProjectionDecodeResult, 'pcm'> & {
+  pcm?: Int16Array | Float32Array;
+};
+
+export type RepacketizedPackets = Omit<RepacketizeResult, 'packets'> & {
+  packets?: Uint8Array;
+};
+
+export type StreamDecodedPcm = Omit<StreamDecodeResult, 'pcm'> & {
+  pcm?: Int16Array | Float32Array;
+};
 
 export function decodeMultipleOpusPackets(
   packetsBase64: string,
@@ -14,10 +122,30 @@ export function decodeMultipleOpusPackets(
   return OpusTurboModule.decodeMultipleOpusPackets(packetsBase64, packetSize);
 }
 
+export async function decodeOpusPacketsBuffer(
+  packets: ArrayBuffer | ArrayBufferView,
+  options: DecodeOptions
+): Promise<DecodedPcm> {
+  const result = await OpusTurboModule.decodeOpusPacketsBuffer(
+    packets,
+    options
+  );
+  return {
+    ...result,
+    pcm: result.pcm as Int16Array | Float32Array | undefined,
+  };
+}
+
 export function resetDecoderState(): Promise<{ success: boolean; error?: string }> {
   return OpusTurboModule.resetDecoderState();
 }
 
+export function configureDefaultDecoder(
+  config: DecoderConfig
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.configureDefaultDecoder(config);
+}
+
 export function saveDecodedDataAsWav(
   decodedDataBase64: string,
   filepath: string,
@@ -29,4 +157,424 @@ export function saveDecodedDataAsWav(
   error?: string;
 }> {
   return OpusTurboModule.saveDecodedDataAsWav(decodedDataBase64, filepath, sampleRate, channels);
-}
\ No newline at end of file
+}
+
+export function createDecoder(
+  config: DecoderConfig
+): Promise<{ success: boolean; handle?: number; error?: string }> {
+  return OpusTurboModule.createDecoder(config);
+}
+
+export async function decodeWithDecoder(
+  handle: number,
+  packets: ArrayBuffer | ArrayBufferView,
+  options: DecodeOptions
+): Promise<DecodedPcm> {
+  const result = await OpusTurboModule.decodeWithDecoder(
+    handle,
+    packets,
+    options
+  );
+  return {
+    ...result,
+    pcm: result.pcm as Int16Array | Float32Array | undefined,
+  };
+}
+
+export function resetDecoder(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.resetDecoder(handle);
+}
+
+export function destroyDecoder(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.destroyDecoder(handle);
+}
+
+export function getDecoderStats(handle: number): Promise<DecoderStats> {
+  return OpusTurboModule.getDecoderStats(handle);
+}
+
+export async function decodeOpusBatch(
+  streams: Array<
+    Omit<BatchStream, 'packets'> & { packets: ArrayBuffer | ArrayBufferView }
+  >,
+  options: BatchDecodeOptions = {}
+): Promise<BatchDecodedPcm> {
+  const result = await OpusTurboModule.decodeOpusBatch(streams, options);
+  return {
+    ...result,
+    results: result.results?.map((stream) => ({
+      ...stream,
+      pcm: stream.pcm as Int16Array | Float32Array | undefined,
+    })),
+  };
+}
+
+export async function decodeOggOpusFile(
+  filepath: string,
+  options: OggDecodeOptions = {}
+): Promise<
+  Omit<OggDecodeResult, 'pcm'> & { pcm?: Int16Array | Float32Array }
+> {
+  const result = await OpusTurboModule.decodeOggOpusFile(filepath, options);
+  return {
+    ...result,
+    pcm: result.pcm as Int16Array | Float32Array | undefined,
+  };
+}
+
+export async function mergeOpusPackets(
+  packets: ArrayBuffer | ArrayBufferView,
+  options: MergePacketsOptions = {}
+): Promise<RepacketizedPackets> {
+  const result = await OpusTurboModule.mergeOpusPackets(packets, options);
+  return {
+    ...result,
+    packets: result.packets as Uint8Array | undefined,
+  };
+}
+
+export async function splitOpusPackets(
+  packets: ArrayBuffer | ArrayBufferView,
+  options: RepacketizeOptions = {}
+): Promise<RepacketizedPackets> {
+  const result = await OpusTurboModule.splitOpusPackets(packets, options);
+  return {
+    ...result,
+    packets: result.packets as Uint8Array | undefined,
+  };
+}
+
+export async function extractOpusFrames(
+  packets: ArrayBuffer | ArrayBufferView,
+  options: ExtractFramesOptions
+): Promise<RepacketizedPackets> {
+  const result = await OpusTurboModule.extractOpusFrames(packets, options);
+  return {
+    ...result,
+    packets: result.packets as Uint8Array | undefined,
+  };
+}
+
+export function openWavWriter(
+  filepath: string,
+  config: WavWriterConfig
+): Promise<{ success: boolean; handle?: number; error?: string }> {
+  return OpusTurboModule.openWavWriter(filepath, config);
+}
+
+export function appendWavData(
+  handle: number,
+  pcm: Int16Array | ArrayBuffer | ArrayBufferView
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.appendWavData(handle, pcm);
+}
+
+export function finalizeWavWriter(handle: number): Promise<WavWriterResult> {
+  return OpusTurboModule.finalizeWavWriter(handle);
+}
+
+export function decodeFileToWav(
+  inputPath: string,
+  outputPath: string,
+  options: FileToWavOptions
+): Promise<FileToWavResult> {
+  return OpusTurboModule.decodeFileToWav(inputPath, outputPath, options);
+}
+
+export function padOpusPacketFile(
+  inputPath: string,
+  outputPath: string,
+  options: PadPacketFileOptions
+): Promise<PaddingResult> {
+  return OpusTurboModule.padOpusPacketFile(inputPath, outputPath, options);
+}
+
+export function unpadOpusPacketFile(
+  inputPath: string,
+  outputPath: string,
+  options: UnpadPacketFileOptions
+): Promise<PaddingResult> {
+  return OpusTurboModule.unpadOpusPacketFile(inputPath, outputPath, options);
+}
+
+export function createJitterBuffer(
+  config: JitterBufferConfig
+): Promise<{ success: boolean; handle?: number; error?: string }> {
+  return OpusTurboModule.createJitterBuffer(config);
+}
+
+export function pushJitterPackets(
+  handle: number,
+  packets: ArrayBuffer | ArrayBufferView,
+  options: JitterPushOptions
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.pushJitterPackets(handle, packets, options);
+}
+
+export async function pullJitterAudio(
+  handle: number,
+  options: JitterPullOptions
+): Promise<
+  Omit<JitterPullResult, 'pcm'> & { pcm?: Int16Array | Float32Array }
+> {
+  const result = await OpusTurboModule.pullJitterAudio(handle, options);
+  return {
+    ...result,
+    pcm: result.pcm as Int16Array | Float32Array | undefined,
+  };
+}
+
+export function getJitterStats(handle: number): Promise<JitterStatsResult> {
+  return OpusTurboModule.getJitterStats(handle);
+}
+
+export function resetJitterBuffer(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.resetJitterBuffer(handle);
+}
+
+export function destroyJitterBuffer(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.destroyJitterBuffer(handle);
+}
+
+export function createEncoder(config: EncoderConfig): Promise<{
+  success: boolean;
+  handle?: number;
+  frameSize?: number;
+  lookahead?: number;
+  error?: string;
+}> {
+  return OpusTurboModule.createEncoder(config);
+}
+
+export async function encodeWithEncoder(
+  handle: number,
+  pcm: Int16Array | Float32Array,
+  options: EncodeOptions = {}
+): Promise<Omit<EncodeResult, 'packets'> & { packets?: Uint8Array }> {
+  const result = await OpusTurboModule.encodeWithEncoder(handle, pcm, options);
+  return {
+    ...result,
+    packets: result.packets as Uint8Array | undefined,
+  };
+}
+
+export function resetEncoder(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.resetEncoder(handle);
+}
+
+export function destroyEncoder(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.destroyEncoder(handle);
+}
+
+export function getEncoderStats(handle: number): Promise<EncoderStats> {
+  return OpusTurboModule.getEncoderStats(handle);
+}
+
+export function createStreamEncoder(config: StreamEncoderConfig): Promise<{
+  success: boolean;
+  handle?: number;
+  frameSize?: number;
+  lookahead?: number;
+  error?: string;
+}> {
+  return OpusTurboModule.createStreamEncoder(config);
+}
+
+export function pushStreamPcm(
+  handle: number,
+  pcm: Int16Array | Float32Array
+): Promise<{ success: boolean; packetsQueued?: number; error?: string }> {
+  return OpusTurboModule.pushStreamPcm(handle, pcm);
+}
+
+export async function pullStreamPackets(
+  handle: number,
+  options: EncodeOptions = {}
+): Promise<Omit<EncodeResult, 'packets'> & { packets?: Uint8Array }> {
+  const result = await OpusTurboModule.pullStreamPackets(handle, options);
+  return {
+    ...result,
+    packets: result.packets as Uint8Array | undefined,
+  };
+}
+
+export async function flushStreamEncoder(
+  handle: number,
+  options: EncodeOptions = {}
+): Promise<Omit<EncodeResult, 'packets'> & { packets?: Uint8Array }> {
+  const result = await OpusTurboModule.flushStreamEncoder(handle, options);
+  return {
+    ...result,
+    packets: result.packets as Uint8Array | undefined,
+  };
+}
+
+export function updateStreamNetwork(
+  handle: number,
+  feedback: NetworkFeedback
+): Promise<{
+  success: boolean;
+  bitrate?: number;
+  packetLossPercent?: number;
+  fec?: boolean;
+  error?: string;
+}> {
+  return OpusTurboModule.updateStreamNetwork(handle, feedback);
+}
+
+export function getStreamEncoderStats(
+  handle: number
+): Promise<StreamEncoderStats> {
+  return OpusTurboModule.getStreamEncoderStats(handle);
+}
+
+export function destroyStreamEncoder(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.destroyStreamEncoder(handle);
+}
+
+export function createPcmRing(config: PcmRingConfig): Promise<{
+  success: boolean;
+  handle?: number;
+  capacityFrames?: number;
+  error?: string;
+}> {
+  return OpusTurboModule.createPcmRing(config);
+}
+
+export function getPcmRingStats(handle: number): Promise<PcmRingStats> {
+  return OpusTurboModule.getPcmRingStats(handle);
+}
+
+export function destroyPcmRing(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.destroyPcmRing(handle);
+}
+
+export function createStreamDecoder(
+  config: StreamDecoderConfig
+): Promise<{ success: boolean; handle?: number; error?: string }> {
+  return OpusTurboModule.createStreamDecoder(config);
+}
+
+export async function feedStreamDecoder(
+  handle: number,
+  bytes: ArrayBuffer | ArrayBufferView,
+  options: StreamDecodeOptions = {}
+): Promise<StreamDecodedPcm> {
+  const result = await OpusTurboModule.feedStreamDecoder(
+    handle,
+    bytes,
+    options
+  );
+  return {
+    ...result,
+    pcm: result.pcm as Int16Array | Float32Array | undefined,
+  };
+}
+
+export function resetStreamDecoder(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.resetStreamDecoder(handle);
+}
+
+export function destroyStreamDecoder(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.destroyStreamDecoder(handle);
+}
+
+export function createMultistreamDecoder(
+  config: MultistreamDecoderConfig
+): Promise<{
+  success: boolean;
+  handle?: number;
+  channels?: number;
+  streamCount?: number;
+  coupledCount?: number;
+  error?: string;
+}> {
+  return OpusTurboModule.createMultistreamDecoder(config);
+}
+
+export async function decodeWithMultistreamDecoder(
+  handle: number,
+  packets: ArrayBuffer | ArrayBufferView,
+  options: MultistreamDecodeOptions
+): Promise<MultistreamDecodedPcm> {
+  const result = await OpusTurboModule.decodeWithMultistreamDecoder(
+    handle,
+    packets,
+    options
+  );
+  return {
+    ...result,
+    pcm: result.pcm as Int16Array | Float32Array | undefined,
+  };
+}
+
+export function resetMultistreamDecoder(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.resetMultistreamDecoder(handle);
+}
+
+export function destroyMultistreamDecoder(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.destroyMultistreamDecoder(handle);
+}
+
+export function createProjectionDecoder(
+  config: ProjectionDecoderConfig
+): Promise<{
+  success: boolean;
+  handle?: number;
+  channels?: number;
+  error?: string;
+}> {
+  return OpusTurboModule.createProjectionDecoder(config);
+}
+
+export async function decodeWithProjectionDecoder(
+  handle: number,
+  packets: ArrayBuffer | ArrayBufferView,
+  options: ProjectionDecodeOptions
+): Promise<ProjectionDecodedPcm> {
+  const result = await OpusTurboModule.decodeWithProjectionDecoder(
+    handle,
+    packets,
+    options
+  );
+  return {
+    ...result,
+    pcm: result.pcm as Int16Array | Float32Array | undefined,
+  };
+}
+
+export function resetProjectionDecoder(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.resetProjectionDecoder(handle);
+}
+
+export function destroyProjectionDecoder(
+  handle: number
+): Promise<{ success: boolean; error?: string }> {
+  return OpusTurboModule.destroyProjectionDecoder(handle);
+}